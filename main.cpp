@@ -1,11 +1,21 @@
 #include "mainwindow.h"
+#include "src/database/storagebackend.h"
+#include "src/ui/startuptrace.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    StartupTrace& trace = StartupTrace::getInstance();
     QApplication a(argc, argv);
+    trace.record("QApplication", 0, trace.elapsedMs());
+    StorageBackend::select(StorageBackend::kindFromArguments(a.arguments()));
+    
+    // The database is opened by MainWindow after the login screen is up
     MainWindow w;
-    w.show();
+    {
+        TracePhase phase("MainWindow::show");
+        w.show();
+    }
     return a.exec();
 }
@@ -17,6 +17,8 @@
 #include <QMenu>
 #include <QGridLayout>
 #include <QHBoxLayout>
+#include <QDebug>
+#include "src/ui/startuptrace.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -31,8 +33,12 @@ MainWindow::MainWindow(QWidget *parent)
     , sessionCheckTimer(nullptr)
     , adminButton(nullptr)
     , adminDashboard(nullptr)
+    , startupScheduled(false)
 {
-    ui->setupUi(this);
+    {
+        TracePhase phase("MainWindow::setupUi");
+        ui->setupUi(this);
+    }
     
     // Set window properties
     setWindowTitle("Marketplace");
@@ -48,7 +54,6 @@ MainWindow::MainWindow(QWidget *parent)
     setFixedSize(800, 600);
     
     setupNetworkManager();
-    setupProtectedPages();
     
     // Connect signals
     connect(&authManager, &AuthManager::registrationSuccess, this, &MainWindow::onRegistrationSuccess);
@@ -69,10 +74,10 @@ MainWindow::MainWindow(QWidget *parent)
     connect(sessionCheckTimer, &QTimer::timeout, this, &MainWindow::checkSessionValidity);
     sessionCheckTimer->start(300000); // Check every 5 minutes
     
-    // Try to restore session from cookie
-    loadSessionCookie();
-
-    setupUI();
+    {
+        TracePhase phase("MainWindow::setupUI");
+        setupUI();
+    }
     
     // Ensure we start with login page
     showLoginPage();
@@ -83,38 +88,52 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
-void MainWindow::setupProtectedPages()
+void MainWindow::paintEvent(QPaintEvent *event)
+{
+    QMainWindow::paintEvent(event);
+    
+    // Storage is opened once the first frame is painted; the timer fires
+    // after this paint has been flushed to the screen
+    if (!startupScheduled) {
+        startupScheduled = true;
+        QTimer::singleShot(0, this, &MainWindow::onStartupFinished);
+    }
+}
+
+void MainWindow::onStartupFinished()
+{
+    StartupTrace::getInstance().finish("Login screen shown");
+    
+    {
+        TracePhase phase("Storage initialize");
+        if (!StorageBackend::getInstance().initialize()) {
+            qDebug() << "Failed to initialize database";
+        }
+    }
+    
+    // Sessions are persisted, so a saved token can log the user straight back in
+    loadSessionCookie();
+}
+
+void MainWindow::connectProtectedPage(ProtectedPage* page)
 {
-    orderHistoryPage = new OrderHistoryPage(this);
-    cartPage = new CartPage(this);
-    productListingPage = new ProductListingPage(this);
-    productBrowsePage = new ProductBrowsePage(this);
-    
-    // Connect access denied signals
-    connect(orderHistoryPage, &ProtectedPage::accessDenied, this, &MainWindow::onAccessDenied);
-    connect(cartPage, &ProtectedPage::accessDenied, this, &MainWindow::onAccessDenied);
-    connect(productListingPage, &ProtectedPage::accessDenied, this, &MainWindow::onAccessDenied);
-    connect(productBrowsePage, &ProtectedPage::accessDenied, this, &MainWindow::onAccessDenied);
-    
-    // Connect navigation signals
-    connect(orderHistoryPage, &ProtectedPage::navigateHome, this, &MainWindow::showMainPage);
-    connect(cartPage, &ProtectedPage::navigateHome, this, &MainWindow::showMainPage);
-    connect(productListingPage, &ProtectedPage::navigateHome, this, &MainWindow::showMainPage);
-    connect(productBrowsePage, &ProtectedPage::navigateHome, this, &MainWindow::showMainPage);
-    
-    // Connect logout signals
-    connect(orderHistoryPage, &ProtectedPage::logout, this, &MainWindow::onLogoutButtonClicked);
-    connect(cartPage, &ProtectedPage::logout, this, &MainWindow::onLogoutButtonClicked);
-    connect(productListingPage, &ProtectedPage::logout, this, &MainWindow::onLogoutButtonClicked);
-    connect(productBrowsePage, &ProtectedPage::logout, this, &MainWindow::onLogoutButtonClicked);
-    
-    
-    
-    // Add pages to stacked widget
-    ui->stackedWidget->addWidget(orderHistoryPage);
-    ui->stackedWidget->addWidget(cartPage);
-    ui->stackedWidget->addWidget(productListingPage);
-    ui->stackedWidget->addWidget(productBrowsePage);
+    connect(page, &ProtectedPage::accessDenied, this, &MainWindow::onAccessDenied);
+    connect(page, &ProtectedPage::navigateHome, this, &MainWindow::showMainPage);
+    connect(page, &ProtectedPage::logout, this, &MainWindow::onLogoutButtonClicked);
+}
+
+template <typename Page>
+Page* MainWindow::ensurePage(Page*& page, const QString& name)
+{
+    // Each page builds a large styled widget tree and may query storage, so
+    // it is only built the first time the user opens it
+    if (!page) {
+        TracePhase phase("Create " + name);
+        page = new Page(this);
+        connectProtectedPage(page);
+        ui->stackedWidget->addWidget(page);
+    }
+    return page;
 }
 
 void MainWindow::onAccessDenied()
@@ -135,7 +154,7 @@ bool MainWindow::validateSessionAndNavigate()
 void MainWindow::onViewOrderHistory()
 {
     if (validateSessionAndNavigate()) {
-        orderHistoryPage->show();
+        ensurePage(orderHistoryPage, "OrderHistoryPage")->show();
         ui->stackedWidget->setCurrentWidget(orderHistoryPage);
     }
 }
@@ -143,7 +162,7 @@ void MainWindow::onViewOrderHistory()
 void MainWindow::onViewCart()
 {
     if (validateSessionAndNavigate()) {
-        cartPage->show();
+        ensurePage(cartPage, "CartPage")->show();
         ui->stackedWidget->setCurrentWidget(cartPage);
     }
 }
@@ -151,7 +170,7 @@ void MainWindow::onViewCart()
 void MainWindow::onViewProductListing()
 {
     if (validateSessionAndNavigate()) {
-        productListingPage->show();
+        ensurePage(productListingPage, "ProductListingPage")->show();
         ui->stackedWidget->setCurrentWidget(productListingPage);
     }
 }
@@ -159,7 +178,7 @@ void MainWindow::onViewProductListing()
 void MainWindow::onViewProductBrowse()
 {
     if (validateSessionAndNavigate()) {
-        productBrowsePage->show();
+        ensurePage(productBrowsePage, "ProductBrowsePage")->show();
         ui->stackedWidget->setCurrentWidget(productBrowsePage);
     }
 }
@@ -205,7 +224,11 @@ void MainWindow::loadSessionCookie()
     QString token = settings.value("session_token").toString();
     
     if (!token.isEmpty()) {
-        saveSessionCookie(token);
+        authManager.setSessionToken(token);
+        if (authManager.isAuthenticated()) {
+            saveSessionCookie(token);
+            sessionCheckTimer->start(300000);
+        }
         handleSessionToken(token);
     }
 }
@@ -246,11 +269,11 @@ void MainWindow::showLoginPage()
     // Clear input fields
     ui->loginEmail->clear();
     ui->loginPassword->clear();
-    // Hide protected pages
-    orderHistoryPage->hide();
-    cartPage->hide();
-    productListingPage->hide();
-    productBrowsePage->hide();
+    // Hide protected pages that have been created
+    if (orderHistoryPage) orderHistoryPage->hide();
+    if (cartPage) cartPage->hide();
+    if (productListingPage) productListingPage->hide();
+    if (productBrowsePage) productBrowsePage->hide();
   
 }
 
@@ -374,7 +397,7 @@ void MainWindow::showMainPage()
 
     // Add admin button if user is admin
     QString email = authManager.getCurrentUserEmail();
-    User user = DatabaseManager::getInstance().getUserByEmail(email);
+    User user = StorageBackend::getInstance().getUserByEmail(email);
     if (user.isAdmin()) {
         QPushButton* adminBtn = new QPushButton("👑 Admin Dashboard", dashboardPage);
         adminBtn->setStyleSheet(
@@ -421,7 +444,11 @@ void MainWindow::onRegisterButtonClicked()
         return;
     }
     
-    authManager.registerUser(email, username, password);
+    // Hashing runs off the GUI thread; keep the button off until it finishes
+    ui->registerButton->setEnabled(false);
+    authManager.registerUser(email, username, password).then(this, [this](bool) {
+        ui->registerButton->setEnabled(true);
+    });
 }
 
 void MainWindow::onLoginButtonClicked()
@@ -434,7 +461,11 @@ void MainWindow::onLoginButtonClicked()
         return;
     }
     
-    authManager.login(email, password);
+    // Verification runs off the GUI thread; keep the button off until it finishes
+    ui->loginButton->setEnabled(false);
+    authManager.login(email, password).then(this, [this](bool) {
+        ui->loginButton->setEnabled(true);
+    });
 }
 
 void MainWindow::onLogoutButtonClicked()
@@ -487,13 +518,15 @@ void MainWindow::onRegistrationFailed(const QString& error)
 void MainWindow::onLoginSuccess()
 {
     QString email = authManager.getCurrentUserEmail();
-    User user = DatabaseManager::getInstance().getUserByEmail(email);
+    User user = StorageBackend::getInstance().getUserByEmail(email);
 
     if (email.isEmpty() || !authManager.isAuthenticated()) {
         showLoginPage();
         return;
     }
 
+    saveSessionCookie(authManager.getCurrentSessionToken());
+    sessionCheckTimer->start(300000);
     showMainPage();
 }
 
@@ -523,7 +556,7 @@ void MainWindow::onAdminButtonClicked()
 
     // Check if user is admin
     QString email = authManager.getCurrentUserEmail();
-    User user = DatabaseManager::getInstance().getUserByEmail(email);
+    User user = StorageBackend::getInstance().getUserByEmail(email);
     
     if (!user.isAdmin()) {
         QMessageBox::warning(this, "Access Denied", "You do not have permission to access the admin dashboard.");
@@ -26,6 +26,9 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
 private slots:
     void onRegisterButtonClicked();
     void onLoginButtonClicked();
@@ -43,6 +46,7 @@ private slots:
     void handleSessionToken(const QString& token);
     void checkSessionValidity();
     void onAdminButtonClicked();
+    void onStartupFinished();
 
 private:
     void setupUI();
@@ -53,13 +57,16 @@ private:
     void saveSessionCookie(const QString& token);
     void loadSessionCookie();
     void clearSessionCookie();
-    void setupProtectedPages();
+    void connectProtectedPage(ProtectedPage* page);
+    template <typename Page>
+    Page* ensurePage(Page*& page, const QString& name);
     bool validateSessionAndNavigate();
     
     Ui::MainWindow *ui;
     AuthManager& authManager;
     QNetworkAccessManager* networkManager;
     QNetworkCookieJar* cookieJar;
+    // Created on first navigation by ensurePage
     OrderHistoryPage* orderHistoryPage;
     CartPage* cartPage;
     ProductListingPage* productListingPage;
@@ -67,6 +74,7 @@ private:
     QTimer* sessionCheckTimer;
     QPushButton* adminButton;
     AdminDashboard* adminDashboard;
+    bool startupScheduled;
 };
 
 #endif // MAINWINDOW_H
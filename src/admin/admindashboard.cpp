@@ -4,10 +4,11 @@
 #include <QMessageBox>
 #include <QHeaderView>
 #include <QInputDialog>
-#include <QCryptographicHash>
+#include "../auth/passwordhasher.h"
 #include <QDateTime>
 #include <QDebug>
 #include <QScrollArea>
+#include <QMap>
 
 AdminDashboard::AdminDashboard(QWidget *parent) 
     : QMainWindow(parent)
@@ -23,7 +24,8 @@ AdminDashboard::AdminDashboard(QWidget *parent)
     , totalSalesLabel(nullptr)
     , totalOrdersLabel(nullptr)
     , averageOrderValueLabel(nullptr)
-    , db(DatabaseManager::getInstance())
+    , dailySalesTable(nullptr)
+    , db(StorageBackend::getInstance())
 {
     setupUI();
     refreshUserList();
@@ -395,6 +397,21 @@ void AdminDashboard::setupSalesReport() {
     metricsLayout->addWidget(averageOrderValueLabel);
 
     scrollLayout->addWidget(metricsContainer);
+
+    // Daily breakdown read from the sales rollup
+    QLabel* dailySalesTitle = new QLabel("📅 Last 14 Days");
+    dailySalesTitle->setStyleSheet(metricStyle);
+    scrollLayout->addWidget(dailySalesTitle);
+
+    dailySalesTable = new QTableWidget();
+    dailySalesTable->setColumnCount(4);
+    dailySalesTable->setHorizontalHeaderLabels({"Day", "Revenue", "Units", "Orders"});
+    dailySalesTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    dailySalesTable->verticalHeader()->setVisible(false);
+    dailySalesTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    dailySalesTable->setMinimumHeight(250);
+    scrollLayout->addWidget(dailySalesTable);
+
     scrollArea->setWidget(scrollContent);
     salesLayout->addWidget(scrollArea);
     tabWidget->addTab(salesTab, "💵 Sales Report");
@@ -487,13 +504,33 @@ void AdminDashboard::refreshProductList() {
 }
 
 void AdminDashboard::refreshSalesReport() {
-    double totalSales = db.getTotalSales();
-    int totalOrders = db.getTotalOrders();
-    double avgOrderValue = db.getAverageOrderValue();
+    SalesSummary summary = db.getSalesSummary();
+
+    totalSalesLabel->setText(QString("Total Sales: $%1").arg(summary.totalSales, 0, 'f', 2));
+    totalOrdersLabel->setText(QString("Total Orders: %1").arg(summary.totalOrders));
+    averageOrderValueLabel->setText(QString("Average Order Value: $%1").arg(summary.averageOrderValue, 0, 'f', 2));
+
+    // Rows are per (day, seller, category); fold them into one row per day
+    QDateTime now = QDateTime::currentDateTime();
+    QList<SalesRollupRow> rows = db.getSalesRollup(RollupGranularity::Daily, now.addDays(-13), now);
+    QMap<QString, SalesRollupRow> days;
+    for (const SalesRollupRow& row : rows) {
+        SalesRollupRow& day = days[row.bucket];
+        day.bucket = row.bucket;
+        day.revenue += row.revenue;
+        day.units += row.units;
+        day.orderCount += row.orderCount;
+    }
 
-    totalSalesLabel->setText(QString("Total Sales: $%1").arg(totalSales, 0, 'f', 2));
-    totalOrdersLabel->setText(QString("Total Orders: %1").arg(totalOrders));
-    averageOrderValueLabel->setText(QString("Average Order Value: $%1").arg(avgOrderValue, 0, 'f', 2));
+    dailySalesTable->setRowCount(days.size());
+    int i = 0;
+    for (auto it = days.constEnd(); it != days.constBegin(); ++i) {
+        --it;
+        dailySalesTable->setItem(i, 0, new QTableWidgetItem(it->bucket));
+        dailySalesTable->setItem(i, 1, new QTableWidgetItem(QString("$%1").arg(it->revenue, 0, 'f', 2)));
+        dailySalesTable->setItem(i, 2, new QTableWidgetItem(QString::number(it->units)));
+        dailySalesTable->setItem(i, 3, new QTableWidgetItem(QString::number(it->orderCount)));
+    }
 }
 
 void AdminDashboard::onSuspendUserClicked() {
@@ -554,15 +591,7 @@ void AdminDashboard::onResetPasswordClicked() {
                                               "", &ok);
     
     if (ok && !newPassword.isEmpty()) {
-        // Hash the password before storing
-        QByteArray hashedPassword = QCryptographicHash::hash(
-            newPassword.toUtf8(), QCryptographicHash::Sha256).toHex();
-            
-        if (db.resetUserPassword(userId, QString(hashedPassword))) {
-            QMessageBox::information(this, "Success", "Password reset successfully");
-        } else {
-            QMessageBox::warning(this, "Error", "Failed to reset password");
-        }
+        resetPassword(userId, newPassword);
     }
 }
 
@@ -606,16 +635,19 @@ void AdminDashboard::handleResetPassword(const User& user) {
                                               "", &ok);
     
     if (ok && !newPassword.isEmpty()) {
-        // Hash the password before storing
-        QByteArray hashedPassword = QCryptographicHash::hash(
-            newPassword.toUtf8(), QCryptographicHash::Sha256).toHex();
-            
-        if (db.resetUserPassword(db.getUserIdByEmail(user.getEmail()), QString(hashedPassword))) {
+        resetPassword(db.getUserIdByEmail(user.getEmail()), newPassword);
+    }
+}
+
+void AdminDashboard::resetPassword(int userId, const QString& newPassword) {
+    // Same hasher and format as registration, run off the GUI thread
+    PasswordHasher::getInstance().hashAsync(newPassword).then(this, [this, userId](const QString& hashedPassword) {
+        if (db.resetUserPassword(userId, hashedPassword)) {
             QMessageBox::information(this, "Success", "Password reset successfully");
         } else {
             QMessageBox::warning(this, "Error", "Failed to reset password");
         }
-    }
+    });
 }
 
 void AdminDashboard::onHomeClicked() {
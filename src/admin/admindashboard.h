@@ -9,7 +9,7 @@
 #include <QMessageBox>
 #include <QInputDialog>
 #include <QLabel>
-#include "../database/databasemanager.h"
+#include "../database/storagebackend.h"
 #include "../auth/user.h"
 
 class AdminDashboard : public QMainWindow {
@@ -39,6 +39,7 @@ private:
     void setupUserManagement();
     void setupProductManagement();
     void setupSalesReport();
+    void resetPassword(int userId, const QString& newPassword);
 
     QTabWidget* tabWidget;
     QWidget* userTab;
@@ -52,7 +53,8 @@ private:
     QLabel* totalSalesLabel;
     QLabel* totalOrdersLabel;
     QLabel* averageOrderValueLabel;
-    DatabaseManager& db;
+    QTableWidget* dailySalesTable;
+    StorageBackend& db;
 };
 
 #endif // ADMINDASHBOARD_H 
\ No newline at end of file
@@ -1,18 +1,16 @@
 #include "authmanager.h"
-#include <QCryptographicHash>
 #include <QRegularExpression>
 #include <QDebug>
-#include <QRandomGenerator>
+#include <QPromise>
 
 AuthManager::AuthManager() 
     : authenticated(false)
     , currentUserId(-1)
-    , dbManager(DatabaseManager::getInstance())
+    , dbManager(StorageBackend::getInstance())
     , sessionManager(SessionManager::getInstance())
+    , passwordHasher(PasswordHasher::getInstance())
 {
-    if (!dbManager.initialize()) {
-        qDebug() << "Failed to initialize database";
-    }
+    // Storage is opened after the login screen is shown, see ensureStorage
 }
 
 AuthManager::~AuthManager() {}
@@ -22,6 +20,17 @@ AuthManager& AuthManager::getInstance() {
     return instance;
 }
 
+bool AuthManager::ensureStorage() {
+    // MainWindow opens storage once the login screen is up; this covers a
+    // login or registration that arrives before then. Cheap once open.
+    if (!dbManager.initialize()) {
+        qDebug() << "Failed to initialize database";
+        return false;
+    }
+    sessionManager.attachStorage(dbManager);
+    return true;
+}
+
 bool AuthManager::validateEmail(const QString& email) {
     QRegularExpression emailRegex("\\b[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\\.[A-Za-z]{2,4}\\b");
     return emailRegex.match(email).hasMatch();
@@ -32,87 +41,80 @@ bool AuthManager::validatePassword(const QString& password) {
     return password.length() >= 8 && password.contains(QRegularExpression("[0-9]"));
 }
 
-QString AuthManager::hashPassword(const QString& password) {
-    // Generate a random salt using QRandomGenerator
-    QByteArray salt = QCryptographicHash::hash(
-        QByteArray::number(QRandomGenerator::global()->generate64()),
-        QCryptographicHash::Sha256
-    ).toHex();
-    
-    // Hash password with salt
-    QByteArray hashedPassword = QCryptographicHash::hash(
-        (password + salt).toUtf8(),
-        QCryptographicHash::Sha256
-    ).toHex();
-    
-    // Return combined hash and salt
-    return QString(hashedPassword + salt);
+QFuture<bool> AuthManager::finished(bool result) {
+    QPromise<bool> promise;
+    promise.start();
+    promise.addResult(result);
+    promise.finish();
+    return promise.future();
 }
 
-bool AuthManager::verifyPassword(const QString& password, const QString& hashedPassword) {
-    // Extract salt from stored hash
-    QByteArray salt = hashedPassword.mid(64).toUtf8();
-    
-    // Hash input password with same salt
-    QByteArray computedHash = QCryptographicHash::hash(
-        (password + QString(salt)).toUtf8(),
-        QCryptographicHash::Sha256
-    ).toHex();
+QFuture<bool> AuthManager::registerUser(const QString& email, const QString& username, const QString& password) {
+    if (!ensureStorage()) {
+        emit registrationFailed("Database unavailable");
+        return finished(false);
+    }
     
-    // Compare hashes
-    return computedHash == hashedPassword.left(64);
-}
-
-bool AuthManager::registerUser(const QString& email, const QString& username, const QString& password) {
     // Validate email
     if (!validateEmail(email)) {
         emit registrationFailed("Invalid email format");
-        return false;
+        return finished(false);
     }
     
     // Validate password
     if (!validatePassword(password)) {
         emit registrationFailed("Password must be at least 8 characters long and contain at least one number");
-        return false;
+        return finished(false);
     }
     
     // Check if user exists
     if (dbManager.userExists(email, username)) {
         emit registrationFailed("Email or username already exists");
-        return false;
+        return finished(false);
     }
     
-    // Hash password and create user
-    QString hashedPassword = hashPassword(password);
-    User user(email, username, hashedPassword);
-    
-    if (dbManager.addUser(user)) {
-        emit registrationSuccess();
-        return true;
-    } else {
+    // Hash on the worker pool, then store the user back on this thread
+    return passwordHasher.hashAsync(password).then(this, [this, email, username](const QString& hashedPassword) {
+        User user(email, username, hashedPassword);
+        if (dbManager.addUser(user)) {
+            emit registrationSuccess();
+            return true;
+        }
         emit registrationFailed("Failed to create user");
         return false;
-    }
+    });
 }
 
-bool AuthManager::login(const QString& email, const QString& password) {
+QFuture<bool> AuthManager::login(const QString& email, const QString& password) {
     qDebug() << "Attempting login for email:" << email;
+    if (!ensureStorage()) {
+        emit loginFailed("Database unavailable");
+        return finished(false);
+    }
     
     User user = dbManager.getUserByEmail(email);
     
     if (user.getEmail().isEmpty()) {
         qDebug() << "Login failed: User not found with email:" << email;
         emit loginFailed("Invalid email or password");
-        return false;
+        return finished(false);
     }
     
     if (user.isSuspended()) {
         qDebug() << "Login failed: Account is suspended for email:" << email;
         emit loginError("This account has been suspended. Please contact an administrator.");
-        return false;
+        return finished(false);
     }
     
-    if (verifyPassword(password, user.getHashedPassword())) {
+    // Verification runs on the hasher's pool; the result is applied on this thread
+    QString storedHash = user.getHashedPassword();
+    return passwordHasher.verifyAsync(password, storedHash).then(this, [this, user, email, password, storedHash](bool verified) {
+        if (!verified) {
+            qDebug() << "Login failed: Invalid password for email:" << email;
+            emit loginFailed("Invalid email or password");
+            return false;
+        }
+        
         authenticated = true;
         currentUser = user;
         currentUserEmail = user.getEmail();
@@ -126,13 +128,23 @@ bool AuthManager::login(const QString& email, const QString& password) {
                  << "ID:" << currentUserId 
                  << "Admin:" << user.isAdmin();
         
+        if (passwordHasher.needsRehash(storedHash)) {
+            upgradePasswordHash(currentUserId, password);
+        }
+        
         emit loginSuccess();
         return true;
-    }
-    
-    qDebug() << "Login failed: Invalid password for email:" << email;
-    emit loginFailed("Invalid email or password");
-    return false;
+    });
+}
+
+void AuthManager::upgradePasswordHash(int userId, const QString& password) {
+    // The password is only known right after it verified, so legacy and
+    // under-strength hashes are replaced then, off the GUI thread
+    passwordHasher.hashAsync(password).then(this, [this, userId](const QString& hashedPassword) {
+        if (dbManager.resetUserPassword(userId, hashedPassword)) {
+            qDebug() << "Upgraded password hash for user ID:" << userId;
+        }
+    });
 }
 
 void AuthManager::logout() {
@@ -171,11 +183,18 @@ QString AuthManager::getCurrentSessionToken() const {
 }
 
 void AuthManager::setSessionToken(const QString& token) {
-    if (sessionManager.validateSession(token)) {
-        currentSessionToken = token;
-        authenticated = true;
+    // Storage first: it is what brings back sessions from before a restart
+    if (ensureStorage() && sessionManager.validateSession(token)) {
         QString email = sessionManager.getUserIdFromToken(token);
         User user = dbManager.getUserByEmail(email);
+        if (user.getEmail().isEmpty() || user.isSuspended()) {
+            qDebug() << "Session not restored: account missing or suspended";
+            sessionManager.invalidateSession(token);
+            return;
+        }
+        currentSessionToken = token;
+        authenticated = true;
+        currentUser = user;
         currentUserEmail = user.getEmail();
         currentUserUsername = user.getUsername();
         currentUserId = dbManager.getUserIdByEmail(email);
@@ -3,8 +3,10 @@
 
 #include <QString>
 #include <QObject>
-#include "../database/databasemanager.h"
+#include <QFuture>
+#include "../database/storagebackend.h"
 #include "sessionmanager.h"
+#include "passwordhasher.h"
 #include "user.h"
 
 class AuthManager : public QObject {
@@ -13,8 +15,9 @@ class AuthManager : public QObject {
 public:
     static AuthManager& getInstance();
     
-    bool registerUser(const QString& email, const QString& username, const QString& password);
-    bool login(const QString& email, const QString& password);
+    // Both hash on a worker pool and signal the outcome as well as resolving the future
+    QFuture<bool> registerUser(const QString& email, const QString& username, const QString& password);
+    QFuture<bool> login(const QString& email, const QString& password);
     void logout();
     bool isAuthenticated() const;
     QString getCurrentUserEmail() const;
@@ -37,10 +40,11 @@ private:
     AuthManager(const AuthManager&) = delete;
     AuthManager& operator=(const AuthManager&) = delete;
     
+    bool ensureStorage();
     bool validateEmail(const QString& email);
     bool validatePassword(const QString& password);
-    QString hashPassword(const QString& password);
-    bool verifyPassword(const QString& password, const QString& hashedPassword);
+    void upgradePasswordHash(int userId, const QString& password);
+    static QFuture<bool> finished(bool result);
     
     bool authenticated;
     QString currentUserEmail;
@@ -48,8 +52,9 @@ private:
     QString currentSessionToken;
     int currentUserId;
     User currentUser;
-    DatabaseManager& dbManager;
+    StorageBackend& dbManager;
     SessionManager& sessionManager;
+    PasswordHasher& passwordHasher;
 };
 
 #endif // AUTHMANAGER_H 
\ No newline at end of file
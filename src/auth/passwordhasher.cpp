@@ -0,0 +1,116 @@
+#include "passwordhasher.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <QCryptographicHash>
+#include <QPasswordDigestor>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QThread>
+#include <QDebug>
+
+namespace {
+const QString SCHEME = "pbkdf2-sha256";
+
+// Compares without stopping at the first difference, so timing does not
+// reveal how much of a guess was right
+bool constantTimeEquals(const QByteArray& a, const QByteArray& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    char diff = 0;
+    for (int i = 0; i < a.size(); ++i) {
+        diff |= a.at(i) ^ b.at(i);
+    }
+    return diff == 0;
+}
+
+QByteArray derive(const QString& password, const QByteArray& salt, int iterations, int length) {
+    return QPasswordDigestor::deriveKeyPbkdf2(QCryptographicHash::Sha256, password.toUtf8(),
+                                              salt, iterations, quint64(length));
+}
+}
+
+PasswordHasher::PasswordHasher()
+    : iterations(DEFAULT_ITERATIONS)
+{
+    // Leave a core for the GUI thread
+    workers.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+PasswordHasher& PasswordHasher::getInstance() {
+    static PasswordHasher instance;
+    return instance;
+}
+
+void PasswordHasher::setIterations(int count) {
+    iterations.storeRelaxed(qMax(1, count));
+}
+
+int PasswordHasher::getIterations() const {
+    return iterations.loadRelaxed();
+}
+
+QString PasswordHasher::hash(const QString& password) const {
+    QByteArray salt(SALT_BYTES, '\0');
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32*>(salt.data()), SALT_BYTES / 4);
+
+    int count = getIterations();
+    QByteArray derived = derive(password, salt, count, HASH_BYTES);
+    return QString("%1$%2$%3$%4").arg(SCHEME).arg(count)
+        .arg(QString::fromLatin1(salt.toBase64()), QString::fromLatin1(derived.toBase64()));
+}
+
+bool PasswordHasher::verify(const QString& password, const QString& storedHash) const {
+    if (!storedHash.startsWith(SCHEME + "$")) {
+        return verifyLegacy(password, storedHash);
+    }
+
+    QStringList parts = storedHash.split('$');
+    if (parts.size() != 4) {
+        qDebug() << "Malformed password hash";
+        return false;
+    }
+    bool ok = false;
+    int count = parts[1].toInt(&ok);
+    QByteArray salt = QByteArray::fromBase64(parts[2].toLatin1());
+    QByteArray expected = QByteArray::fromBase64(parts[3].toLatin1());
+    if (!ok || count < 1 || salt.isEmpty() || expected.isEmpty()) {
+        qDebug() << "Malformed password hash";
+        return false;
+    }
+    return constantTimeEquals(derive(password, salt, count, expected.size()), expected);
+}
+
+bool PasswordHasher::verifyLegacy(const QString& password, const QString& storedHash) const {
+    // SHA-256 hex of password + salt, followed by the salt; the seeded admin
+    // and older admin resets have no salt at all
+    QString salt = storedHash.mid(64);
+    QByteArray computed = QCryptographicHash::hash(
+        (password + salt).toUtf8(),
+        QCryptographicHash::Sha256
+    ).toHex();
+    return constantTimeEquals(computed, storedHash.left(64).toLatin1());
+}
+
+bool PasswordHasher::needsRehash(const QString& storedHash) const {
+    if (!storedHash.startsWith(SCHEME + "$")) {
+        return true;
+    }
+    QStringList parts = storedHash.split('$');
+    return parts.size() != 4 || parts[1].toInt() < getIterations();
+}
+
+QFuture<QString> PasswordHasher::hashAsync(const QString& password) {
+    return QtConcurrent::run(&workers, [this, password]() {
+        return hash(password);
+    });
+}
+
+QFuture<bool> PasswordHasher::verifyAsync(const QString& password, const QString& storedHash) {
+    return QtConcurrent::run(&workers, [this, password, storedHash]() {
+        return verify(password, storedHash);
+    });
+}
+
+QThreadPool& PasswordHasher::workerPool() {
+    return workers;
+}
@@ -0,0 +1,48 @@
+#ifndef PASSWORDHASHER_H
+#define PASSWORDHASHER_H
+
+#include <QFuture>
+#include <QString>
+#include <QThreadPool>
+#include <QAtomicInt>
+
+// Hashes passwords with PBKDF2-HMAC-SHA256. Stored hashes carry their own
+// parameters, "pbkdf2-sha256$<iterations>$<salt>$<hash>" with base64 salt and
+// hash, so the iteration count can be raised without breaking old accounts;
+// needsRehash() reports hashes to upgrade after a successful login.
+// Older SHA-256 hashes, salted (hash hex + salt hex) or not, still verify.
+//
+// Hashing is slow on purpose, so the async calls run on a pool of their own
+// rather than the GUI thread or the global pool.
+class PasswordHasher {
+public:
+    static PasswordHasher& getInstance();
+
+    void setIterations(int iterations);
+    int getIterations() const;
+
+    QString hash(const QString& password) const;
+    bool verify(const QString& password, const QString& storedHash) const;
+    bool needsRehash(const QString& storedHash) const;
+
+    QFuture<QString> hashAsync(const QString& password);
+    QFuture<bool> verifyAsync(const QString& password, const QString& storedHash);
+
+    QThreadPool& workerPool();
+
+private:
+    PasswordHasher();
+    PasswordHasher(const PasswordHasher&) = delete;
+    PasswordHasher& operator=(const PasswordHasher&) = delete;
+
+    bool verifyLegacy(const QString& password, const QString& storedHash) const;
+
+    static const int DEFAULT_ITERATIONS = 210000;
+    static const int SALT_BYTES = 16;
+    static const int HASH_BYTES = 32;
+
+    QAtomicInt iterations;
+    QThreadPool workers;
+};
+
+#endif // PASSWORDHASHER_H
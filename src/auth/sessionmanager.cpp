@@ -1,9 +1,51 @@
 #include "sessionmanager.h"
-#include <QCryptographicHash>
-#include <QUuid>
+#include "../database/storagebackend.h"
+#include <QRandomGenerator>
+#include <QtEndian>
 #include <QDebug>
+#include <utility>
 
-SessionManager::SessionManager() {}
+SessionKey SessionKey::generate() {
+    SessionKey key;
+    QRandomGenerator* generator = QRandomGenerator::system();
+    key.high = generator->generate64();
+    key.low = generator->generate64();
+    return key;
+}
+
+bool SessionKey::fromToken(const QString& token, SessionKey* key) {
+    if (token.size() != 32) {
+        return false;
+    }
+    bool highOk = false;
+    bool lowOk = false;
+    key->high = token.left(16).toULongLong(&highOk, 16);
+    key->low = token.mid(16).toULongLong(&lowOk, 16);
+    return highOk && lowOk;
+}
+
+QString SessionKey::toToken() const {
+    return QString("%1%2").arg(high, 16, 16, QChar('0')).arg(low, 16, 16, QChar('0'));
+}
+
+QByteArray SessionKey::toBytes() const {
+    QByteArray bytes(16, '\0');
+    qToBigEndian<quint64>(high, bytes.data());
+    qToBigEndian<quint64>(low, bytes.data() + 8);
+    return bytes;
+}
+
+SessionManager::SessionManager()
+    : storage(nullptr)
+{
+    qint64 startTick = QDateTime::currentMSecsSinceEpoch() / WHEEL_TICK_MS;
+    for (Shard& shard : shards) {
+        shard.wheel.resize(WHEEL_SLOTS);
+        shard.lastTick = startTick;
+    }
+    connect(&wheelTimer, &QTimer::timeout, this, &SessionManager::expireDue);
+    wheelTimer.start(WHEEL_TICK_MS);
+}
 
 SessionManager::~SessionManager() {}
 
@@ -12,44 +54,166 @@ SessionManager& SessionManager::getInstance() {
     return instance;
 }
 
-QString SessionManager::createSession(const QString& userId) {
-    // Generate a unique token
-    QString token = QUuid::createUuid().toString(QUuid::WithoutBraces);
+SessionManager::Shard& SessionManager::shardFor(const SessionKey& key) {
+    // Tokens are random, so the low bits spread evenly
+    return shards[key.low % SHARD_COUNT];
+}
+
+const SessionManager::Shard& SessionManager::shardFor(const SessionKey& key) const {
+    return shards[key.low % SHARD_COUNT];
+}
+
+void SessionManager::insertLocked(Shard& shard, const SessionKey& key, const Session& session) {
+    shard.sessions.insert(key, session);
+    // A session already due goes in the next slot to be processed
+    qint64 tick = qMax(session.expiresAt / WHEEL_TICK_MS, shard.lastTick + 1);
+    shard.wheel[tick % WHEEL_SLOTS].append(key);
+}
+
+void SessionManager::attachStorage(StorageBackend& backend) {
+    if (storage) {
+        return;
+    }
+    storage = &backend;
+    
+    // Only hashes are stored, so sessions come back one by one as their
+    // tokens are presented, see findSession
+    storage->deleteExpiredSessions(QDateTime::currentMSecsSinceEpoch());
+}
+
+bool SessionManager::findSession(const SessionKey& key, Session* session) {
+    Shard& shard = shardFor(key);
+    {
+        QMutexLocker locker(&shard.mutex);
+        auto it = shard.sessions.constFind(key);
+        if (it != shard.sessions.constEnd()) {
+            *session = *it;
+            return true;
+        }
+    }
+    if (!storage) {
+        return false;
+    }
+    
+    StoredSession stored = storage->getSession(StoredSession::hashToken(key.toBytes()),
+                                               QDateTime::currentMSecsSinceEpoch());
+    if (stored.tokenHash.isEmpty()) {
+        return false;
+    }
+    session->userId = stored.userId;
+    session->expiresAt = stored.expiresAt;
     
-    // Create session with expiration time
+    QMutexLocker locker(&shard.mutex);
+    if (!shard.sessions.contains(key)) {
+        insertLocked(shard, key, *session);
+    }
+    return true;
+}
+
+QString SessionManager::createSession(const QString& userId) {
+    SessionKey key = SessionKey::generate();
     Session session;
     session.userId = userId;
-    session.expirationTime = QDateTime::currentDateTime().addSecs(SESSION_DURATION_HOURS * 3600);
+    session.expiresAt = QDateTime::currentMSecsSinceEpoch() + qint64(SESSION_DURATION_HOURS) * 3600 * 1000;
     
-    // Store session
-    activeSessions[token] = session;
+    {
+        Shard& shard = shardFor(key);
+        QMutexLocker locker(&shard.mutex);
+        insertLocked(shard, key, session);
+    }
     
-    return token;
+    if (storage) {
+        StoredSession stored;
+        stored.tokenHash = StoredSession::hashToken(key.toBytes());
+        stored.userId = userId;
+        stored.expiresAt = session.expiresAt;
+        storage->saveSession(stored);
+    }
+    return key.toToken();
 }
 
 bool SessionManager::validateSession(const QString& token) {
-    if (!activeSessions.contains(token)) {
+    SessionKey key;
+    if (!SessionKey::fromToken(token, &key)) {
         return false;
     }
     
-    Session& session = activeSessions[token];
+    // Expired entries may linger until their wheel slot comes round
+    Session session;
+    return findSession(key, &session) && session.expiresAt > QDateTime::currentMSecsSinceEpoch();
+}
+
+void SessionManager::invalidateSession(const QString& token) {
+    SessionKey key;
+    if (!SessionKey::fromToken(token, &key)) {
+        return;
+    }
     
-    // Check if session has expired
-    if (QDateTime::currentDateTime() > session.expirationTime) {
-        activeSessions.remove(token);
-        return false;
+    {
+        // The wheel entry is left behind and skipped when its slot is processed
+        Shard& shard = shardFor(key);
+        QMutexLocker locker(&shard.mutex);
+        shard.sessions.remove(key);
     }
     
-    return true;
+    if (storage) {
+        storage->deleteSession(StoredSession::hashToken(key.toBytes()));
+    }
 }
 
-void SessionManager::invalidateSession(const QString& token) {
-    activeSessions.remove(token);
+QString SessionManager::getUserIdFromToken(const QString& token) {
+    SessionKey key;
+    if (!SessionKey::fromToken(token, &key)) {
+        return QString();
+    }
+    
+    Session session;
+    return findSession(key, &session) ? session.userId : QString();
 }
 
-QString SessionManager::getUserIdFromToken(const QString& token) {
-    if (activeSessions.contains(token)) {
-        return activeSessions[token].userId;
+int SessionManager::activeSessionCount() const {
+    int count = 0;
+    for (const Shard& shard : shards) {
+        QMutexLocker locker(&shard.mutex);
+        count += shard.sessions.size();
     }
-    return QString();
-} 
\ No newline at end of file
+    return count;
+}
+
+void SessionManager::expireDue() {
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 nowTick = now / WHEEL_TICK_MS;
+    int expired = 0;
+    for (Shard& shard : shards) {
+        QMutexLocker locker(&shard.mutex);
+        if (nowTick <= shard.lastTick) {
+            continue;
+        }
+        // After a long stall every slot is due once; a full turn covers them all
+        qint64 firstTick = qMax(shard.lastTick + 1, nowTick - WHEEL_SLOTS + 1);
+        for (qint64 tick = firstTick; tick <= nowTick; ++tick) {
+            QList<SessionKey>& slot = shard.wheel[tick % WHEEL_SLOTS];
+            QList<SessionKey> due = std::exchange(slot, QList<SessionKey>());
+            for (const SessionKey& key : due) {
+                auto it = shard.sessions.find(key);
+                if (it == shard.sessions.end()) {
+                    continue;  // Logged out already
+                }
+                if (it->expiresAt <= now) {
+                    shard.sessions.erase(it);
+                    expired++;
+                } else {
+                    slot.append(key);  // Due on a later turn of the wheel
+                }
+            }
+        }
+        shard.lastTick = nowTick;
+    }
+    
+    if (storage) {
+        storage->deleteExpiredSessions(now);
+    }
+    if (expired > 0) {
+        qDebug() << "Expired" << expired << "sessions";
+    }
+}
@@ -2,31 +2,101 @@
 #define SESSIONMANAGER_H
 
 #include <QString>
+#include <QByteArray>
 #include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
 #include <QObject>
+#include <QTimer>
+#include <QVector>
 
+class StorageBackend;
+
+// 128-bit session token. Tokens travel as 32 hex characters but are looked
+// up by value, so hashing and comparison work on two integers.
+struct SessionKey {
+    quint64 high;
+    quint64 low;
+    
+    SessionKey() : high(0), low(0) {}
+    
+    static SessionKey generate();
+    // Returns false for anything that is not exactly 32 hex characters
+    static bool fromToken(const QString& token, SessionKey* key);
+    QString toToken() const;
+    QByteArray toBytes() const;
+    
+    bool operator==(const SessionKey& other) const { return high == other.high && low == other.low; }
+};
+
+inline size_t qHash(const SessionKey& key, size_t seed = 0) {
+    return qHashMulti(seed, key.high, key.low);
+}
+
+// Keeps sessions in sharded hash tables so validation on several threads
+// rarely contends, and expires them with a timing wheel: each session sits in
+// the wheel slot for its expiry minute, and every tick only visits that slot.
+// With storage attached, sessions are written to the sessions table under a
+// hash of the token, and a token missing from memory after a restart is
+// looked up there by its hash, so a restart does not log anyone out.
 class SessionManager : public QObject {
     Q_OBJECT
     
 public:
     static SessionManager& getInstance();
     
+    // Purges expired sessions and persists changes from now on; later calls do nothing
+    void attachStorage(StorageBackend& storage);
+    
     QString createSession(const QString& userId);
     bool validateSession(const QString& token);
     void invalidateSession(const QString& token);
     QString getUserIdFromToken(const QString& token);
+    int activeSessionCount() const;
+    
+private slots:
+    void expireDue();
     
 private:
     SessionManager();
     ~SessionManager();
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
     
     struct Session {
         QString userId;
-        QDateTime expirationTime;
+        qint64 expiresAt;  // Milliseconds since the Unix epoch
+        
+        Session() : expiresAt(0) {}
+    };
+    
+    // lastTick lives here rather than on the manager so inserts and the
+    // expiry pass read and advance it under the same mutex
+    struct Shard {
+        mutable QMutex mutex;
+        QHash<SessionKey, Session> sessions;
+        QVector<QList<SessionKey>> wheel;  // Slot -> keys expiring in that tick
+        qint64 lastTick;                   // Last wheel tick processed
+        
+        Shard() : lastTick(0) {}
     };
     
-    QMap<QString, Session> activeSessions;
+    static const int SHARD_COUNT = 16;
+    static const int WHEEL_SLOTS = 256;
+    static const qint64 WHEEL_TICK_MS = 60 * 1000;
     static const int SESSION_DURATION_HOURS = 24;
+    
+    Shard& shardFor(const SessionKey& key);
+    const Shard& shardFor(const SessionKey& key) const;
+    // Caller holds the shard's mutex
+    void insertLocked(Shard& shard, const SessionKey& key, const Session& session);
+    // Memory first, then storage; a stored session is kept in memory once found
+    bool findSession(const SessionKey& key, Session* session);
+    
+    Shard shards[SHARD_COUNT];
+    QTimer wheelTimer;
+    StorageBackend* storage;
 };
 
-#endif // SESSIONMANAGER_H 
\ No newline at end of file
+#endif // SESSIONMANAGER_H
@@ -0,0 +1,424 @@
+#include "backupservice.h"
+#include <QtSql/QSqlDriver>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+
+#ifdef MARKETPLACE_HAVE_SQLITE3
+#include <sqlite3.h>
+#endif
+
+BackupService::BackupService(QObject *parent)
+    : QObject(parent)
+    , sourceConnectionName("marketplace_backup_source")
+    , destination(nullptr)
+    , backup(nullptr)
+    , lastRemaining(0)
+    , restarts(0)
+    , running(false)
+{
+    stepTimer.setSingleShot(true);
+    connect(&stepTimer, &QTimer::timeout, this, &BackupService::step);
+    connect(&copyWatcher, &QFutureWatcher<bool>::finished, this, &BackupService::onCopyFinished);
+    connect(&scheduleTimer, &QTimer::timeout, this, &BackupService::backupNow);
+}
+
+BackupService::~BackupService() {
+    stepTimer.stop();
+    copyWatcher.disconnect();
+    copyWatcher.waitForFinished();
+    closeIncremental();
+    if (running) {
+        QFile::remove(partPath);
+    }
+    if (QSqlDatabase::contains(sourceConnectionName)) {
+        {
+            QSqlDatabase source = QSqlDatabase::database(sourceConnectionName, false);
+            source.close();
+        }
+        QSqlDatabase::removeDatabase(sourceConnectionName);
+    }
+}
+
+void BackupService::setDatabasePath(const QString& path) {
+    databasePath = path;
+}
+
+void BackupService::setArchivePath(const QString& path) {
+    archivePath = path;
+}
+
+void BackupService::setConfig(const BackupConfig& newConfig) {
+    config = newConfig;
+    if (scheduleTimer.isActive()) {
+        start();
+    }
+}
+
+BackupConfig BackupService::getConfig() const {
+    return config;
+}
+
+void BackupService::start() {
+    if (config.intervalMs > 0) {
+        scheduleTimer.start(config.intervalMs);
+    } else {
+        scheduleTimer.stop();
+    }
+}
+
+void BackupService::stop() {
+    scheduleTimer.stop();
+}
+
+bool BackupService::isRunning() const {
+    return running;
+}
+
+QString BackupService::lastBackupPath() const {
+    return lastPath;
+}
+
+bool BackupService::openSource() {
+    // Kept open between backups so each run skips opening and schema parsing
+    QSqlDatabase source = QSqlDatabase::contains(sourceConnectionName)
+        ? QSqlDatabase::database(sourceConnectionName, false)
+        : QSqlDatabase::addDatabase("QSQLITE", sourceConnectionName);
+    if (source.isOpen()) {
+        return true;
+    }
+    source.setDatabaseName(databasePath);
+    source.setConnectOptions("QSQLITE_OPEN_READONLY");
+    if (!source.open()) {
+        qDebug() << "Error opening backup source:" << source.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool BackupService::attachArchive() {
+    QSqlQuery query(QSqlDatabase::database(sourceConnectionName, false));
+    if (!query.exec("PRAGMA database_list")) {
+        qDebug() << "Error reading backup source schemas:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        if (query.value("name").toString() == "archive") {
+            return true;
+        }
+    }
+    query.finish();
+
+    // Attached read-only, like the source connection itself
+    query.prepare("ATTACH DATABASE ? AS archive");
+    query.addBindValue(archivePath);
+    if (!query.exec()) {
+        qDebug() << "Error attaching archive to backup source:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QString BackupService::backupPath(const QString& schema) const {
+    QString name = schema == "main"
+        ? QString("marketplace-%1.db").arg(setStamp)
+        : QString("marketplace-%1-%2.db").arg(setStamp, schema);
+    return QDir(config.backupDir).filePath(name);
+}
+
+bool BackupService::backupNow() {
+    if (running) {
+        qDebug() << "Backup already in progress";
+        return false;
+    }
+    if (databasePath.isEmpty() || config.backupDir.isEmpty()) {
+        qDebug() << "Backup not configured";
+        return false;
+    }
+    if (!QDir().mkpath(config.backupDir) || !openSource()) {
+        emit backupFinished(false, QString());
+        return false;
+    }
+
+    // Main is copied before the archive: orders archived in between then
+    // show up in both copies, which the all_orders view tolerates, rather
+    // than in neither
+    schemas = QStringList{"main"};
+    if (!archivePath.isEmpty()) {
+        if (!attachArchive()) {
+            emit backupFinished(false, QString());
+            return false;
+        }
+        schemas << "archive";
+    }
+    setStamp = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
+    writtenPaths.clear();
+    running = true;
+    startCopy();
+    return true;
+}
+
+void BackupService::startCopy() {
+    const QString schema = schemas.first();
+    partPath = backupPath(schema) + ".part";
+    QFile::remove(partPath);
+    restarts = 0;
+    lastRemaining = 0;
+    qDebug() << "Starting backup of" << schema << "to:" << partPath;
+
+#ifdef MARKETPLACE_HAVE_SQLITE3
+    if (beginIncremental(schema)) {
+        stepTimer.start(0);
+        return;
+    }
+    qDebug() << "Incremental backup unavailable, falling back to VACUUM INTO";
+#endif
+    finishOnWorker(true, false);
+}
+
+bool BackupService::sameSqliteLibrary() {
+#ifdef MARKETPLACE_HAVE_SQLITE3
+    // The build option promises a Qt built with -system-sqlite. Check that the
+    // plugin answers with exactly the library linked here, since handing its
+    // sqlite3* to another copy of SQLite is undefined behaviour.
+    QSqlQuery query(QSqlDatabase::database(sourceConnectionName, false));
+    if (!query.exec("SELECT sqlite_version(), sqlite_source_id()") || !query.next()) {
+        qDebug() << "Error reading plugin SQLite version:" << query.lastError().text();
+        return false;
+    }
+    if (query.value(0).toString() != QLatin1String(sqlite3_libversion())
+        || query.value(1).toString() != QLatin1String(sqlite3_sourceid())) {
+        qDebug() << "Qt SQLite plugin uses SQLite" << query.value(0).toString()
+                 << "but" << sqlite3_libversion() << "is linked, not using the backup API";
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool BackupService::beginIncremental(const QString& schema) {
+#ifdef MARKETPLACE_HAVE_SQLITE3
+    QVariant handle = QSqlDatabase::database(sourceConnectionName, false).driver()->handle();
+    if (!handle.isValid() || qstrcmp(handle.typeName(), "sqlite3*") != 0) {
+        return false;
+    }
+    if (!sameSqliteLibrary()) {
+        return false;
+    }
+    sqlite3* source = *static_cast<sqlite3**>(handle.data());
+    if (!source) {
+        return false;
+    }
+
+    if (sqlite3_open_v2(QFile::encodeName(partPath).constData(), &destination,
+                        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK) {
+        qDebug() << "Error opening backup destination:" << sqlite3_errmsg(destination);
+        closeIncremental();
+        return false;
+    }
+
+    backup = sqlite3_backup_init(destination, "main", source, schema.toUtf8().constData());
+    if (!backup) {
+        qDebug() << "Error starting backup:" << sqlite3_errmsg(destination);
+        closeIncremental();
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void BackupService::step() {
+#ifdef MARKETPLACE_HAVE_SQLITE3
+    if (!backup) {
+        return;
+    }
+
+    // Writes through another connection restart the copy. After a few restarts
+    // hand it to VACUUM INTO on the worker, a single read transaction in WAL,
+    // rather than copying the rest in one step on this thread.
+    if (restarts >= config.maxRestarts) {
+        qDebug() << "Backup restarted" << restarts << "times, falling back to VACUUM INTO";
+        closeIncremental();
+        QFile::remove(partPath);
+        finishOnWorker(true, false);
+        return;
+    }
+
+    int rc = sqlite3_backup_step(backup, config.pagesPerStep);
+    int remaining = sqlite3_backup_remaining(backup);
+    int total = sqlite3_backup_pagecount(backup);
+    if (remaining > lastRemaining && lastRemaining > 0) {
+        restarts++;
+    }
+    lastRemaining = remaining;
+    emit progress(remaining, total);
+
+    if (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED) {
+        stepTimer.start(config.stepIntervalMs);
+        return;
+    }
+
+    if (rc != SQLITE_DONE) {
+        qDebug() << "Backup step failed:" << sqlite3_errstr(rc);
+    }
+    finishIncremental(rc == SQLITE_DONE);
+#endif
+}
+
+void BackupService::finishIncremental(bool copied) {
+    if (!closeIncremental()) {
+        copied = false;
+    }
+    finishOnWorker(false, copied);
+}
+
+bool BackupService::closeIncremental() {
+    bool ok = true;
+#ifdef MARKETPLACE_HAVE_SQLITE3
+    if (backup) {
+        ok = sqlite3_backup_finish(backup) == SQLITE_OK;
+        backup = nullptr;
+    }
+    if (destination) {
+        sqlite3_close(destination);
+        destination = nullptr;
+    }
+#endif
+    return ok;
+}
+
+void BackupService::finishOnWorker(bool vacuum, bool copied) {
+    // Both VACUUM INTO and quick_check read the whole file, so neither runs here
+    const QString source = databasePath;
+    const QString archive = archivePath;
+    const QString schema = schemas.first();
+    const QString path = partPath;
+    const bool verify = config.verify;
+    copyWatcher.setFuture(QtConcurrent::run([source, archive, schema, path, vacuum, copied, verify]() {
+        bool ok = vacuum ? vacuumInto(source, archive, schema, path) : copied;
+        return ok && (!verify || verifyCopy(path));
+    }));
+}
+
+void BackupService::onCopyFinished() {
+    complete(copyWatcher.result());
+}
+
+bool BackupService::vacuumInto(const QString& databasePath, const QString& archivePath,
+                               const QString& schema, const QString& path) {
+    const QString connectionName = "marketplace_backup_vacuum";
+    bool ok = false;
+    {
+        QSqlDatabase source = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        source.setDatabaseName(databasePath);
+        source.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (source.open()) {
+            QSqlQuery query(source);
+            ok = true;
+            if (schema != "main") {
+                query.prepare(QString("ATTACH DATABASE ? AS %1").arg(schema));
+                query.addBindValue(archivePath);
+                ok = query.exec();
+            }
+            if (ok) {
+                query.prepare(QString("VACUUM %1 INTO ?").arg(schema));
+                query.addBindValue(path);
+                ok = query.exec();
+            }
+            if (!ok) {
+                qDebug() << "Error writing backup:" << query.lastError().text();
+            }
+            query.finish();
+            source.close();
+        } else {
+            qDebug() << "Error opening backup source:" << source.lastError().text();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok;
+}
+
+void BackupService::complete(bool ok) {
+    QString finalPath;
+    if (ok) {
+        finalPath = partPath.left(partPath.length() - QString(".part").length());
+        QFile::remove(finalPath);
+        ok = QFile::rename(partPath, finalPath);
+    }
+
+    if (ok) {
+        qDebug() << "Backup written to:" << finalPath;
+        writtenPaths << finalPath;
+        schemas.removeFirst();
+        if (!schemas.isEmpty()) {
+            startCopy();
+            return;
+        }
+    }
+
+    running = false;
+    if (ok) {
+        lastPath = writtenPaths.first();
+        pruneOldBackups();
+        emit backupFinished(true, lastPath);
+        return;
+    }
+
+    // A set missing its archive cannot restore every order, so none of it is kept
+    qDebug() << "Backup failed, discarding:" << partPath;
+    QFile::remove(partPath);
+    for (const QString& path : writtenPaths) {
+        QFile::remove(path);
+    }
+    writtenPaths.clear();
+    emit backupFinished(false, QString());
+}
+
+bool BackupService::verifyCopy(const QString& path) {
+    const QString connectionName = "marketplace_backup_verify";
+    bool ok = false;
+    {
+        QSqlDatabase copy = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        copy.setDatabaseName(path);
+        copy.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (copy.open()) {
+            QSqlQuery query(copy);
+            ok = query.exec("PRAGMA quick_check") && query.next() && query.value(0).toString() == "ok";
+            if (!ok) {
+                qDebug() << "Backup failed verification:" << query.value(0).toString() << query.lastError().text();
+            }
+            query.finish();
+            copy.close();
+        } else {
+            qDebug() << "Error opening backup for verification:" << copy.lastError().text();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    return ok;
+}
+
+void BackupService::pruneOldBackups() {
+    QDir dir(config.backupDir);
+    // Timestamped names sort oldest first; archive copies go with their set
+    QStringList backups = dir.entryList({"marketplace-*.db"}, QDir::Files, QDir::Name);
+    backups.removeIf([](const QString& name) { return name.endsWith("-archive.db"); });
+    while (backups.size() > config.keepBackups) {
+        QString oldest = backups.takeFirst();
+        QString oldestArchive = oldest.left(oldest.length() - QString(".db").length()) + "-archive.db";
+        if (!dir.remove(oldest)) {
+            qDebug() << "Error removing old backup:" << oldest;
+        }
+        if (dir.exists(oldestArchive) && !dir.remove(oldestArchive)) {
+            qDebug() << "Error removing old backup:" << oldestArchive;
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef BACKUPSERVICE_H
+#define BACKUPSERVICE_H
+
+#include <QtSql/QSqlDatabase>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+struct sqlite3;
+struct sqlite3_backup;
+
+struct BackupConfig {
+    QString backupDir;     // Where finished backups are written
+    int pagesPerStep;      // Pages copied per step; smaller yields more often
+    int stepIntervalMs;    // Pause between steps, caps throughput
+    int maxRestarts;       // Restarts caused by writes before switching to VACUUM INTO
+    int intervalMs;        // Time between scheduled backups, 0 disables the schedule
+    int keepBackups;       // Older backups beyond this are deleted
+    bool verify;           // Run PRAGMA quick_check on the copy before keeping it
+
+    BackupConfig()
+        : pagesPerStep(64), stepIntervalMs(50), maxRestarts(3)
+        , intervalMs(24 * 60 * 60 * 1000), keepBackups(5), verify(true) {}
+};
+
+// Copies the live database while the app keeps running. With the backup API
+// enabled (MARKETPLACE_SQLITE_BACKUP_API) and the Qt plugin on the same SQLite
+// library, a few pages are copied per step on a timer so the write connection
+// never waits for the whole copy. Otherwise, or when writes keep restarting
+// it, the copy is a VACUUM INTO on a worker thread with its own read
+// connection, which in WAL mode also leaves writers alone.
+// Copies go to a .part file and are renamed only after they check out; the
+// check reads the whole copy, so it runs on the worker as well. With an
+// archive path set, each backup is a set: marketplace-<time>.db followed by
+// marketplace-<time>-archive.db, kept or discarded and pruned together.
+class BackupService : public QObject {
+    Q_OBJECT
+
+public:
+    explicit BackupService(QObject *parent = nullptr);
+    ~BackupService();
+
+    void setDatabasePath(const QString& path);
+    // The order archive file; empty leaves it out of backups
+    void setArchivePath(const QString& path);
+    void setConfig(const BackupConfig& config);
+    BackupConfig getConfig() const;
+
+    // Starts the schedule; the first backup runs after one interval
+    void start();
+    void stop();
+
+    // Starts a backup now; false if one is already running
+    bool backupNow();
+    bool isRunning() const;
+    QString lastBackupPath() const;
+
+signals:
+    void progress(int remainingPages, int totalPages);
+    void backupFinished(bool success, const QString& path);
+
+private slots:
+    void step();
+    void onCopyFinished();
+
+private:
+    bool openSource();
+    bool attachArchive();
+    QString backupPath(const QString& schema) const;
+    void startCopy();
+    bool sameSqliteLibrary();
+    bool beginIncremental(const QString& schema);
+    void finishIncremental(bool copied);
+    bool closeIncremental();
+    void finishOnWorker(bool vacuum, bool copied);
+    void complete(bool ok);
+    void pruneOldBackups();
+    // Run on the worker, each on a connection of its own
+    static bool vacuumInto(const QString& databasePath, const QString& archivePath,
+                           const QString& schema, const QString& path);
+    static bool verifyCopy(const QString& path);
+
+    QString databasePath;
+    QString archivePath;
+    QString sourceConnectionName;
+    QString setStamp;          // Timestamp shared by the files of one backup
+    QStringList schemas;       // Still to copy in this backup, current first
+    QStringList writtenPaths;  // Finished files of this backup
+    QString partPath;
+    QString lastPath;
+    BackupConfig config;
+    QTimer scheduleTimer;
+    QTimer stepTimer;
+    QFutureWatcher<bool> copyWatcher;
+    sqlite3* destination;
+    sqlite3_backup* backup;
+    int lastRemaining;
+    int restarts;
+    bool running;
+};
+
+#endif // BACKUPSERVICE_H
@@ -0,0 +1,69 @@
+#include "catalogcache.h"
+#include "catalogsnapshot.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+
+CatalogCache::CatalogCache(StorageBackend& backend, const QString& snapshotPath, QObject *parent)
+    : QObject(parent)
+    , backend(backend)
+    , snapshotPath(snapshotPath)
+    , version(-1)
+{
+    connect(&watcher, &QFutureWatcher<RefreshResult>::finished, this, &CatalogCache::onRefreshFinished);
+}
+
+QList<Product> CatalogCache::load() {
+    if (snapshotPath.isEmpty()) {
+        return QList<Product>();
+    }
+
+    // The mapping is dropped again straight away so the refresh can replace the file
+    CatalogSnapshot snapshot;
+    if (!snapshot.open(snapshotPath)) {
+        return QList<Product>();
+    }
+    version = snapshot.catalogVersion();
+    return snapshot.products();
+}
+
+qint64 CatalogCache::loadedVersion() const {
+    return version;
+}
+
+bool CatalogCache::isRefreshing() const {
+    return watcher.isRunning();
+}
+
+void CatalogCache::refreshIfStale() {
+    if (watcher.isRunning()) {
+        return;
+    }
+    watcher.setFuture(QtConcurrent::run(&CatalogCache::refresh, &backend, snapshotPath, version));
+}
+
+CatalogCache::RefreshResult CatalogCache::refresh(StorageBackend* backend, const QString& path, qint64 knownVersion) {
+    RefreshResult result;
+    result.version = backend->getCatalogVersion();
+    if (knownVersion != -1 && result.version == knownVersion) {
+        return result;
+    }
+
+    // Read the version first: a write landing in between leaves the file
+    // tagged older than its contents, which only costs one extra refresh
+    result.changed = true;
+    result.products = backend->getAllProducts();
+    if (!path.isEmpty() && result.version != -1) {
+        CatalogSnapshot::write(path, result.version, result.products);
+    }
+    return result;
+}
+
+void CatalogCache::onRefreshFinished() {
+    RefreshResult result = watcher.result();
+    if (!result.changed) {
+        return;
+    }
+    version = result.version;
+    qDebug() << "Catalog refreshed to version" << version << "with" << result.products.size() << "products";
+    emit catalogRefreshed(result.products);
+}
@@ -0,0 +1,52 @@
+#ifndef CATALOGCACHE_H
+#define CATALOGCACHE_H
+
+#include "storagebackend.h"
+#include <QObject>
+#include <QFutureWatcher>
+#include <QList>
+#include <QString>
+
+// Serves the product catalog from a CatalogSnapshot file so the browse page
+// can paint before the database is queried, then checks the catalog version
+// on a worker thread and rebuilds the file when the database has moved on.
+class CatalogCache : public QObject {
+    Q_OBJECT
+
+public:
+    // An empty path keeps nothing on disk and always reads the backend
+    CatalogCache(StorageBackend& backend, const QString& snapshotPath, QObject *parent = nullptr);
+
+    // Products from the snapshot file; empty if there is none or it is unusable
+    QList<Product> load();
+    qint64 loadedVersion() const;
+
+    // No-op while a refresh is already running
+    void refreshIfStale();
+    bool isRefreshing() const;
+
+signals:
+    // Only emitted when the database version differs from the loaded one
+    void catalogRefreshed(const QList<Product>& products);
+
+private slots:
+    void onRefreshFinished();
+
+private:
+    struct RefreshResult {
+        bool changed;
+        qint64 version;
+        QList<Product> products;
+
+        RefreshResult() : changed(false), version(-1) {}
+    };
+
+    static RefreshResult refresh(StorageBackend* backend, const QString& path, qint64 knownVersion);
+
+    StorageBackend& backend;
+    QString snapshotPath;
+    qint64 version;
+    QFutureWatcher<RefreshResult> watcher;
+};
+
+#endif // CATALOGCACHE_H
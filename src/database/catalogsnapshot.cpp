@@ -0,0 +1,274 @@
+#include "catalogsnapshot.h"
+#include <QSaveFile>
+#include <QPair>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+const quint32 MAGIC = 0x5441434D;  // "MCAT"
+const quint32 FORMAT_VERSION = 2;
+
+// Header: magic, format, record size, record count, catalog version, then
+// the offsets of the record, index and pool sections and the pool size
+const int HEADER_SIZE = 64;
+
+// Record: id, seller id, stock, flags, price bits, then four (offset,
+// length) spans into the pool: name, description, category and image URL.
+// Image bytes are not copied; FLAG_HAS_IMAGE_DATA says the database has some.
+const int RECORD_SIZE = 64;
+const int SPAN_NAME = 24;
+const int SPAN_DESCRIPTION = 32;
+const int SPAN_CATEGORY = 40;
+const int SPAN_IMAGE_URL = 48;
+const quint32 FLAG_HAS_IMAGE_DATA = 0x1;
+
+// Index entry: product id, record number; sorted by id
+const int INDEX_ENTRY_SIZE = 8;
+
+void putU32(QByteArray& buffer, int pos, quint32 value) {
+    qToLittleEndian<quint32>(value, buffer.data() + pos);
+}
+
+void putU64(QByteArray& buffer, int pos, quint64 value) {
+    qToLittleEndian<quint64>(value, buffer.data() + pos);
+}
+
+quint32 getU32(const uchar* p) {
+    return qFromLittleEndian<quint32>(p);
+}
+
+quint64 getU64(const uchar* p) {
+    return qFromLittleEndian<quint64>(p);
+}
+
+// Appends bytes to the pool and stores where they went in the record
+bool putSpan(QByteArray& record, int pos, QByteArray& pool, const QByteArray& bytes) {
+    if (quint64(pool.size()) + quint64(bytes.size()) > std::numeric_limits<quint32>::max()) {
+        return false;
+    }
+    putU32(record, pos, quint32(pool.size()));
+    putU32(record, pos + 4, quint32(bytes.size()));
+    pool.append(bytes);
+    return true;
+}
+}
+
+CatalogSnapshot::CatalogSnapshot()
+    : data(nullptr)
+    , size(0)
+    , version(-1)
+    , recordCount(0)
+    , recordsOffset(0)
+    , indexOffset(0)
+    , poolOffset(0)
+    , poolSize(0)
+{
+}
+
+CatalogSnapshot::~CatalogSnapshot() {
+    close();
+}
+
+bool CatalogSnapshot::write(const QString& path, qint64 catalogVersion, const QList<Product>& products) {
+    QByteArray records(products.size() * RECORD_SIZE, '\0');
+    QByteArray pool;
+    QList<QPair<int, quint32>> index;
+    index.reserve(products.size());
+
+    for (int i = 0; i < products.size(); ++i) {
+        const Product& product = products.at(i);
+        QByteArray record(RECORD_SIZE, '\0');
+        putU32(record, 0, quint32(product.id));
+        putU32(record, 4, quint32(product.sellerId));
+        putU32(record, 8, quint32(product.stock));
+        putU32(record, 12, product.hasImageData || !product.imageData.isEmpty() ? FLAG_HAS_IMAGE_DATA : 0);
+        quint64 priceBits;
+        std::memcpy(&priceBits, &product.price, sizeof(priceBits));
+        putU64(record, 16, priceBits);
+
+        if (!putSpan(record, SPAN_NAME, pool, product.name.toUtf8())
+            || !putSpan(record, SPAN_DESCRIPTION, pool, product.description.toUtf8())
+            || !putSpan(record, SPAN_CATEGORY, pool, product.category.toUtf8())
+            || !putSpan(record, SPAN_IMAGE_URL, pool, product.imageUrl.toUtf8())) {
+            qDebug() << "Catalog snapshot too large, not writing" << path;
+            return false;
+        }
+        records.replace(i * RECORD_SIZE, RECORD_SIZE, record);
+        index.append(qMakePair(product.id, quint32(i)));
+    }
+
+    std::sort(index.begin(), index.end());
+    QByteArray indexBytes(index.size() * INDEX_ENTRY_SIZE, '\0');
+    for (int i = 0; i < index.size(); ++i) {
+        putU32(indexBytes, i * INDEX_ENTRY_SIZE, quint32(index.at(i).first));
+        putU32(indexBytes, i * INDEX_ENTRY_SIZE + 4, index.at(i).second);
+    }
+
+    quint64 recordsStart = HEADER_SIZE;
+    quint64 indexStart = recordsStart + quint64(records.size());
+    quint64 poolStart = indexStart + quint64(indexBytes.size());
+
+    QByteArray header(HEADER_SIZE, '\0');
+    putU32(header, 0, MAGIC);
+    putU32(header, 4, FORMAT_VERSION);
+    putU32(header, 8, RECORD_SIZE);
+    putU32(header, 12, quint32(products.size()));
+    putU64(header, 16, quint64(catalogVersion));
+    putU64(header, 24, recordsStart);
+    putU64(header, 32, indexStart);
+    putU64(header, 40, poolStart);
+    putU64(header, 48, quint64(pool.size()));
+
+    // QSaveFile renames over the old file only after everything is written,
+    // so a reader never maps a half-written snapshot
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        qDebug() << "Error writing catalog snapshot:" << out.errorString();
+        return false;
+    }
+    out.write(header);
+    out.write(records);
+    out.write(indexBytes);
+    out.write(pool);
+    if (!out.commit()) {
+        qDebug() << "Error writing catalog snapshot:" << out.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool CatalogSnapshot::open(const QString& path) {
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    size = file.size();
+    if (size < HEADER_SIZE) {
+        qDebug() << "Catalog snapshot truncated:" << path;
+        close();
+        return false;
+    }
+    data = file.map(0, size);
+    if (!data) {
+        qDebug() << "Error mapping catalog snapshot:" << file.errorString();
+        close();
+        return false;
+    }
+
+    if (getU32(data) != MAGIC || getU32(data + 4) != FORMAT_VERSION || getU32(data + 8) != RECORD_SIZE) {
+        qDebug() << "Catalog snapshot has an unknown format:" << path;
+        close();
+        return false;
+    }
+    recordCount = getU32(data + 12);
+    version = qint64(getU64(data + 16));
+    recordsOffset = getU64(data + 24);
+    indexOffset = getU64(data + 32);
+    poolOffset = getU64(data + 40);
+    poolSize = getU64(data + 48);
+
+    // Every section must lie inside the file before any record is read
+    quint64 fileSize = quint64(size);
+    if (recordsOffset + quint64(recordCount) * RECORD_SIZE > fileSize
+        || indexOffset + quint64(recordCount) * INDEX_ENTRY_SIZE > fileSize
+        || poolOffset > fileSize || poolSize > fileSize - poolOffset) {
+        qDebug() << "Catalog snapshot sections out of bounds:" << path;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void CatalogSnapshot::close() {
+    if (data) {
+        file.unmap(const_cast<uchar*>(data));
+        data = nullptr;
+    }
+    file.close();
+    size = 0;
+    version = -1;
+    recordCount = 0;
+}
+
+bool CatalogSnapshot::isOpen() const {
+    return data != nullptr;
+}
+
+qint64 CatalogSnapshot::catalogVersion() const {
+    return version;
+}
+
+int CatalogSnapshot::count() const {
+    return int(recordCount);
+}
+
+const uchar* CatalogSnapshot::record(int index) const {
+    return data + recordsOffset + quint64(index) * RECORD_SIZE;
+}
+
+QByteArray CatalogSnapshot::poolBytes(const uchar* span) const {
+    quint64 offset = getU32(span);
+    quint64 length = getU32(span + 4);
+    if (offset + length > poolSize) {
+        return QByteArray();
+    }
+    return QByteArray(reinterpret_cast<const char*>(data + poolOffset + offset), int(length));
+}
+
+Product CatalogSnapshot::product(int index) const {
+    Product product;
+    if (!data || index < 0 || index >= count()) {
+        return product;
+    }
+
+    const uchar* r = record(index);
+    product.id = int(getU32(r));
+    product.sellerId = int(getU32(r + 4));
+    product.stock = int(getU32(r + 8));
+    product.hasImageData = (getU32(r + 12) & FLAG_HAS_IMAGE_DATA) != 0;
+    quint64 priceBits = getU64(r + 16);
+    std::memcpy(&product.price, &priceBits, sizeof(product.price));
+    product.name = QString::fromUtf8(poolBytes(r + SPAN_NAME));
+    product.description = QString::fromUtf8(poolBytes(r + SPAN_DESCRIPTION));
+    product.category = QString::fromUtf8(poolBytes(r + SPAN_CATEGORY));
+    product.imageUrl = QString::fromUtf8(poolBytes(r + SPAN_IMAGE_URL));
+    return product;
+}
+
+int CatalogSnapshot::indexOf(int productId) const {
+    if (!data) {
+        return -1;
+    }
+
+    const uchar* entries = data + indexOffset;
+    int low = 0;
+    int high = count() - 1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        int id = int(getU32(entries + mid * INDEX_ENTRY_SIZE));
+        if (id == productId) {
+            quint32 recordIndex = getU32(entries + mid * INDEX_ENTRY_SIZE + 4);
+            return recordIndex < recordCount ? int(recordIndex) : -1;
+        }
+        if (id < productId) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return -1;
+}
+
+QList<Product> CatalogSnapshot::products() const {
+    QList<Product> result;
+    result.reserve(count());
+    for (int i = 0; i < count(); ++i) {
+        result.append(product(i));
+    }
+    return result;
+}
@@ -0,0 +1,57 @@
+#ifndef CATALOGSNAPSHOT_H
+#define CATALOGSNAPSHOT_H
+
+#include "storagebackend.h"
+#include <QFile>
+#include <QList>
+#include <QString>
+
+// Read-only copy of the product catalog in one flat file, laid out as
+//
+//   header | fixed-size product records | id index | string pool
+//
+// Records point into the pool by (offset, length), and the index is sorted by
+// product id. All integers are little-endian. open() maps the file, checks
+// the header and section bounds, and reads records in place without parsing
+// the rest of the file. Image bytes stay in the database: products read back
+// have Product::hasImageData set instead, see StorageBackend::getProductImage.
+class CatalogSnapshot {
+public:
+    CatalogSnapshot();
+    ~CatalogSnapshot();
+
+    // Writes to a temporary file and renames it over path when complete
+    static bool write(const QString& path, qint64 catalogVersion, const QList<Product>& products);
+
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const;
+
+    // Catalog version the file was built from, see StorageBackend::getCatalogVersion
+    qint64 catalogVersion() const;
+    int count() const;
+
+    Product product(int index) const;
+    // Record index for a product id, or -1
+    int indexOf(int productId) const;
+    QList<Product> products() const;
+
+private:
+    CatalogSnapshot(const CatalogSnapshot&) = delete;
+    CatalogSnapshot& operator=(const CatalogSnapshot&) = delete;
+
+    const uchar* record(int index) const;
+    QByteArray poolBytes(const uchar* span) const;
+
+    QFile file;
+    const uchar* data;
+    qint64 size;
+    qint64 version;
+    quint32 recordCount;
+    quint64 recordsOffset;
+    quint64 indexOffset;
+    quint64 poolOffset;
+    quint64 poolSize;
+};
+
+#endif // CATALOGSNAPSHOT_H
@@ -0,0 +1,258 @@
+#include "catalogstore.h"
+#include <QCollator>
+#include <QCollatorSortKey>
+#include <algorithm>
+#include <numeric>
+
+CatalogStore::CatalogStore()
+{
+    nameOffsets.append(0);
+    descriptionOffsets.append(0);
+}
+
+CatalogStore::CatalogStore(const QVector<Product>& products, const QHash<int, RatingSummary>& ratings,
+                           const CatalogStore* previous)
+{
+    int rowCount = products.size();
+    idColumn.reserve(rowCount);
+    priceColumn.reserve(rowCount);
+    stockColumn.reserve(rowCount);
+    categoryColumn.reserve(rowCount);
+    sellerColumn.reserve(rowCount);
+    rowsById.reserve(rowCount);
+    nameOffsets.reserve(rowCount + 1);
+    descriptionOffsets.reserve(rowCount + 1);
+
+    qsizetype nameChars = 0;
+    qsizetype descriptionChars = 0;
+    for (const Product& product : products) {
+        nameChars += product.name.size();
+        descriptionChars += product.description.size();
+    }
+    namePool.reserve(nameChars);
+    descriptionPool.reserve(descriptionChars);
+
+    nameOffsets.append(0);
+    descriptionOffsets.append(0);
+    for (const Product& product : products) {
+        rowsById.insert(product.id, idColumn.size());
+        idColumn.append(product.id);
+        priceColumn.append(product.price);
+        stockColumn.append(product.stock);
+        sellerColumn.append(product.sellerId);
+
+        auto category = categoryIdsByName.constFind(product.category);
+        if (category == categoryIdsByName.constEnd()) {
+            category = categoryIdsByName.insert(product.category, categoryNames.size());
+            categoryNames.append(product.category);
+        }
+        categoryColumn.append(quint16(category.value()));
+
+        namePool.append(product.name);
+        nameOffsets.append(qint32(namePool.size()));
+        descriptionPool.append(product.description);
+        descriptionOffsets.append(qint32(descriptionPool.size()));
+    }
+
+    fillRatings(ratings);
+    buildSortOrders(products);
+    buildTextIndex(previous);
+    facetIndex.build(*this);
+}
+
+int CatalogStore::size() const {
+    return idColumn.size();
+}
+
+const QVector<qint32>& CatalogStore::ids() const {
+    return idColumn;
+}
+
+const QVector<double>& CatalogStore::prices() const {
+    return priceColumn;
+}
+
+const QVector<qint32>& CatalogStore::stock() const {
+    return stockColumn;
+}
+
+const QVector<quint16>& CatalogStore::categoryIds() const {
+    return categoryColumn;
+}
+
+const QVector<float>& CatalogStore::ratings() const {
+    return ratingColumn;
+}
+
+const QVector<qint32>& CatalogStore::sellerIds() const {
+    return sellerColumn;
+}
+
+QStringView CatalogStore::name(int row) const {
+    return QStringView(namePool).mid(nameOffsets.at(row), nameOffsets.at(row + 1) - nameOffsets.at(row));
+}
+
+QStringView CatalogStore::description(int row) const {
+    return QStringView(descriptionPool).mid(descriptionOffsets.at(row),
+                                            descriptionOffsets.at(row + 1) - descriptionOffsets.at(row));
+}
+
+int CatalogStore::rowOf(int productId) const {
+    return rowsById.value(productId, -1);
+}
+
+const QStringList& CatalogStore::categories() const {
+    return categoryNames;
+}
+
+int CatalogStore::categoryId(const QString& category) const {
+    return categoryIdsByName.value(category, -1);
+}
+
+const QVector<int>& CatalogStore::priceOrder() const {
+    return byPrice;
+}
+
+const QVector<int>& CatalogStore::nameOrder() const {
+    return byName;
+}
+
+void CatalogStore::setRatings(const QHash<int, RatingSummary>& summaries) {
+    fillRatings(summaries);
+    facetIndex.rebuildRatings(*this);
+}
+
+const FacetIndex& CatalogStore::facets() const {
+    return facetIndex;
+}
+
+void CatalogStore::fillRatings(const QHash<int, RatingSummary>& summaries) {
+    ratingColumn.fill(0.0f, size());
+    for (int row = 0; row < size(); ++row) {
+        auto summary = summaries.constFind(idColumn.at(row));
+        if (summary != summaries.constEnd()) {
+            ratingColumn[row] = float(summary->average);
+        }
+    }
+}
+
+void CatalogStore::buildSortOrders(const QVector<Product>& products) {
+    byPrice.resize(size());
+    std::iota(byPrice.begin(), byPrice.end(), 0);
+    byName = byPrice;
+
+    const double* price = priceColumn.constData();
+    std::stable_sort(byPrice.begin(), byPrice.end(), [price](int a, int b) {
+        return price[a] < price[b];
+    });
+
+    // Sort keys make each comparison a byte compare instead of a full
+    // collation; numeric mode puts "Size 9" before "Size 10"
+    QCollator collator;
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    collator.setNumericMode(true);
+    QVector<QCollatorSortKey> keys;
+    keys.reserve(products.size());
+    for (const Product& product : products) {
+        keys.append(collator.sortKey(product.name));
+    }
+    std::stable_sort(byName.begin(), byName.end(), [&keys](int a, int b) {
+        return keys.at(a).compare(keys.at(b)) < 0;
+    });
+}
+
+bool CatalogStore::sameText(int row, const CatalogStore& other, int otherRow) const {
+    return name(row) == other.name(otherRow) && description(row) == other.description(otherRow);
+}
+
+void CatalogStore::buildTextIndex(const CatalogStore* previous) {
+    if (!previous) {
+        for (int row = 0; row < size(); ++row) {
+            textIndex.addProduct(idColumn.at(row), name(row), description(row));
+        }
+        return;
+    }
+
+    // Catalog refreshes mostly change stock and prices, so re-index only
+    // products that were added, removed or had their text edited
+    textIndex = previous->textIndex;
+    for (int oldRow = 0; oldRow < previous->size(); ++oldRow) {
+        int row = rowOf(previous->idColumn.at(oldRow));
+        if (row < 0 || !sameText(row, *previous, oldRow)) {
+            textIndex.removeProduct(previous->idColumn.at(oldRow), previous->name(oldRow),
+                                    previous->description(oldRow));
+        }
+    }
+    for (int row = 0; row < size(); ++row) {
+        int oldRow = previous->rowOf(idColumn.at(row));
+        if (oldRow < 0 || !sameText(row, *previous, oldRow)) {
+            textIndex.addProduct(idColumn.at(row), name(row), description(row));
+        }
+    }
+}
+
+bool CatalogStore::textCandidates(const QString& text, SelectionBitmap* rows) const {
+    QVector<int> productIds;
+    if (!textIndex.lookup(text, &productIds)) {
+        return false;
+    }
+    *rows = SelectionBitmap(size());
+    for (int productId : productIds) {
+        int row = rowOf(productId);
+        if (row >= 0) {
+            rows->set(row);
+        }
+    }
+    return true;
+}
+
+SelectionBitmap CatalogStore::all() const {
+    return SelectionBitmap(size(), true);
+}
+
+SelectionBitmap CatalogStore::priceRange(double minPrice, double maxPrice) const {
+    const double* price = priceColumn.constData();
+    return select([price, minPrice, maxPrice](int row) {
+        return (price[row] >= minPrice) & (price[row] <= maxPrice);
+    });
+}
+
+SelectionBitmap CatalogStore::inStock() const {
+    const qint32* stock = stockColumn.constData();
+    return select([stock](int row) {
+        return stock[row] > 0;
+    });
+}
+
+SelectionBitmap CatalogStore::category(int categoryId) const {
+    if (categoryId < 0) {
+        return SelectionBitmap(size());
+    }
+    const quint16* category = categoryColumn.constData();
+    quint16 wanted = quint16(categoryId);
+    return select([category, wanted](int row) {
+        return category[row] == wanted;
+    });
+}
+
+SelectionBitmap CatalogStore::categoryMask(const QVector<int>& categoryIds) const {
+    // Lookup table indexed by category id, so the kernel stays branch-free
+    QVector<quint8> allowed(categoryNames.size(), 0);
+    for (int id : categoryIds) {
+        if (id >= 0 && id < allowed.size()) {
+            allowed[id] = 1;
+        }
+    }
+    const quint16* category = categoryColumn.constData();
+    const quint8* table = allowed.constData();
+    return select([category, table](int row) {
+        return table[category[row]] != 0;
+    });
+}
+
+SelectionBitmap CatalogStore::minimumRating(float rating) const {
+    const float* ratings = ratingColumn.constData();
+    return select([ratings, rating](int row) {
+        return ratings[row] >= rating;
+    });
+}
@@ -0,0 +1,115 @@
+#ifndef CATALOGSTORE_H
+#define CATALOGSTORE_H
+
+#include "storagebackend.h"
+#include "trigramindex.h"
+#include "selectionbitmap.h"
+#include "facetindex.h"
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+
+// The catalog stored column by column: ids, prices, stock, category ids,
+// ratings and seller ids each sit in their own contiguous array, names and
+// descriptions are packed into one string each with offsets, and category
+// names are interned. Filters run a branch-free predicate over one column
+// and fill a SelectionBitmap 64 rows per word, a loop the compiler can
+// vectorize. Combine filters with &= and |=.
+//
+// The store also keeps the price and name sort permutations, a trigram index
+// over names and descriptions and the facet bitmaps, so it is built once per
+// catalog and shared read-only between threads. Given the store of the previous catalog,
+// the trigram index is carried over and only changed products are re-indexed.
+class CatalogStore {
+public:
+    CatalogStore();
+    CatalogStore(const QVector<Product>& products, const QHash<int, RatingSummary>& ratings,
+                 const CatalogStore* previous = nullptr);
+
+    int size() const;
+
+    const QVector<qint32>& ids() const;
+    const QVector<double>& prices() const;
+    const QVector<qint32>& stock() const;
+    const QVector<quint16>& categoryIds() const;
+    const QVector<float>& ratings() const;
+    const QVector<qint32>& sellerIds() const;
+
+    QStringView name(int row) const;
+    QStringView description(int row) const;
+    // -1 if the product is not in the catalog
+    int rowOf(int productId) const;
+
+    const QStringList& categories() const;
+    // -1 if no product has this category
+    int categoryId(const QString& category) const;
+
+    // Rows by ascending price and by locale-aware name
+    const QVector<int>& priceOrder() const;
+    const QVector<int>& nameOrder() const;
+
+    // Also rebuilds the rating facet
+    void setRatings(const QHash<int, RatingSummary>& summaries);
+
+    const FacetIndex& facets() const;
+
+    SelectionBitmap all() const;
+    SelectionBitmap priceRange(double minPrice, double maxPrice) const;
+    SelectionBitmap inStock() const;
+    SelectionBitmap category(int categoryId) const;
+    SelectionBitmap categoryMask(const QVector<int>& categoryIds) const;
+    SelectionBitmap minimumRating(float rating) const;
+    // Rows that may contain text, see TrigramIndex::lookup; false if the
+    // index cannot narrow the query and every row must be checked
+    bool textCandidates(const QString& text, SelectionBitmap* rows) const;
+
+private:
+    template <typename Predicate>
+    SelectionBitmap select(Predicate predicate) const;
+
+    void fillRatings(const QHash<int, RatingSummary>& summaries);
+    void buildSortOrders(const QVector<Product>& products);
+    void buildTextIndex(const CatalogStore* previous);
+    bool sameText(int row, const CatalogStore& other, int otherRow) const;
+
+    QVector<qint32> idColumn;
+    QVector<double> priceColumn;
+    QVector<qint32> stockColumn;
+    QVector<quint16> categoryColumn;
+    QVector<float> ratingColumn;
+    QVector<qint32> sellerColumn;
+
+    QString namePool;
+    QVector<qint32> nameOffsets;         // size() + 1 entries
+    QString descriptionPool;
+    QVector<qint32> descriptionOffsets;  // size() + 1 entries
+
+    QStringList categoryNames;
+    QHash<QString, int> categoryIdsByName;
+    QHash<int, int> rowsById;
+    TrigramIndex textIndex;
+    FacetIndex facetIndex;
+
+    QVector<int> byPrice;
+    QVector<int> byName;
+};
+
+template <typename Predicate>
+SelectionBitmap CatalogStore::select(Predicate predicate) const {
+    int rowCount = size();
+    SelectionBitmap result(rowCount);
+    quint64* words = result.data();
+    for (int base = 0; base < rowCount; base += 64) {
+        int width = qMin(64, rowCount - base);
+        quint64 bits = 0;
+        for (int bit = 0; bit < width; ++bit) {
+            bits |= quint64(predicate(base + bit)) << bit;
+        }
+        words[base >> 6] = bits;
+    }
+    return result;
+}
+
+#endif // CATALOGSTORE_H
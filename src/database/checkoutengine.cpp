@@ -0,0 +1,319 @@
+#include "checkoutengine.h"
+#include "databasemanager.h"
+#include "salesrollup.h"
+#include <QtSql/QSqlQuery>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QRandomGenerator>
+#include <QThread>
+#include <QDebug>
+
+namespace {
+// Primary SQLite result codes reported by the QSQLITE driver
+const int SQLITE_BUSY_CODE = 5;
+const int SQLITE_LOCKED_CODE = 6;
+}
+
+CheckoutEngine::CheckoutEngine()
+    : result(Committed)
+    , nextConnectionId(0)
+{
+    workers.setMaxThreadCount(1);
+}
+
+void CheckoutEngine::setDatabase(const QSqlDatabase& database) {
+    QMutexLocker locker(&mutex);
+    db = database;
+    databasePath = database.databaseName();
+}
+
+void CheckoutEngine::setConfig(const CheckoutConfig& newConfig) {
+    {
+        QMutexLocker locker(&mutex);
+        config = newConfig;
+    }
+    if (db.isOpen()) {
+        applyBusyTimeout();
+    }
+}
+
+CheckoutConfig CheckoutEngine::getConfig() const {
+    QMutexLocker locker(&mutex);
+    return config;
+}
+
+bool CheckoutEngine::applyBusyTimeout() {
+    // The GUI connection's other writes (cart, reviews) wait on the same lock
+    QSqlQuery query(db);
+    if (!query.exec(QString("PRAGMA busy_timeout = %1").arg(getConfig().busyTimeoutMs))) {
+        qDebug() << "Error setting busy timeout:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+CheckoutEngine::Result CheckoutEngine::lastResult() const {
+    QMutexLocker locker(&mutex);
+    return result;
+}
+
+CheckoutStats CheckoutEngine::getStats() const {
+    QMutexLocker locker(&mutex);
+    return stats;
+}
+
+void CheckoutEngine::resetStats() {
+    QMutexLocker locker(&mutex);
+    stats = CheckoutStats();
+}
+
+bool CheckoutEngine::isBusyError(const QSqlError& error) {
+    bool ok = false;
+    int code = error.nativeErrorCode().toInt(&ok) & 0xff;
+    if (ok && (code == SQLITE_BUSY_CODE || code == SQLITE_LOCKED_CODE)) {
+        return true;
+    }
+    return error.databaseText().contains("database is locked", Qt::CaseInsensitive)
+        || error.databaseText().contains("database table is locked", Qt::CaseInsensitive);
+}
+
+QFuture<int> CheckoutEngine::placeOrder(int userId, const QList<CartItem>& items) {
+    return QtConcurrent::run(&workers, [this, userId, items]() {
+        return runOrder(userId, items);
+    });
+}
+
+int CheckoutEngine::runOrder(int userId, const QList<CartItem>& items) {
+    CheckoutConfig current;
+    QString path;
+    {
+        QMutexLocker locker(&mutex);
+        stats.checkouts++;
+        current = config;
+        path = databasePath;
+    }
+    qDebug() << "Creating order for user ID:" << userId << "with" << items.size() << "items";
+
+    // QSqlDatabase connections belong to the thread that opens them, so each
+    // checkout opens its own on the worker; SQLite makes that cheap.
+    QString connectionName = QString("marketplace_checkout_%1").arg(nextConnectionId.fetchAndAddRelaxed(1));
+    int orderId = -1;
+    Result outcome = Failed;
+    {
+        QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        connection.setDatabaseName(path);
+        connection.setConnectOptions(QString("QSQLITE_BUSY_TIMEOUT=%1").arg(current.busyTimeoutMs));
+        if (!connection.open()) {
+            qDebug() << "Error opening checkout connection:" << connection.lastError().text();
+        } else {
+            for (int attempt = 1; attempt <= current.maxAttempts; ++attempt) {
+                outcome = attemptOrder(connection, userId, items, orderId);
+                if (outcome != Contended) {
+                    break;
+                }
+                if (attempt < current.maxAttempts) {
+                    {
+                        QMutexLocker locker(&mutex);
+                        stats.retries++;
+                    }
+                    qDebug() << "Checkout contended, retrying - attempt" << attempt << "of" << current.maxAttempts;
+                    backoff(attempt);
+                }
+            }
+            connection.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    QMutexLocker locker(&mutex);
+    result = outcome;
+    switch (outcome) {
+    case Committed:
+        stats.committed++;
+        qDebug() << "Successfully created order" << orderId << "and cleared cart";
+        return orderId;
+    case InsufficientStock:
+        stats.stockFailures++;
+        break;
+    case Contended:
+        qDebug() << "Checkout gave up after" << current.maxAttempts << "contended attempts";
+        break;
+    default:
+        break;
+    }
+
+    qDebug() << "Checkout stats - retries:" << stats.retries
+             << "busy errors:" << stats.busyErrors
+             << "lock wait ms:" << stats.lockWaitMs;
+    return -1;
+}
+
+CheckoutEngine::Result CheckoutEngine::attemptOrder(QSqlDatabase& connection, int userId,
+                                                    const QList<CartItem>& items, int& orderId) {
+    QSqlError error;
+    QElapsedTimer lockTimer;
+    lockTimer.start();
+    bool locked = beginImmediate(connection, error);
+    recordLockWait(lockTimer.elapsed());
+
+    if (!locked) {
+        if (isBusyError(error)) {
+            QMutexLocker locker(&mutex);
+            stats.busyErrors++;
+            return Contended;
+        }
+        qDebug() << "Failed to begin checkout transaction:" << error.text();
+        return Failed;
+    }
+
+    Result outcome = writeOrder(connection, userId, items, orderId);
+    if (outcome != Committed) {
+        rollback(connection);
+        return outcome;
+    }
+
+    QSqlQuery commit(connection);
+    if (!commit.exec("COMMIT")) {
+        qDebug() << "Failed to commit transaction:" << commit.lastError().text();
+        bool busy = isBusyError(commit.lastError());
+        rollback(connection);
+        if (busy) {
+            QMutexLocker locker(&mutex);
+            stats.busyErrors++;
+            return Contended;
+        }
+        return Failed;
+    }
+    return Committed;
+}
+
+CheckoutEngine::Result CheckoutEngine::writeOrder(QSqlDatabase& connection, int userId,
+                                                  const QList<CartItem>& items, int& orderId) {
+    double totalAmount = 0;
+    for (const CartItem& item : items) {
+        totalAmount += item.price * item.quantity;
+    }
+
+    QSqlQuery query(connection);
+    query.prepare("INSERT INTO orders (user_id, order_date, status, total_amount) "
+                  "VALUES (?, ?, ?, ?)");
+    query.addBindValue(userId);
+    query.addBindValue(QDateTime::currentMSecsSinceEpoch());
+    query.addBindValue("Pending");
+    query.addBindValue(totalAmount);
+
+    if (!query.exec()) {
+        qDebug() << "Failed to create order: Database error:" << query.lastError().text();
+        return isBusyError(query.lastError()) ? Contended : Failed;
+    }
+    orderId = query.lastInsertId().toInt();
+
+    QSqlQuery productQuery(connection);
+    productQuery.prepare("SELECT name, seller_id, category FROM products WHERE id = ?");
+    QSqlQuery stockQuery(connection);
+    stockQuery.prepare("UPDATE products SET stock = stock - ? WHERE id = ? AND stock >= ?");
+    QSqlQuery itemQuery(connection);
+    itemQuery.prepare("INSERT INTO order_items "
+                      "(order_id, product_id, product_name, seller_id, category, quantity, price) "
+                      "VALUES (?, ?, ?, ?, ?, ?, ?)");
+
+    for (const CartItem& item : items) {
+        productQuery.addBindValue(item.productId);
+        if (!productQuery.exec()) {
+            qDebug() << "Failed to read product:" << productQuery.lastError().text();
+            return isBusyError(productQuery.lastError()) ? Contended : Failed;
+        }
+        if (!productQuery.next()) {
+            qDebug() << "Failed to find product with ID:" << item.productId;
+            return ProductNotFound;
+        }
+        // Kept on the item like the name, so reports do not depend on the product later
+        QString productName = productQuery.value(0).toString();
+        QVariant sellerId = productQuery.value(1);
+        QVariant category = productQuery.value(2);
+        productQuery.finish();
+
+        // The stock guard lives in the WHERE clause, so an unmatched row means
+        // another checkout took the last units first.
+        stockQuery.addBindValue(item.quantity);
+        stockQuery.addBindValue(item.productId);
+        stockQuery.addBindValue(item.quantity);
+        if (!stockQuery.exec()) {
+            qDebug() << "Failed to decrement stock:" << stockQuery.lastError().text();
+            return isBusyError(stockQuery.lastError()) ? Contended : Failed;
+        }
+        if (stockQuery.numRowsAffected() != 1) {
+            qDebug() << "Insufficient stock for product:" << item.productId
+                     << "Requested:" << item.quantity;
+            return InsufficientStock;
+        }
+
+        itemQuery.addBindValue(orderId);
+        itemQuery.addBindValue(item.productId);
+        itemQuery.addBindValue(productName);
+        itemQuery.addBindValue(sellerId);
+        itemQuery.addBindValue(category);
+        itemQuery.addBindValue(item.quantity);
+        itemQuery.addBindValue(item.price);
+        if (!itemQuery.exec()) {
+            qDebug() << "Failed to add order item: Database error:" << itemQuery.lastError().text();
+            return isBusyError(itemQuery.lastError()) ? Contended : Failed;
+        }
+    }
+
+    // Keep the time-bucketed sales rollups in step with the order
+    if (!SalesRollup::applyOrder(connection, orderId, 1)) {
+        return Failed;
+    }
+
+    query.prepare("DELETE FROM cart WHERE user_id = ?");
+    query.addBindValue(userId);
+    if (!query.exec()) {
+        qDebug() << "Failed to clear cart: Database error:" << query.lastError().text();
+        return isBusyError(query.lastError()) ? Contended : Failed;
+    }
+
+    qDebug() << "Created order with ID:" << orderId << "Total amount:" << totalAmount;
+    return Committed;
+}
+
+bool CheckoutEngine::beginImmediate(QSqlDatabase& connection, QSqlError& error) {
+    // IMMEDIATE takes the RESERVED lock up front; a deferred transaction would
+    // only ask for it at the first write and could then fail mid-checkout.
+    QSqlQuery query(connection);
+    if (!query.exec("BEGIN IMMEDIATE")) {
+        error = query.lastError();
+        return false;
+    }
+    return true;
+}
+
+void CheckoutEngine::rollback(QSqlDatabase& connection) {
+    QSqlQuery query(connection);
+    if (!query.exec("ROLLBACK")) {
+        qDebug() << "Rollback failed:" << query.lastError().text();
+    }
+}
+
+void CheckoutEngine::backoff(int attempt) {
+    CheckoutConfig current = getConfig();
+    int ceiling = current.baseBackoffMs << qMin(attempt - 1, 16);
+    ceiling = qBound(1, ceiling, current.maxBackoffMs);
+    // Equal jitter: keep half the delay, randomize the other half so competing
+    // instances do not wake up in lockstep.
+    int delay = ceiling / 2 + QRandomGenerator::global()->bounded(ceiling / 2 + 1);
+
+    // Only ever called on the checkout worker, never the GUI thread
+    QElapsedTimer timer;
+    timer.start();
+    QThread::msleep(delay);
+    recordLockWait(timer.elapsed());
+}
+
+void CheckoutEngine::recordLockWait(qint64 elapsedMs) {
+    QMutexLocker locker(&mutex);
+    stats.lockWaitMs += elapsedMs;
+    stats.maxLockWaitMs = qMax(stats.maxLockWaitMs, elapsedMs);
+}
@@ -0,0 +1,90 @@
+#ifndef CHECKOUTENGINE_H
+#define CHECKOUTENGINE_H
+
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+#include <QFuture>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <QAtomicInt>
+
+struct CartItem;
+
+struct CheckoutConfig {
+    int busyTimeoutMs;   // How long SQLite itself waits on a locked database per statement
+    int maxAttempts;     // Attempts before a contended checkout is reported as failed
+    int baseBackoffMs;   // First retry delay, doubled on every further retry
+    int maxBackoffMs;    // Cap for a single retry delay
+
+    CheckoutConfig() : busyTimeoutMs(2000), maxAttempts(6), baseBackoffMs(10), maxBackoffMs(400) {}
+};
+
+struct CheckoutStats {
+    qint64 checkouts;      // placeOrder() calls
+    qint64 committed;      // Orders that were committed
+    qint64 retries;        // Attempts repeated because the database was busy
+    qint64 busyErrors;     // SQLITE_BUSY / SQLITE_LOCKED errors seen
+    qint64 stockFailures;  // Checkouts rejected because stock ran out
+    qint64 lockWaitMs;     // Time spent acquiring the write lock, including backoff
+    qint64 maxLockWaitMs;  // Longest single lock acquisition
+
+    CheckoutStats()
+        : checkouts(0), committed(0), retries(0), busyErrors(0)
+        , stockFailures(0), lockWaitMs(0), maxLockWaitMs(0) {}
+};
+
+// Places orders inside BEGIN IMMEDIATE transactions so the write lock is taken
+// before anything is read, and retries with jittered exponential backoff when
+// another connection (or another app instance) holds the database.
+// Checkouts run on a worker thread with a connection of their own, so neither
+// busy_timeout nor the backoff ever blocks the GUI thread.
+class CheckoutEngine {
+public:
+    enum Result {
+        Committed,
+        InsufficientStock,
+        ProductNotFound,
+        Contended,
+        Failed
+    };
+
+    CheckoutEngine();
+
+    void setDatabase(const QSqlDatabase& database);
+    void setConfig(const CheckoutConfig& config);
+    CheckoutConfig getConfig() const;
+    bool applyBusyTimeout();
+
+    // Resolves to the new order id, or -1 when the order could not be placed
+    QFuture<int> placeOrder(int userId, const QList<CartItem>& items);
+
+    Result lastResult() const;
+    CheckoutStats getStats() const;
+    void resetStats();
+
+    static bool isBusyError(const QSqlError& error);
+
+private:
+    int runOrder(int userId, const QList<CartItem>& items);
+    Result attemptOrder(QSqlDatabase& connection, int userId, const QList<CartItem>& items, int& orderId);
+    Result writeOrder(QSqlDatabase& connection, int userId, const QList<CartItem>& items, int& orderId);
+    bool beginImmediate(QSqlDatabase& connection, QSqlError& error);
+    void rollback(QSqlDatabase& connection);
+    void backoff(int attempt);
+    void recordLockWait(qint64 elapsedMs);
+
+    QSqlDatabase db;
+    QString databasePath;
+    CheckoutConfig config;
+    CheckoutStats stats;
+    Result result;
+    // Guards config, stats and result, which the worker updates
+    mutable QMutex mutex;
+    // One worker: concurrent checkouts would only queue on the write lock
+    QThreadPool workers;
+    QAtomicInt nextConnectionId;
+};
+
+#endif // CHECKOUTENGINE_H
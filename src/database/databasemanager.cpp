@@ -2,11 +2,73 @@
 #include <QDebug>
 #include <QDir>
 #include <QCryptographicHash>
+#include <QThread>
+
+namespace {
+// Timestamps are INTEGER milliseconds since the Unix epoch so range filters
+// and sorts compare integers and use the indexes directly.
+QString ordersSchema(const QString& table) {
+    return QString(
+        "CREATE TABLE IF NOT EXISTS %1 ("
+        "    id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "    user_id INTEGER NOT NULL,"
+        "    order_date INTEGER NOT NULL,"
+        "    status TEXT NOT NULL,"
+        "    total_amount REAL NOT NULL,"
+        "    FOREIGN KEY (user_id) REFERENCES users(id)"
+        ")").arg(table);
+}
+
+QString reviewsSchema(const QString& table) {
+    return QString(
+        "CREATE TABLE IF NOT EXISTS %1 ("
+        "    id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "    product_id INTEGER NOT NULL,"
+        "    user_id INTEGER NOT NULL,"
+        "    username TEXT,"
+        "    rating INTEGER NOT NULL,"
+        "    comment TEXT,"
+        "    review_date INTEGER NOT NULL,"
+        "    FOREIGN KEY (product_id) REFERENCES products(id),"
+        "    FOREIGN KEY (user_id) REFERENCES users(id)"
+        ")").arg(table);
+}
+
+// Columns of a cart row joined with its product, read by cartLineFromQuery.
+// image_data is only tested, never read.
+const char* const CART_LINE_COLUMNS =
+    "c.id, c.product_id, c.quantity, c.price, "
+    "p.id IS NULL AS missing, p.name, p.price AS current_price, p.stock, p.image_url, "
+    "p.image_data IS NOT NULL AS has_image";
+
+CartLine cartLineFromQuery(const QSqlQuery& query) {
+    CartLine line;
+    line.cartItemId = query.value(0).toInt();
+    line.productId = query.value(1).toInt();
+    line.quantity = query.value(2).toInt();
+    line.price = query.value(3).toDouble();
+    line.productMissing = query.value(4).toBool();
+    line.productName = query.value(5).toString();
+    line.currentPrice = query.value(6).toDouble();
+    line.stock = query.value(7).toInt();
+    line.imageUrl = query.value(8).toString();
+    line.hasImageData = query.value(9).toBool();
+    return line;
+}
+}
 
 DatabaseManager::DatabaseManager() {
     db = QSqlDatabase::addDatabase("QSQLITE");
     QString dbPath = QDir::currentPath() + "/marketplace.db";
     db.setDatabaseName(dbPath);
+    
+    ArchiveConfig archiveConfig;
+    archiveConfig.archivePath = QDir::currentPath() + "/marketplace_archive.db";
+    orderArchiver.setConfig(archiveConfig);
+    
+    BackupConfig backupConfig;
+    backupConfig.backupDir = QDir::currentPath() + "/backups";
+    backupService.setConfig(backupConfig);
 }
 
 DatabaseManager::~DatabaseManager() {
@@ -21,12 +83,89 @@ DatabaseManager& DatabaseManager::getInstance() {
 }
 
 bool DatabaseManager::initialize() {
+    if (db.isOpen()) {
+        return true;
+    }
     if (!db.open()) {
         qDebug() << "Error opening database:" << db.lastError().text();
         return false;
     }
     qDebug() << "Database opened successfully at:" << db.databaseName();
-    return createTables();
+    checkoutEngine.setDatabase(db);
+    checkoutEngine.applyBusyTimeout();
+    configureJournal();
+    if (!createTables()) {
+        return false;
+    }
+    
+    // Old finished orders live in a separate file; all_orders spans both
+    orderArchiver.setDatabase(db);
+    orderArchiver.attach();
+    if (SalesRollup::needsBackfill(db)) {
+        backfillSalesRollups();
+    }
+    
+    // Reports read through their own connections so they never hold up checkout
+    readPool.setConnectionSetup(orderArchiver.connectionSetup());
+    readPool.configure(db.databaseName(), qBound(2, QThread::idealThreadCount(), 4),
+                       checkoutEngine.getConfig().busyTimeoutMs);
+    
+    // Archival batches, ANALYZE, vacuum and checkpoints run when the UI is idle
+    maintenanceScheduler.setDatabase(db);
+    maintenanceScheduler.setArchiver(&orderArchiver);
+    if (maintenanceScheduler.createLogTable()) {
+        maintenanceScheduler.start();
+    }
+    
+    backupService.setDatabasePath(db.databaseName());
+    if (orderArchiver.isAttached()) {
+        backupService.setArchivePath(orderArchiver.getConfig().archivePath);
+    }
+    backupService.start();
+    return true;
+}
+
+bool DatabaseManager::configureJournal() {
+    // WAL lets readers keep a consistent snapshot while the writer commits
+    QSqlQuery query;
+    // Only takes effect on a new file. Converting an existing one needs a full
+    // VACUUM, which rewrites the file under an exclusive lock, so it is never
+    // done automatically; incremental_vacuum is a no-op on such files.
+    if (!query.exec("PRAGMA auto_vacuum = INCREMENTAL")) {
+        qDebug() << "Error setting auto_vacuum:" << query.lastError().text();
+    }
+    
+    if (!query.exec("PRAGMA journal_mode = WAL") || !query.next()) {
+        qDebug() << "Error enabling WAL mode:" << query.lastError().text();
+        return false;
+    }
+    QString mode = query.value(0).toString();
+    if (mode.compare("wal", Qt::CaseInsensitive) != 0) {
+        qDebug() << "WAL mode not available, journal mode is:" << mode;
+        return false;
+    }
+    
+    // NORMAL is durable in WAL mode except for the last commits on power loss
+    if (!query.exec("PRAGMA synchronous = NORMAL")) {
+        qDebug() << "Error setting synchronous mode:" << query.lastError().text();
+    }
+    return true;
+}
+
+ReadConnectionPool& DatabaseManager::getReadPool() {
+    return readPool;
+}
+
+OrderArchiver& DatabaseManager::getOrderArchiver() {
+    return orderArchiver;
+}
+
+BackupService& DatabaseManager::getBackupService() {
+    return backupService;
+}
+
+MaintenanceScheduler& DatabaseManager::getMaintenanceScheduler() {
+    return maintenanceScheduler;
 }
 
 bool DatabaseManager::createTables() {
@@ -34,8 +173,17 @@ bool DatabaseManager::createTables() {
     success &= createUsersTable();
     success &= createProductsTable();
     success &= createOrdersTable();
+    success &= createOrderItemsTable();
     success &= createCartTable();
     success &= createSellerTable();
+    success &= createSessionsTable();
+    success &= createReviewsTable();
+    success &= migrateTimestamps();
+    success &= createIndexes();
+    success &= createCatalogMeta();
+    success &= createCartVersions();
+    success &= SalesRollup::createTables(db);
+    success &= SalesRollup::migrateOrderItems(db, "main");
     return success;
 }
 
@@ -119,19 +267,179 @@ bool DatabaseManager::createProductsTable() {
 }
 
 bool DatabaseManager::createOrdersTable() {
+    QSqlQuery query;
+    return query.exec(ordersSchema("orders"));
+}
+
+bool DatabaseManager::createReviewsTable() {
+    QSqlQuery query;
+    return query.exec(reviewsSchema("reviews"));
+}
+
+bool DatabaseManager::migrateTimestamps() {
+    return migrateToEpochMillis("orders", "order_date", ordersSchema("orders_migrated"),
+                                "id, user_id, order_date, status, total_amount")
+        && migrateToEpochMillis("reviews", "review_date", reviewsSchema("reviews_migrated"),
+                                "id, product_id, user_id, username, rating, comment, review_date");
+}
+
+bool DatabaseManager::migrateToEpochMillis(const QString& table, const QString& dateColumn,
+                                           const QString& schema, const QString& columns) {
+    QSqlQuery query;
+    if (!query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+        qDebug() << "Error reading" << table << "schema:" << query.lastError().text();
+        return false;
+    }
+    
+    bool needsMigration = false;
+    while (query.next()) {
+        if (query.value("name").toString() == dateColumn) {
+            needsMigration = query.value("type").toString().compare("INTEGER", Qt::CaseInsensitive) != 0;
+        }
+    }
+    query.finish();
+    if (!needsMigration) {
+        return true;
+    }
+    
+    qDebug() << "Migrating" << table << "." << dateColumn << "to epoch milliseconds";
+    
+    // Old rows hold QDateTime text in local time; already-numeric values are
+    // kept as they are.
+    QString converted = QString(
+        "CASE WHEN typeof(%1) IN ('integer', 'real') THEN CAST(%1 AS INTEGER) "
+        "ELSE COALESCE(CAST(ROUND((julianday(%1, 'utc') - 2440587.5) * 86400000) AS INTEGER), 0) END")
+        .arg(dateColumn);
+    QString selectColumns = QString(columns).replace(dateColumn, converted);
+    QString migrated = table + "_migrated";
+    
+    // SQLite cannot change a column type in place, so rebuild the table
+    bool ok = query.exec("BEGIN IMMEDIATE")
+        && query.exec(QString("DROP TABLE IF EXISTS %1").arg(migrated))
+        && query.exec(schema)
+        && query.exec(QString("INSERT INTO %1 (%2) SELECT %3 FROM %4")
+                      .arg(migrated, columns, selectColumns, table))
+        && query.exec(QString("DROP TABLE %1").arg(table))
+        && query.exec(QString("ALTER TABLE %1 RENAME TO %2").arg(migrated, table))
+        && query.exec("COMMIT");
+    if (!ok) {
+        qDebug() << "Error migrating" << table << ":" << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::createOrderItemsTable() {
     QSqlQuery query;
     return query.exec(
-        "CREATE TABLE IF NOT EXISTS orders ("
+        "CREATE TABLE IF NOT EXISTS order_items ("
         "    id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "    user_id INTEGER NOT NULL,"
-        "    order_date DATETIME NOT NULL,"
-        "    status TEXT NOT NULL,"
-        "    total_amount REAL NOT NULL,"
-        "    FOREIGN KEY (user_id) REFERENCES users(id)"
+        "    order_id INTEGER NOT NULL,"
+        "    product_id INTEGER NOT NULL,"
+        "    product_name TEXT,"
+        "    seller_id INTEGER,"
+        "    category TEXT,"
+        "    quantity INTEGER NOT NULL,"
+        "    price REAL NOT NULL,"
+        "    FOREIGN KEY (order_id) REFERENCES orders(id),"
+        "    FOREIGN KEY (product_id) REFERENCES products(id)"
         ")"
     );
 }
 
+bool DatabaseManager::createIndexes() {
+    // Seller pages go products -> order_items -> orders; without these every
+    // step is a full table scan.
+    const char* statements[] = {
+        "CREATE INDEX IF NOT EXISTS idx_products_seller ON products (seller_id)",
+        "CREATE INDEX IF NOT EXISTS idx_order_items_product ON order_items (product_id)",
+        "CREATE INDEX IF NOT EXISTS idx_order_items_order ON order_items (order_id)",
+        "CREATE INDEX IF NOT EXISTS idx_cart_user ON cart (user_id)",
+        // Order history filters and sorts by date within one user
+        "CREATE INDEX IF NOT EXISTS idx_orders_user_date ON orders (user_id, order_date)",
+        // Lets the archiver find finished orders without scanning
+        "CREATE INDEX IF NOT EXISTS idx_orders_status_date ON orders (status, order_date)",
+        "CREATE INDEX IF NOT EXISTS idx_reviews_product_date ON reviews (product_id, review_date)"
+    };
+    
+    QSqlQuery query;
+    for (const char* statement : statements) {
+        if (!query.exec(statement)) {
+            qDebug() << "Error creating index:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DatabaseManager::createCatalogMeta() {
+    // One row holding a counter that every catalog edit bumps, so the
+    // catalog snapshot file can tell whether it is still current. Stock is
+    // left out: checkouts change it constantly and the snapshot would be
+    // rebuilt after every purchase; the checkout re-checks stock anyway.
+    const char* statements[] = {
+        "CREATE TABLE IF NOT EXISTS catalog_meta ("
+        "    id INTEGER PRIMARY KEY CHECK (id = 1),"
+        "    version INTEGER NOT NULL"
+        ")",
+        "INSERT OR IGNORE INTO catalog_meta (id, version) VALUES (1, 1)",
+        "CREATE TRIGGER IF NOT EXISTS trg_products_insert_version AFTER INSERT ON products "
+        "BEGIN UPDATE catalog_meta SET version = version + 1 WHERE id = 1; END",
+        // Replaced by trg_products_edit_version, which ignores stock updates
+        "DROP TRIGGER IF EXISTS trg_products_update_version",
+        "CREATE TRIGGER IF NOT EXISTS trg_products_edit_version "
+        "AFTER UPDATE OF name, description, price, category, image_data, image_url, seller_id ON products "
+        "BEGIN UPDATE catalog_meta SET version = version + 1 WHERE id = 1; END",
+        "CREATE TRIGGER IF NOT EXISTS trg_products_delete_version AFTER DELETE ON products "
+        "BEGIN UPDATE catalog_meta SET version = version + 1 WHERE id = 1; END"
+    };
+    
+    QSqlQuery query;
+    for (const char* statement : statements) {
+        if (!query.exec(statement)) {
+            qDebug() << "Error creating catalog_meta:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DatabaseManager::createCartVersions() {
+    // A counter per user that every cart row write bumps, so an in-memory
+    // cart can tell whether it still matches the table without re-reading it
+    const char* statements[] = {
+        "CREATE TABLE IF NOT EXISTS cart_versions ("
+        "    user_id INTEGER PRIMARY KEY,"
+        "    version INTEGER NOT NULL"
+        ")",
+        "CREATE TRIGGER IF NOT EXISTS trg_cart_insert_version AFTER INSERT ON cart "
+        "BEGIN "
+        "INSERT OR IGNORE INTO cart_versions (user_id, version) VALUES (NEW.user_id, 0); "
+        "UPDATE cart_versions SET version = version + 1 WHERE user_id = NEW.user_id; "
+        "END",
+        "CREATE TRIGGER IF NOT EXISTS trg_cart_update_version AFTER UPDATE ON cart "
+        "BEGIN "
+        "INSERT OR IGNORE INTO cart_versions (user_id, version) VALUES (NEW.user_id, 0); "
+        "UPDATE cart_versions SET version = version + 1 WHERE user_id IN (OLD.user_id, NEW.user_id); "
+        "END",
+        "CREATE TRIGGER IF NOT EXISTS trg_cart_delete_version AFTER DELETE ON cart "
+        "BEGIN "
+        "INSERT OR IGNORE INTO cart_versions (user_id, version) VALUES (OLD.user_id, 0); "
+        "UPDATE cart_versions SET version = version + 1 WHERE user_id = OLD.user_id; "
+        "END"
+    };
+    
+    QSqlQuery query;
+    for (const char* statement : statements) {
+        if (!query.exec(statement)) {
+            qDebug() << "Error creating cart_versions:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
 bool DatabaseManager::createCartTable() {
     QSqlQuery query;
     return query.exec(
@@ -160,6 +468,29 @@ bool DatabaseManager::createSellerTable() {
     );
 }
 
+bool DatabaseManager::createSessionsTable() {
+    QSqlQuery query;
+    // Keyed by the SHA-256 of the token, never the token itself; the expiry
+    // index keeps the purge from scanning the table
+    if (!query.exec(
+        "CREATE TABLE IF NOT EXISTS sessions ("
+        "    token_hash BLOB PRIMARY KEY,"
+        "    user_id TEXT NOT NULL,"
+        "    expires_at INTEGER NOT NULL"
+        ") WITHOUT ROWID")) {
+        qDebug() << "Error creating sessions table:" << query.lastError().text();
+        return false;
+    }
+    if (!migrateSessionTokens()) {
+        return false;
+    }
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_sessions_expires ON sessions (expires_at)")) {
+        qDebug() << "Error creating sessions index:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
 bool DatabaseManager::addUser(const User& user) {
     QSqlQuery query;
     query.prepare("INSERT INTO users (email, username, password, is_admin, is_suspended) VALUES (?, ?, ?, ?, ?)");
@@ -214,7 +545,13 @@ bool DatabaseManager::decrementProductStock(int productId, int quantity) {
     query.addBindValue(quantity);
     query.addBindValue(productId);
     query.addBindValue(quantity);
-    return query.exec();
+    
+    // A guarded UPDATE that matched no row did not take any stock
+    if (!query.exec()) {
+        qDebug() << "Error decrementing stock:" << query.lastError().text();
+        return false;
+    }
+    return query.numRowsAffected() == 1;
 }
 
 Product DatabaseManager::getProductById(int productId) {
@@ -249,7 +586,112 @@ Product DatabaseManager::getProductById(int productId) {
 
 QList<Product> DatabaseManager::getAllProducts() {
     QList<Product> products;
-    QSqlQuery query("SELECT id, name, description, price, seller_id, category, image_data, image_url, stock FROM products");
+    // Pooled so the catalog snapshot can be rebuilt from a worker thread
+    ReadSnapshot snapshot(readPool);
+    QSqlDatabase readDb = readDatabase(snapshot);
+    if (!readDb.isValid()) {
+        qDebug() << "Error fetching products: no read connection on this thread";
+        return products;
+    }
+    QSqlQuery query(readDb);
+    // Image bytes stay in the table; views fetch them through getProductImage
+    if (!query.exec("SELECT id, name, description, price, seller_id, category, "
+                    "image_data IS NOT NULL AS has_image, image_url, stock FROM products")) {
+        qDebug() << "Error fetching products:" << query.lastError().text();
+        return products;
+    }
+    
+    while (query.next()) {
+        Product product;
+        product.id = query.value("id").toInt();
+        product.name = query.value("name").toString();
+        product.description = query.value("description").toString();
+        product.price = query.value("price").toDouble();
+        product.sellerId = query.value("seller_id").toInt();
+        product.category = query.value("category").toString();
+        product.hasImageData = query.value("has_image").toBool();
+        product.imageUrl = query.value("image_url").toString();
+        product.stock = query.value("stock").toInt();
+        products.append(product);
+    }
+    
+    return products;
+}
+
+qint64 DatabaseManager::getCatalogVersion() {
+    ReadSnapshot snapshot(readPool);
+    QSqlDatabase readDb = readDatabase(snapshot);
+    if (!readDb.isValid()) {
+        qDebug() << "Error reading catalog version: no read connection on this thread";
+        return -1;
+    }
+    QSqlQuery query(readDb);
+    if (!query.exec("SELECT version FROM catalog_meta WHERE id = 1") || !query.next()) {
+        qDebug() << "Error reading catalog version:" << query.lastError().text();
+        return -1;
+    }
+    return query.value(0).toLongLong();
+}
+
+QByteArray DatabaseManager::getProductImage(int productId) {
+    // Called from image decode workers while the grid paints
+    ReadSnapshot snapshot(readPool);
+    QSqlDatabase readDb = readDatabase(snapshot);
+    if (!readDb.isValid()) {
+        qDebug() << "Error reading product image: no read connection on this thread";
+        return QByteArray();
+    }
+    QSqlQuery query(readDb);
+    query.prepare("SELECT image_data FROM products WHERE id = ?");
+    query.addBindValue(productId);
+    if (!query.exec()) {
+        qDebug() << "Error reading product image:" << query.lastError().text();
+        return QByteArray();
+    }
+    return query.next() ? query.value(0).toByteArray() : QByteArray();
+}
+
+QSqlDatabase DatabaseManager::readDatabase(const ReadSnapshot& snapshot) const {
+    if (snapshot.isValid()) {
+        return snapshot.database();
+    }
+    // The main connection may only be used from the thread that opened it
+    if (QThread::currentThread() != thread()) {
+        return QSqlDatabase();
+    }
+    return db;
+}
+
+QList<Product> DatabaseManager::getProductsBySeller(int sellerId) {
+    return querySellerProducts("?", sellerId, 0, -1, nullptr);
+}
+
+QList<Product> DatabaseManager::getSellerProducts(const QString& sellerEmail, int offset, int limit, int* total) {
+    return querySellerProducts("(SELECT id FROM users WHERE email = ?)", sellerEmail, offset, limit, total);
+}
+
+QList<Product> DatabaseManager::querySellerProducts(const QString& sellerClause, const QVariant& seller,
+                                                    int offset, int limit, int* total) {
+    QList<Product> products;
+    if (total) {
+        *total = 0;
+    }
+    
+    ReadSnapshot snapshot(readPool);
+    QSqlQuery query(readDatabase(snapshot));
+    // The window count rides along with the page so paging needs no second query
+    query.prepare(QString("SELECT id, name, description, price, seller_id, category, image_url, stock, "
+                          "image_data IS NOT NULL AS has_image, COUNT(*) OVER () AS total_count "
+                          "FROM products WHERE seller_id = %1 "
+                          "ORDER BY id DESC LIMIT ? OFFSET ?").arg(sellerClause));
+    query.addBindValue(seller);
+    query.addBindValue(limit);
+    query.addBindValue(offset);
+    
+    if (!query.exec()) {
+        qDebug() << "Error fetching seller products:" << query.lastError().text();
+        return products;
+    }
     
     while (query.next()) {
         Product product;
@@ -259,15 +701,70 @@ QList<Product> DatabaseManager::getAllProducts() {
         product.price = query.value("price").toDouble();
         product.sellerId = query.value("seller_id").toInt();
         product.category = query.value("category").toString();
-        product.imageData = query.value("image_data").toByteArray();
         product.imageUrl = query.value("image_url").toString();
         product.stock = query.value("stock").toInt();
+        product.hasImageData = query.value("has_image").toBool();
+        if (total) {
+            *total = query.value("total_count").toInt();
+        }
         products.append(product);
     }
     
     return products;
 }
 
+QList<Order> DatabaseManager::getSellerOrders(const QString& sellerEmail, int offset, int limit, int* total) {
+    QList<Order> orders;
+    if (total) {
+        *total = 0;
+    }
+    
+    ReadSnapshot snapshot(readPool);
+    QSqlQuery query(readDatabase(snapshot));
+    // Resolve the seller once, collect their lines through the seller and
+    // product indexes, then join back to the orders on that page only.
+    query.prepare("WITH seller_lines AS ("
+                  "    SELECT oi.order_id, SUM(oi.quantity) AS item_count, "
+                  "           SUM(oi.quantity * oi.price) AS seller_total "
+                  "    FROM products p "
+                  "    JOIN all_order_items oi ON oi.product_id = p.id "
+                  "    WHERE p.seller_id = (SELECT id FROM users WHERE email = ?) "
+                  "    GROUP BY oi.order_id"
+                  ") "
+                  "SELECT o.id, o.user_id, o.order_date, o.status, sl.seller_total, sl.item_count, "
+                  "       u.email AS customer_email, COUNT(*) OVER () AS total_count "
+                  "FROM seller_lines sl "
+                  "JOIN all_orders o ON o.id = sl.order_id "
+                  "LEFT JOIN users u ON u.id = o.user_id "
+                  "ORDER BY o.order_date DESC, o.id DESC "
+                  "LIMIT ? OFFSET ?");
+    query.addBindValue(sellerEmail);
+    query.addBindValue(limit);
+    query.addBindValue(offset);
+    
+    if (!query.exec()) {
+        qDebug() << "Error fetching seller orders:" << query.lastError().text();
+        return orders;
+    }
+    
+    while (query.next()) {
+        Order order;
+        order.id = query.value("id").toInt();
+        order.userId = query.value("user_id").toInt();
+        order.orderDate = query.value("order_date").toLongLong();
+        order.status = query.value("status").toString();
+        order.totalAmount = query.value("seller_total").toDouble();
+        order.itemCount = query.value("item_count").toInt();
+        order.customerEmail = query.value("customer_email").toString();
+        if (total) {
+            *total = query.value("total_count").toInt();
+        }
+        orders.append(order);
+    }
+    
+    return orders;
+}
+
 User DatabaseManager::getUserByEmail(const QString& email) {
     QSqlQuery query;
     query.prepare("SELECT * FROM users WHERE email = ?");
@@ -324,7 +821,7 @@ int DatabaseManager::getUserIdByEmail(const QString& email) {
 }
 
 // Cart operations implementation
-bool DatabaseManager::addToCart(int userId, int productId, int quantity) {
+bool DatabaseManager::addToCart(int userId, int productId, int quantity, int* cartItemId) {
     // First check if there's enough stock
     Product product = getProductById(productId);
     if (product.id == -1) {
@@ -349,6 +846,8 @@ bool DatabaseManager::addToCart(int userId, int productId, int quantity) {
     if (!success) {
         qDebug() << "Failed to add to cart: Database error:" << query.lastError().text();
         qDebug() << "User ID:" << userId << "Product ID:" << productId << "Quantity:" << quantity;
+    } else if (cartItemId) {
+        *cartItemId = query.lastInsertId().toInt();
     }
     return success;
 }
@@ -405,98 +904,79 @@ QList<CartItem> DatabaseManager::getCartItems(int userId) {
     return items;
 }
 
-bool DatabaseManager::clearCart(int userId) {
+CartView DatabaseManager::getCartView(int userId) {
+    CartView view;
     QSqlQuery query;
-    query.prepare("DELETE FROM cart WHERE user_id = ?");
+    // One round trip: the product columns come from the join and the total from
+    // a window over the same rows, leaving out lines whose product is gone
+    query.prepare(QString("SELECT %1, "
+                          "SUM(CASE WHEN p.id IS NULL THEN 0 ELSE c.quantity * c.price END) OVER () AS cart_total "
+                          "FROM cart c "
+                          "LEFT JOIN products p ON p.id = c.product_id "
+                          "WHERE c.user_id = ? "
+                          "ORDER BY c.id").arg(CART_LINE_COLUMNS));
     query.addBindValue(userId);
     
     if (!query.exec()) {
-        qDebug() << "Error clearing cart:" << query.lastError().text();
-        return false;
+        qDebug() << "Error getting cart view:" << query.lastError().text();
+        return view;
     }
-    return true;
+    
+    while (query.next()) {
+        view.lines.append(cartLineFromQuery(query));
+        view.total = query.value(10).toDouble();
+    }
+    return view;
 }
 
-bool DatabaseManager::createOrder(int userId, const QList<CartItem>& items) {
-    QSqlDatabase::database().transaction();
-    
-    qDebug() << "Creating order for user ID:" << userId << "with" << items.size() << "items";
-    
+CartLine DatabaseManager::getCartLine(int cartItemId) {
     QSqlQuery query;
-    query.prepare("INSERT INTO orders (user_id, order_date, status, total_amount) "
-                "VALUES (?, ?, ?, ?)");
-    query.addBindValue(userId);
-    query.addBindValue(QDateTime::currentDateTime());
-    query.addBindValue("Pending");
-    
-    double totalAmount = 0;
-    for (const CartItem& item : items) {
-        totalAmount += item.price * item.quantity;
-    }
-    query.addBindValue(totalAmount);
+    query.prepare(QString("SELECT %1 FROM cart c "
+                          "LEFT JOIN products p ON p.id = c.product_id "
+                          "WHERE c.id = ?").arg(CART_LINE_COLUMNS));
+    query.addBindValue(cartItemId);
     
     if (!query.exec()) {
-        qDebug() << "Failed to create order: Database error:" << query.lastError().text();
-        QSqlDatabase::database().rollback();
-        return false;
+        qDebug() << "Error getting cart line:" << query.lastError().text();
+        return CartLine();
     }
+    return query.next() ? cartLineFromQuery(query) : CartLine();
+}
+
+qint64 DatabaseManager::getCartVersion(int userId) {
+    QSqlQuery query;
+    query.prepare("SELECT version FROM cart_versions WHERE user_id = ?");
+    query.addBindValue(userId);
     
-    int orderId = query.lastInsertId().toInt();
-    qDebug() << "Created order with ID:" << orderId << "Total amount:" << totalAmount;
-    
-    // Add order items and update stock
-    for (const CartItem& item : items) {
-        // Get product details
-        Product product = getProductById(item.productId);
-        if (product.id == -1) {
-            qDebug() << "Failed to find product with ID:" << item.productId;
-            QSqlDatabase::database().rollback();
-            return false;
-        }
-        
-        // Update stock
-        if (!decrementProductStock(item.productId, item.quantity)) {
-            qDebug() << "Failed to decrement stock for product:" << item.productId;
-            QSqlDatabase::database().rollback();
-            return false;
-        }
-        
-        // Add order item
-        query.prepare("INSERT INTO order_items (order_id, product_id, product_name, quantity, price) "
-                    "VALUES (?, ?, ?, ?, ?)");
-        query.addBindValue(orderId);
-        query.addBindValue(item.productId);
-        query.addBindValue(product.name);  // Add the product name
-        query.addBindValue(item.quantity);
-        query.addBindValue(item.price);
-        
-        if (!query.exec()) {
-            qDebug() << "Failed to add order item: Database error:" << query.lastError().text();
-            QSqlDatabase::database().rollback();
-            return false;
-        }
-        
-        qDebug() << "Added order item - Product:" << product.name 
-                 << "Quantity:" << item.quantity 
-                 << "Price:" << item.price;
+    if (!query.exec()) {
+        qDebug() << "Error reading cart version:" << query.lastError().text();
+        return -1;
     }
-    
-    // Clear cart
+    return query.next() ? query.value(0).toLongLong() : 0;
+}
+
+bool DatabaseManager::clearCart(int userId) {
+    QSqlQuery query;
     query.prepare("DELETE FROM cart WHERE user_id = ?");
     query.addBindValue(userId);
+    
     if (!query.exec()) {
-        qDebug() << "Failed to clear cart: Database error:" << query.lastError().text();
-        QSqlDatabase::database().rollback();
+        qDebug() << "Error clearing cart:" << query.lastError().text();
         return false;
     }
-    
-    bool success = QSqlDatabase::database().commit();
-    if (!success) {
-        qDebug() << "Failed to commit transaction:" << QSqlDatabase::database().lastError().text();
-    } else {
-        qDebug() << "Successfully created order and cleared cart";
-    }
-    return success;
+    return true;
+}
+
+QFuture<int> DatabaseManager::createOrder(int userId, const QList<CartItem>& items) {
+    return checkoutEngine.placeOrder(userId, items);
+}
+
+CheckoutEngine& DatabaseManager::getCheckoutEngine() {
+    return checkoutEngine;
+}
+
+CheckoutEngine::Result DatabaseManager::lastCheckoutResult() const {
+    return checkoutEngine.lastResult();
 }
 
 QList<Order> DatabaseManager::getUserOrders(int userId) {
@@ -516,8 +996,8 @@ QList<Order> DatabaseManager::getUserOrders(int userId) {
     
     // Get all orders for the user
     query.prepare("SELECT o.*, COUNT(oi.id) as item_count "
-                 "FROM orders o "
-                 "LEFT JOIN order_items oi ON o.id = oi.order_id "
+                 "FROM all_orders o "
+                 "LEFT JOIN all_order_items oi ON o.id = oi.order_id "
                  "WHERE o.user_id = ? "
                  "GROUP BY o.id "
                  "ORDER BY o.order_date DESC");
@@ -537,13 +1017,14 @@ QList<Order> DatabaseManager::getUserOrders(int userId) {
         Order order;
         order.id = query.value("id").toInt();
         order.userId = query.value("user_id").toInt();
-        order.orderDate = query.value("order_date").toDateTime();
+        order.orderDate = query.value("order_date").toLongLong();
         order.status = query.value("status").toString();
         order.totalAmount = query.value("total_amount").toDouble();
         int itemCount = query.value("item_count").toInt();
+        order.itemCount = itemCount;
         
         qDebug() << "Found order - ID:" << order.id 
-                 << "Date:" << order.orderDate.toString("yyyy-MM-dd hh:mm:ss")
+                 << "Date:" << order.orderDateTime().toString("yyyy-MM-dd hh:mm:ss")
                  << "Status:" << order.status 
                  << "Total:" << order.totalAmount
                  << "Items:" << itemCount;
@@ -551,7 +1032,7 @@ QList<Order> DatabaseManager::getUserOrders(int userId) {
         // Get order items
         QSqlQuery itemsQuery;
         itemsQuery.prepare("SELECT oi.*, p.name as product_name "
-                         "FROM order_items oi "
+                         "FROM all_order_items oi "
                          "LEFT JOIN products p ON oi.product_id = p.id "
                          "WHERE oi.order_id = ?");
         itemsQuery.addBindValue(order.id);
@@ -563,6 +1044,8 @@ QList<Order> DatabaseManager::getUserOrders(int userId) {
                 item.orderId = itemsQuery.value("order_id").toInt();
                 item.productId = itemsQuery.value("product_id").toInt();
                 item.productName = itemsQuery.value("product_name").toString();
+                item.sellerId = itemsQuery.value("seller_id").isNull() ? -1 : itemsQuery.value("seller_id").toInt();
+                item.category = itemsQuery.value("category").toString();
                 item.quantity = itemsQuery.value("quantity").toInt();
                 item.price = itemsQuery.value("price").toDouble();
                 order.items.append(item);
@@ -586,17 +1069,18 @@ QList<Order> DatabaseManager::getUserOrders(int userId) {
 QList<Order> DatabaseManager::getUserOrdersByDateRange(int userId, const QDateTime& startDate, const QDateTime& endDate) {
     QList<Order> orders;
     QSqlQuery query;
-    query.prepare("SELECT * FROM orders WHERE user_id = ? AND order_date BETWEEN ? AND ? ORDER BY order_date DESC");
+    // Integer bounds keep this a range scan on idx_orders_user_date
+    query.prepare("SELECT * FROM all_orders WHERE user_id = ? AND order_date BETWEEN ? AND ? ORDER BY order_date DESC");
     query.addBindValue(userId);
-    query.addBindValue(startDate);
-    query.addBindValue(endDate);
+    query.addBindValue(startDate.toMSecsSinceEpoch());
+    query.addBindValue(endDate.toMSecsSinceEpoch());
     
     if (query.exec()) {
         while (query.next()) {
             Order order;
             order.id = query.value("id").toInt();
             order.userId = query.value("user_id").toInt();
-            order.orderDate = query.value("order_date").toDateTime();
+            order.orderDate = query.value("order_date").toLongLong();
             order.status = query.value("status").toString();
             order.totalAmount = query.value("total_amount").toDouble();
             orders.append(order);
@@ -609,7 +1093,7 @@ QList<Order> DatabaseManager::getUserOrdersByDateRange(int userId, const QDateTi
 QList<Order> DatabaseManager::getUserOrdersByStatus(int userId, const QString& status) {
     QList<Order> orders;
     QSqlQuery query;
-    query.prepare("SELECT * FROM orders WHERE user_id = ? AND status = ? ORDER BY order_date DESC");
+    query.prepare("SELECT * FROM all_orders WHERE user_id = ? AND status = ? ORDER BY order_date DESC");
     query.addBindValue(userId);
     query.addBindValue(status);
     
@@ -618,7 +1102,7 @@ QList<Order> DatabaseManager::getUserOrdersByStatus(int userId, const QString& s
             Order order;
             order.id = query.value("id").toInt();
             order.userId = query.value("user_id").toInt();
-            order.orderDate = query.value("order_date").toDateTime();
+            order.orderDate = query.value("order_date").toLongLong();
             order.status = query.value("status").toString();
             order.totalAmount = query.value("total_amount").toDouble();
             orders.append(order);
@@ -631,19 +1115,19 @@ QList<Order> DatabaseManager::getUserOrdersByStatus(int userId, const QString& s
 Order DatabaseManager::getOrderById(int orderId) {
     Order order;
     QSqlQuery query;
-    query.prepare("SELECT * FROM orders WHERE id = ?");
+    query.prepare("SELECT * FROM all_orders WHERE id = ?");
     query.addBindValue(orderId);
     
     if (query.exec() && query.next()) {
         order.id = query.value("id").toInt();
         order.userId = query.value("user_id").toInt();
-        order.orderDate = query.value("order_date").toDateTime();
+        order.orderDate = query.value("order_date").toLongLong();
         order.status = query.value("status").toString();
         order.totalAmount = query.value("total_amount").toDouble();
         
         // Get order items
         QSqlQuery itemsQuery;
-        itemsQuery.prepare("SELECT * FROM order_items WHERE order_id = ?");
+        itemsQuery.prepare("SELECT * FROM all_order_items WHERE order_id = ?");
         itemsQuery.addBindValue(order.id);
         
         if (itemsQuery.exec()) {
@@ -653,6 +1137,8 @@ Order DatabaseManager::getOrderById(int orderId) {
                 item.orderId = itemsQuery.value("order_id").toInt();
                 item.productId = itemsQuery.value("product_id").toInt();
                 item.productName = itemsQuery.value("product_name").toString();
+                item.sellerId = itemsQuery.value("seller_id").isNull() ? -1 : itemsQuery.value("seller_id").toInt();
+                item.category = itemsQuery.value("category").toString();
                 item.quantity = itemsQuery.value("quantity").toInt();
                 item.price = itemsQuery.value("price").toDouble();
                 order.items.append(item);
@@ -663,17 +1149,112 @@ Order DatabaseManager::getOrderById(int orderId) {
     return order;
 }
 
+QList<OrderSummary> DatabaseManager::getUserOrderSummaries(int userId, const QDateTime& from,
+                                                           const QDateTime& to, const QString& status,
+                                                           const OrderSummary& after, int limit) {
+    QList<OrderSummary> orders;
+    
+    // The item count comes from idx_order_items_order, so no item rows are read
+    QString sql = "SELECT o.id, o.order_date, o.status, o.total_amount, "
+                  "       (SELECT COUNT(*) FROM all_order_items oi WHERE oi.order_id = o.id) AS item_count "
+                  "FROM all_orders o WHERE o.user_id = ?";
+    if (from.isValid()) {
+        sql += " AND o.order_date >= ?";
+    }
+    if (to.isValid()) {
+        sql += " AND o.order_date <= ?";
+    }
+    if (!status.isEmpty()) {
+        sql += " AND o.status = ?";
+    }
+    if (after.id != -1) {
+        // The plain bound keeps this a range scan on idx_orders_user_date;
+        // the second term breaks ties between orders placed in the same ms
+        sql += " AND o.order_date <= ? AND (o.order_date < ? OR o.id < ?)";
+    }
+    sql += " ORDER BY o.order_date DESC, o.id DESC";
+    if (limit >= 0) {
+        sql += " LIMIT ?";
+    }
+    
+    ReadSnapshot snapshot(readPool);
+    QSqlQuery query(readDatabase(snapshot));
+    query.prepare(sql);
+    query.addBindValue(userId);
+    if (from.isValid()) {
+        query.addBindValue(from.toMSecsSinceEpoch());
+    }
+    if (to.isValid()) {
+        query.addBindValue(to.toMSecsSinceEpoch());
+    }
+    if (!status.isEmpty()) {
+        query.addBindValue(status);
+    }
+    if (after.id != -1) {
+        query.addBindValue(after.orderDate);
+        query.addBindValue(after.orderDate);
+        query.addBindValue(after.id);
+    }
+    if (limit >= 0) {
+        query.addBindValue(limit);
+    }
+    
+    if (!query.exec()) {
+        qDebug() << "Error fetching order summaries:" << query.lastError().text();
+        return orders;
+    }
+    
+    while (query.next()) {
+        OrderSummary order;
+        order.id = query.value(0).toInt();
+        order.orderDate = query.value(1).toLongLong();
+        order.status = query.value(2).toString();
+        order.totalAmount = query.value(3).toDouble();
+        order.itemCount = query.value(4).toInt();
+        orders.append(order);
+    }
+    return orders;
+}
+
 bool DatabaseManager::updateOrderStatus(int orderId, const QString& status) {
     QSqlQuery query;
+    if (!query.exec("BEGIN IMMEDIATE")) {
+        qDebug() << "Error updating order status:" << query.lastError().text();
+        return false;
+    }
+    
+    query.prepare("SELECT status FROM orders WHERE id = ?");
+    query.addBindValue(orderId);
+    if (!query.exec() || !query.next()) {
+        qDebug() << "Error updating order status: order not found:" << orderId;
+        query.exec("ROLLBACK");
+        return false;
+    }
+    QString oldStatus = query.value(0).toString();
+    query.finish();
+    
     query.prepare("UPDATE orders SET status = ? WHERE id = ?");
     query.addBindValue(status);
     query.addBindValue(orderId);
     
     if (!query.exec()) {
         qDebug() << "Error updating order status:" << query.lastError().text();
+        query.exec("ROLLBACK");
         return false;
     }
     
+    // Cancelling takes an order out of the sales rollups, reinstating puts it back
+    int delta = SalesRollup::statusWeight(status) - SalesRollup::statusWeight(oldStatus);
+    if (delta != 0 && !SalesRollup::applyOrder(db, orderId, delta)) {
+        query.exec("ROLLBACK");
+        return false;
+    }
+    
+    if (!query.exec("COMMIT")) {
+        qDebug() << "Error committing order status:" << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
     return true;
 }
 
@@ -734,7 +1315,7 @@ Review DatabaseManager::getReviewById(int reviewId) {
         review.username = query.value("username").toString();
         review.rating = query.value("rating").toInt();
         review.comment = query.value("comment").toString();
-        review.reviewDate = query.value("review_date").toDateTime();
+        review.reviewDate = query.value("review_date").toLongLong();
     }
     
     return review;
@@ -755,7 +1336,7 @@ QList<Review> DatabaseManager::getProductReviews(int productId) {
             review.username = query.value("username").toString();
             review.rating = query.value("rating").toInt();
             review.comment = query.value("comment").toString();
-            review.reviewDate = query.value("review_date").toDateTime();
+            review.reviewDate = query.value("review_date").toLongLong();
             reviews.append(review);
         }
     }
@@ -777,7 +1358,7 @@ Review DatabaseManager::getUserProductReview(int userId, int productId) {
         review.username = query.value("username").toString();
         review.rating = query.value("rating").toInt();
         review.comment = query.value("comment").toString();
-        review.reviewDate = query.value("review_date").toDateTime();
+        review.reviewDate = query.value("review_date").toLongLong();
     }
     
     return review;
@@ -795,10 +1376,42 @@ double DatabaseManager::getProductAverageRating(int productId) {
     return 0.0;
 }
 
+QHash<int, RatingSummary> DatabaseManager::getRatingSummaries() {
+    QHash<int, RatingSummary> summaries;
+    ReadSnapshot snapshot(readPool);
+    QSqlQuery query(readDatabase(snapshot));
+    // One grouped pass over the product/date index instead of two queries per card
+    if (!query.exec("SELECT product_id, AVG(rating), COUNT(*) FROM reviews GROUP BY product_id")) {
+        qDebug() << "Error fetching rating summaries:" << query.lastError().text();
+        return summaries;
+    }
+    while (query.next()) {
+        RatingSummary summary;
+        summary.average = query.value(1).toDouble();
+        summary.count = query.value(2).toInt();
+        summaries.insert(query.value(0).toInt(), summary);
+    }
+    return summaries;
+}
+
+QHash<int, QString> DatabaseManager::getSellerNames() {
+    QHash<int, QString> names;
+    ReadSnapshot snapshot(readPool);
+    QSqlQuery query(readDatabase(snapshot));
+    if (!query.exec("SELECT id, username FROM users WHERE id IN (SELECT seller_id FROM products)")) {
+        qDebug() << "Error fetching seller names:" << query.lastError().text();
+        return names;
+    }
+    while (query.next()) {
+        names.insert(query.value(0).toInt(), query.value(1).toString());
+    }
+    return names;
+}
+
 bool DatabaseManager::hasUserPurchasedProduct(int userId, int productId) {
     QSqlQuery query;
-    query.prepare("SELECT COUNT(*) FROM orders o "
-                 "JOIN order_items oi ON o.id = oi.order_id "
+    query.prepare("SELECT COUNT(*) FROM all_orders o "
+                 "JOIN all_order_items oi ON o.id = oi.order_id "
                  "WHERE o.user_id = ? AND oi.product_id = ? "
                  "AND o.status IN ('Delivered', 'Shipped')");
     query.addBindValue(userId);
@@ -902,11 +1515,12 @@ QList<User> DatabaseManager::getAllUsers() {
 }
 
 double DatabaseManager::getTotalSales() {
-    QSqlQuery query(db);
+    ReadSnapshot snapshot(readPool);
+    QSqlQuery query(readDatabase(snapshot));
     
     qDebug() << "Calculating total sales";
     
-    if (!query.exec("SELECT COALESCE(SUM(total_amount), 0) as total FROM orders")) {
+    if (!query.exec("SELECT COALESCE(SUM(total_amount), 0) as total FROM all_orders")) {
         qDebug() << "Error calculating total sales:" << query.lastError().text();
         return 0.0;
     }
@@ -922,11 +1536,12 @@ double DatabaseManager::getTotalSales() {
 }
 
 int DatabaseManager::getTotalOrders() {
-    QSqlQuery query(db);
+    ReadSnapshot snapshot(readPool);
+    QSqlQuery query(readDatabase(snapshot));
     
     qDebug() << "Counting total orders";
     
-    if (!query.exec("SELECT COUNT(*) as count FROM orders")) {
+    if (!query.exec("SELECT COUNT(*) as count FROM all_orders")) {
         qDebug() << "Error counting orders:" << query.lastError().text();
         return 0;
     }
@@ -942,14 +1557,151 @@ int DatabaseManager::getTotalOrders() {
 }
 
 double DatabaseManager::getAverageOrderValue() {
-    QSqlQuery query(db);
-    query.exec("SELECT COALESCE(AVG(total_amount), 0) FROM orders");
+    ReadSnapshot snapshot(readPool);
+    QSqlQuery query(readDatabase(snapshot));
+    query.exec("SELECT COALESCE(AVG(total_amount), 0) FROM all_orders");
     if (query.next()) {
         return query.value(0).toDouble();
     }
     return 0.0;
 }
 
+SalesSummary DatabaseManager::getSalesSummary() {
+    // One snapshot for all three figures so they always agree with each other
+    ReadSnapshot snapshot(readPool);
+    QSqlQuery query(readDatabase(snapshot));
+    
+    SalesSummary summary;
+    if (!query.exec("SELECT COALESCE(SUM(total_amount), 0) AS total, COUNT(*) AS count, "
+                    "COALESCE(AVG(total_amount), 0) AS average FROM all_orders")) {
+        qDebug() << "Error calculating sales summary:" << query.lastError().text();
+        return summary;
+    }
+    
+    if (query.next()) {
+        summary.totalSales = query.value("total").toDouble();
+        summary.totalOrders = query.value("count").toInt();
+        summary.averageOrderValue = query.value("average").toDouble();
+    }
+    return summary;
+}
+
+QList<SalesRollupRow> DatabaseManager::getSalesRollup(RollupGranularity granularity, const QDateTime& from,
+                                                     const QDateTime& to, int sellerId) {
+    ReadSnapshot snapshot(readPool);
+    QSqlDatabase readDb = readDatabase(snapshot);
+    return SalesRollup::query(readDb, granularity, from, to, sellerId);
+}
+
+bool DatabaseManager::backfillSalesRollups() {
+    return SalesRollup::backfill(db);
+}
+
+bool DatabaseManager::saveSession(const StoredSession& session) {
+    QSqlQuery query;
+    query.prepare("INSERT OR REPLACE INTO sessions (token_hash, user_id, expires_at) VALUES (?, ?, ?)");
+    query.addBindValue(session.tokenHash);
+    query.addBindValue(session.userId);
+    query.addBindValue(session.expiresAt);
+    if (!query.exec()) {
+        qDebug() << "Error saving session:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::deleteSession(const QByteArray& tokenHash) {
+    QSqlQuery query;
+    query.prepare("DELETE FROM sessions WHERE token_hash = ?");
+    query.addBindValue(tokenHash);
+    if (!query.exec()) {
+        qDebug() << "Error deleting session:" << query.lastError().text();
+        return false;
+    }
+    return query.numRowsAffected() > 0;
+}
+
+int DatabaseManager::deleteExpiredSessions(qint64 nowMs) {
+    QSqlQuery query;
+    query.prepare("DELETE FROM sessions WHERE expires_at <= ?");
+    query.addBindValue(nowMs);
+    if (!query.exec()) {
+        qDebug() << "Error purging sessions:" << query.lastError().text();
+        return -1;
+    }
+    return query.numRowsAffected();
+}
+
+StoredSession DatabaseManager::getSession(const QByteArray& tokenHash, qint64 nowMs) {
+    StoredSession session;
+    // Validation runs on several threads
+    ReadSnapshot snapshot(readPool);
+    QSqlQuery query(readDatabase(snapshot));
+    query.prepare("SELECT user_id, expires_at FROM sessions WHERE token_hash = ? AND expires_at > ?");
+    query.addBindValue(tokenHash);
+    query.addBindValue(nowMs);
+    if (!query.exec()) {
+        qDebug() << "Error loading session:" << query.lastError().text();
+        return session;
+    }
+    if (query.next()) {
+        session.tokenHash = tokenHash;
+        session.userId = query.value(0).toString();
+        session.expiresAt = query.value(1).toLongLong();
+    }
+    return session;
+}
+
+bool DatabaseManager::migrateSessionTokens() {
+    // Tables from before the hashing kept the raw token in a "token" column
+    QSqlQuery query;
+    if (!query.exec("PRAGMA table_info(sessions)")) {
+        qDebug() << "Error reading sessions schema:" << query.lastError().text();
+        return false;
+    }
+    bool hasRawToken = false;
+    while (query.next()) {
+        if (query.value("name").toString() == "token") {
+            hasRawToken = true;
+        }
+    }
+    query.finish();
+    if (!hasRawToken) {
+        return true;
+    }
+
+    qDebug() << "Replacing stored session tokens by their hashes";
+
+    bool ok = query.exec("BEGIN IMMEDIATE")
+        && query.exec("ALTER TABLE sessions RENAME TO sessions_raw")
+        && query.exec("DROP INDEX IF EXISTS idx_sessions_expires")
+        && query.exec("CREATE TABLE sessions ("
+                      "    token_hash BLOB PRIMARY KEY,"
+                      "    user_id TEXT NOT NULL,"
+                      "    expires_at INTEGER NOT NULL"
+                      ") WITHOUT ROWID")
+        && query.exec("SELECT token, user_id, expires_at FROM sessions_raw");
+    QSqlQuery insert;
+    insert.prepare("INSERT OR REPLACE INTO sessions (token_hash, user_id, expires_at) VALUES (?, ?, ?)");
+    while (ok && query.next()) {
+        insert.addBindValue(StoredSession::hashToken(query.value(0).toByteArray()));
+        insert.addBindValue(query.value(1));
+        insert.addBindValue(query.value(2));
+        if (!insert.exec()) {
+            qDebug() << "Error hashing stored session token:" << insert.lastError().text();
+            ok = false;
+        }
+    }
+    query.finish();
+    ok = ok && query.exec("DROP TABLE sessions_raw") && query.exec("COMMIT");
+    if (!ok) {
+        qDebug() << "Error migrating sessions:" << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
+    return true;
+}
+
 User DatabaseManager::getUserById(int userId) {
     QSqlQuery query;
     query.prepare("SELECT email, username, password, is_admin, is_suspended FROM users WHERE id = ?");
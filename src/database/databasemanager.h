@@ -8,142 +8,151 @@
 #include <QByteArray>
 #include <QDateTime>
 #include <QObject>
-#include "../auth/user.h"
-
-struct CartItem {
-    int id;
-    int userId;
-    int productId;
-    int quantity;
-    double price;  // Price at time of adding to cart
-    
-    CartItem() : id(-1), userId(-1), productId(-1), quantity(0), price(0.0) {}
-};
-
-struct OrderItem {
-    int id;
-    int orderId;
-    int productId;
-    QString productName;
-    int quantity;
-    double price;
-    
-    OrderItem() : id(-1), orderId(-1), productId(-1), quantity(0), price(0.0) {}
-};
+#include "storagebackend.h"
+#include "readconnectionpool.h"
+#include "orderarchiver.h"
+#include "backupservice.h"
+#include "maintenancescheduler.h"
 
-struct Order {
-    int id;
-    int userId;
-    QDateTime orderDate;
-    QString status;
-    double totalAmount;
-    QList<OrderItem> items;
-    
-    Order() : id(-1), userId(-1), totalAmount(0.0) {}
-};
-
-class Product {
-public:
-    int id;
-    QString name;
-    QString description;
-    double price;
-    QByteArray imageData;
-    int sellerId;
-    QString category;
-    QString imageUrl;  // URL for fetching the image
-    int stock;        // Stock quantity
-    
-    Product() : id(-1), price(0.0), sellerId(-1), stock(0) {}
-};
-
-struct Review {
-    int id;
-    int productId;
-    int userId;
-    QString username;  // Store username for display
-    int rating;       // 1-5 stars
-    QString comment;
-    QDateTime reviewDate;
-    
-    Review() : id(-1), productId(-1), userId(-1), rating(0) {}
-};
-
-class DatabaseManager : public QObject {
+// SQLite storage: marketplace.db in the working directory, plus the
+// checkout, read pool, archive, backup and maintenance machinery around it.
+class DatabaseManager : public QObject, public StorageBackend {
     Q_OBJECT
 
 public:
     static DatabaseManager& getInstance();
     
-    bool initialize();
-    bool addUser(const User& user);
-    bool addProduct(const Product& product);
-    bool updateProductStock(int productId, int newStock);
-    bool decrementProductStock(int productId, int quantity);
-    QList<Product> getProductsBySeller(int sellerId);
-    QList<Product> getAllProducts();
-    Product getProductById(int productId);
-    User getUserByEmail(const QString& email);
-    User getUserByUsername(const QString& username);
-    User getUserById(int userId);
-    bool userExists(const QString& email, const QString& username);
-    int getUserIdByEmail(const QString& email);
+    bool initialize() override;
+    bool addUser(const User& user) override;
+    bool addProduct(const Product& product) override;
+    bool updateProductStock(int productId, int newStock) override;
+    bool decrementProductStock(int productId, int quantity) override;
+    QList<Product> getProductsBySeller(int sellerId) override;
+    QByteArray getProductImage(int productId) override;
+    QList<Product> getSellerProducts(const QString& sellerEmail, int offset = 0, int limit = 50,
+                                     int* total = nullptr) override;
+    QList<Order> getSellerOrders(const QString& sellerEmail, int offset = 0, int limit = 50,
+                                 int* total = nullptr) override;
+    QList<Product> getAllProducts() override;
+    qint64 getCatalogVersion() override;
+    Product getProductById(int productId) override;
+    User getUserByEmail(const QString& email) override;
+    User getUserByUsername(const QString& username) override;
+    User getUserById(int userId) override;
+    bool userExists(const QString& email, const QString& username) override;
+    int getUserIdByEmail(const QString& email) override;
 
     // Cart operations
-    bool addToCart(int userId, int productId, int quantity);
-    bool updateCartItemQuantity(int cartItemId, int quantity);
-    bool removeFromCart(int cartItemId);
-    QList<CartItem> getCartItems(int userId);
-    bool clearCart(int userId);
+    bool addToCart(int userId, int productId, int quantity, int* cartItemId = nullptr) override;
+    bool updateCartItemQuantity(int cartItemId, int quantity) override;
+    bool removeFromCart(int cartItemId) override;
+    QList<CartItem> getCartItems(int userId) override;
+    CartView getCartView(int userId) override;
+    CartLine getCartLine(int cartItemId) override;
+    qint64 getCartVersion(int userId) override;
+    bool clearCart(int userId) override;
 
     // Order operations
-    bool createOrder(int userId, const QList<CartItem>& items);
+    QFuture<int> createOrder(int userId, const QList<CartItem>& items) override;
+    CheckoutEngine::Result lastCheckoutResult() const override;
     bool addOrderItem(int orderId, const CartItem& item);
-    QList<Order> getUserOrders(int userId);
-    QList<Order> getUserOrdersByDateRange(int userId, const QDateTime& startDate, const QDateTime& endDate);
-    QList<Order> getUserOrdersByStatus(int userId, const QString& status);
-    Order getOrderById(int orderId);
-    bool updateOrderStatus(int orderId, const QString& status);
+    QList<Order> getUserOrders(int userId) override;
+    QList<Order> getUserOrdersByDateRange(int userId, const QDateTime& startDate, const QDateTime& endDate) override;
+    QList<Order> getUserOrdersByStatus(int userId, const QString& status) override;
+    Order getOrderById(int orderId) override;
+    QList<OrderSummary> getUserOrderSummaries(int userId, const QDateTime& from = QDateTime(),
+                                              const QDateTime& to = QDateTime(),
+                                              const QString& status = QString(),
+                                              const OrderSummary& after = OrderSummary(),
+                                              int limit = -1) override;
+    bool updateOrderStatus(int orderId, const QString& status) override;
 
     // Review operations
-    bool addReview(const Review& review);
-    bool updateReview(const Review& review);
-    bool deleteReview(int reviewId);
-    Review getReviewById(int reviewId);
-    QList<Review> getProductReviews(int productId);
-    Review getUserProductReview(int userId, int productId);
-    double getProductAverageRating(int productId);
-    bool hasUserPurchasedProduct(int userId, int productId);
+    bool addReview(const Review& review) override;
+    bool updateReview(const Review& review) override;
+    bool deleteReview(int reviewId) override;
+    Review getReviewById(int reviewId) override;
+    QList<Review> getProductReviews(int productId) override;
+    Review getUserProductReview(int userId, int productId) override;
+    double getProductAverageRating(int productId) override;
+    bool hasUserPurchasedProduct(int userId, int productId) override;
 
     // Admin operations
-    bool isUserAdmin(int userId);
-    bool suspendUser(int userId);
-    bool unsuspendUser(int userId);
-    bool resetUserPassword(int userId, const QString& newHashedPassword);
-    bool deleteProduct(int productId);
-    QList<User> getAllUsers();
-    double getTotalSales();
-    int getTotalOrders();
-    double getAverageOrderValue();
+    bool isUserAdmin(int userId) override;
+    bool suspendUser(int userId) override;
+    bool unsuspendUser(int userId) override;
+    bool resetUserPassword(int userId, const QString& newHashedPassword) override;
+    bool deleteProduct(int productId) override;
+    QList<User> getAllUsers() override;
+    double getTotalSales() override;
+    int getTotalOrders() override;
+    double getAverageOrderValue() override;
+    SalesSummary getSalesSummary() override;
+    QList<SalesRollupRow> getSalesRollup(RollupGranularity granularity, const QDateTime& from,
+                                         const QDateTime& to, int sellerId = -1) override;
+    bool backfillSalesRollups();
+
+    // Sessions
+    bool saveSession(const StoredSession& session) override;
+    bool deleteSession(const QByteArray& tokenHash) override;
+    int deleteExpiredSessions(qint64 nowMs) override;
+    StoredSession getSession(const QByteArray& tokenHash, qint64 nowMs) override;
 
     // User related methods
     bool createUser(const QString& email, const QString& username, const QString& password, bool isAdmin = false, bool isSeller = false);
     bool authenticateUser(const QString& email, const QString& password);
     bool isUserAdmin(const QString& email);
-    bool isUserSeller(const QString& email);
-    bool updateUserRole(int userId, bool isAdmin, bool isSeller);
+    bool isUserSeller(const QString& email) override;
+    QHash<int, RatingSummary> getRatingSummaries() override;
+    QHash<int, QString> getSellerNames() override;
+    bool updateUserRole(int userId, bool isAdmin, bool isSeller) override;
+
+    // Checkout tuning and contention metrics
+    CheckoutEngine& getCheckoutEngine();
+
+    // Read-only connections for reports; they never wait on the write lane
+    ReadConnectionPool& getReadPool();
+
+    // Moves old delivered/cancelled orders into marketplace_archive.db
+    OrderArchiver& getOrderArchiver();
+
+    // Scheduled online backups into ./backups
+    BackupService& getBackupService();
+
+    // Idle-time ANALYZE, vacuum, checkpoints and archival, logged to maintenance_log
+    MaintenanceScheduler& getMaintenanceScheduler();
     
 private:
     DatabaseManager();
     ~DatabaseManager();
     
     QSqlDatabase db;
+    CheckoutEngine checkoutEngine;
+    ReadConnectionPool readPool;
+    OrderArchiver orderArchiver;
+    BackupService backupService;
+    MaintenanceScheduler maintenanceScheduler;
+    bool configureJournal();
     bool createTables();
     bool createUsersTable();
     bool createProductsTable();
     bool createOrdersTable();
     bool createCartTable();
     bool createSellerTable();
+    bool createSessionsTable();
+    bool migrateSessionTokens();
+    bool createOrderItemsTable();
+    bool createReviewsTable();
+    bool migrateTimestamps();
+    bool migrateToEpochMillis(const QString& table, const QString& dateColumn,
+                              const QString& schema, const QString& columns);
+    bool createIndexes();
+    bool createCatalogMeta();
+    bool createCartVersions();
+    QList<Product> querySellerProducts(const QString& sellerClause, const QVariant& seller,
+                                       int offset, int limit, int* total);
+    // The snapshot's connection, else db on the GUI thread; invalid on workers
+    QSqlDatabase readDatabase(const ReadSnapshot& snapshot) const;
 
     static DatabaseManager* instance;
 };
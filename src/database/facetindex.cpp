@@ -0,0 +1,414 @@
+#include "facetindex.h"
+#include "catalogstore.h"
+#include <QtAlgorithms>
+#include <QHash>
+#include <QMap>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+const int CONTAINER_BITS = 16;
+const int CONTAINER_WORDS = (1 << CONTAINER_BITS) / 64;
+const int DENSE_THRESHOLD = 4096;
+
+struct PriceBucket {
+    const char* key;
+    const char* label;
+    double upper;   // Exclusive
+};
+
+const PriceBucket PRICE_BUCKETS[] = {
+    {"0-25", "Under $25", 25.0},
+    {"25-50", "$25 - $50", 50.0},
+    {"50-100", "$50 - $100", 100.0},
+    {"100-250", "$100 - $250", 250.0},
+    {"250-500", "$250 - $500", 500.0},
+    {"500+", "$500 & up", -1.0},
+};
+const int PRICE_BUCKET_COUNT = sizeof(PRICE_BUCKETS) / sizeof(PRICE_BUCKETS[0]);
+
+int priceBucket(double price) {
+    for (int i = 0; i < PRICE_BUCKET_COUNT - 1; ++i) {
+        if (price < PRICE_BUCKETS[i].upper) {
+            return i;
+        }
+    }
+    return PRICE_BUCKET_COUNT - 1;
+}
+
+// 0 is unrated; 1 to 4 are [n, n + 1) with 5 stars counted in 4
+int ratingBucket(float rating) {
+    if (rating <= 0.0f) {
+        return 0;
+    }
+    return qBound(1, int(rating), 4);
+}
+}
+
+CompressedBitmap::CompressedBitmap()
+{
+}
+
+CompressedBitmap CompressedBitmap::fromRows(const QVector<int>& rows) {
+    CompressedBitmap bitmap;
+    for (int row : rows) {
+        int high = row >> CONTAINER_BITS;
+        if (bitmap.containers.isEmpty() || bitmap.containers.last().high != high) {
+            if (!bitmap.containers.isEmpty()) {
+                fitContainer(bitmap.containers.last());
+            }
+            Container container;
+            container.high = high;
+            bitmap.containers.append(container);
+        }
+        Container& container = bitmap.containers.last();
+        container.values.append(quint16(row & 0xFFFF));
+        ++container.cardinality;
+    }
+    if (!bitmap.containers.isEmpty()) {
+        fitContainer(bitmap.containers.last());
+    }
+    return bitmap;
+}
+
+void CompressedBitmap::toDense(Container& container) {
+    if (container.isDense()) {
+        return;
+    }
+    container.words.fill(0, CONTAINER_WORDS);
+    for (quint16 value : container.values) {
+        container.words[value >> 6] |= quint64(1) << (value & 63);
+    }
+    container.values.clear();
+    container.values.squeeze();
+}
+
+void CompressedBitmap::fitContainer(Container& container) {
+    if (!container.isDense() && container.cardinality >= DENSE_THRESHOLD) {
+        toDense(container);
+    } else if (container.isDense() && container.cardinality < DENSE_THRESHOLD) {
+        QVector<quint16> values;
+        values.reserve(container.cardinality);
+        for (int w = 0; w < CONTAINER_WORDS; ++w) {
+            quint64 word = container.words.at(w);
+            while (word) {
+                values.append(quint16(w * 64 + qCountTrailingZeroBits(word)));
+                word &= word - 1;
+            }
+        }
+        container.values = values;
+        container.words.clear();
+        container.words.squeeze();
+    } else {
+        container.values.squeeze();
+    }
+}
+
+int CompressedBitmap::cardinality() const {
+    int total = 0;
+    for (const Container& container : containers) {
+        total += container.cardinality;
+    }
+    return total;
+}
+
+bool CompressedBitmap::isEmpty() const {
+    return containers.isEmpty();
+}
+
+bool CompressedBitmap::contains(int row) const {
+    int high = row >> CONTAINER_BITS;
+    auto it = std::lower_bound(containers.cbegin(), containers.cend(), high,
+                               [](const Container& container, int key) { return container.high < key; });
+    if (it == containers.cend() || it->high != high) {
+        return false;
+    }
+    quint16 low = quint16(row & 0xFFFF);
+    if (it->isDense()) {
+        return (it->words.at(low >> 6) >> (low & 63)) & 1;
+    }
+    return std::binary_search(it->values.cbegin(), it->values.cend(), low);
+}
+
+CompressedBitmap::Container CompressedBitmap::intersect(const Container& a, const Container& b) {
+    Container result;
+    result.high = a.high;
+    if (a.isDense() && b.isDense()) {
+        result.words.resize(CONTAINER_WORDS);
+        for (int w = 0; w < CONTAINER_WORDS; ++w) {
+            result.words[w] = a.words.at(w) & b.words.at(w);
+            result.cardinality += qPopulationCount(result.words.at(w));
+        }
+    } else if (a.isDense() || b.isDense()) {
+        const Container& dense = a.isDense() ? a : b;
+        const Container& sparse = a.isDense() ? b : a;
+        for (quint16 value : sparse.values) {
+            if ((dense.words.at(value >> 6) >> (value & 63)) & 1) {
+                result.values.append(value);
+            }
+        }
+        result.cardinality = result.values.size();
+    } else {
+        std::set_intersection(a.values.cbegin(), a.values.cend(), b.values.cbegin(), b.values.cend(),
+                              std::back_inserter(result.values));
+        result.cardinality = result.values.size();
+    }
+    fitContainer(result);
+    return result;
+}
+
+CompressedBitmap::Container CompressedBitmap::unite(const Container& a, const Container& b) {
+    Container result;
+    result.high = a.high;
+    if (a.isDense() || b.isDense()) {
+        result.words.fill(0, CONTAINER_WORDS);
+        for (const Container* side : {&a, &b}) {
+            if (side->isDense()) {
+                for (int w = 0; w < CONTAINER_WORDS; ++w) {
+                    result.words[w] |= side->words.at(w);
+                }
+            } else {
+                for (quint16 value : side->values) {
+                    result.words[value >> 6] |= quint64(1) << (value & 63);
+                }
+            }
+        }
+        for (quint64 word : result.words) {
+            result.cardinality += qPopulationCount(word);
+        }
+    } else {
+        std::set_union(a.values.cbegin(), a.values.cend(), b.values.cbegin(), b.values.cend(),
+                       std::back_inserter(result.values));
+        result.cardinality = result.values.size();
+    }
+    fitContainer(result);
+    return result;
+}
+
+CompressedBitmap CompressedBitmap::operator&(const CompressedBitmap& other) const {
+    CompressedBitmap result;
+    int i = 0;
+    int j = 0;
+    while (i < containers.size() && j < other.containers.size()) {
+        const Container& a = containers.at(i);
+        const Container& b = other.containers.at(j);
+        if (a.high < b.high) {
+            ++i;
+        } else if (b.high < a.high) {
+            ++j;
+        } else {
+            Container both = intersect(a, b);
+            if (both.cardinality > 0) {
+                result.containers.append(both);
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+CompressedBitmap CompressedBitmap::operator|(const CompressedBitmap& other) const {
+    CompressedBitmap result;
+    int i = 0;
+    int j = 0;
+    while (i < containers.size() || j < other.containers.size()) {
+        if (j >= other.containers.size()
+            || (i < containers.size() && containers.at(i).high < other.containers.at(j).high)) {
+            result.containers.append(containers.at(i++));
+        } else if (i >= containers.size() || other.containers.at(j).high < containers.at(i).high) {
+            result.containers.append(other.containers.at(j++));
+        } else {
+            result.containers.append(unite(containers.at(i++), other.containers.at(j++)));
+        }
+    }
+    return result;
+}
+
+int CompressedBitmap::countWithin(const SelectionBitmap& selection) const {
+    const quint64* selected = selection.constData();
+    int selectedWords = selection.wordCount();
+    int total = 0;
+    for (const Container& container : containers) {
+        int firstWord = container.high * CONTAINER_WORDS;
+        if (container.isDense()) {
+            int words = qMin(CONTAINER_WORDS, selectedWords - firstWord);
+            for (int w = 0; w < words; ++w) {
+                total += qPopulationCount(container.words.at(w) & selected[firstWord + w]);
+            }
+        } else {
+            int base = container.high << CONTAINER_BITS;
+            for (quint16 value : container.values) {
+                int row = base + value;
+                if (row < selection.size() && selection.test(row)) {
+                    ++total;
+                }
+            }
+        }
+    }
+    return total;
+}
+
+SelectionBitmap CompressedBitmap::toSelection(int size) const {
+    SelectionBitmap result(size);
+    quint64* words = result.data();
+    int wordCount = result.wordCount();
+    for (const Container& container : containers) {
+        int firstWord = container.high * CONTAINER_WORDS;
+        if (container.isDense()) {
+            int count = qMin(CONTAINER_WORDS, wordCount - firstWord);
+            for (int w = 0; w < count; ++w) {
+                words[firstWord + w] = container.words.at(w);
+            }
+        } else {
+            int base = container.high << CONTAINER_BITS;
+            for (quint16 value : container.values) {
+                if (base + value < size) {
+                    result.set(base + value);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+FacetSelection::FacetSelection()
+    : values(FacetIndex::FacetCount)
+{
+}
+
+bool FacetSelection::isEmpty() const {
+    return std::all_of(values.cbegin(), values.cend(), [](const QSet<QString>& keys) { return keys.isEmpty(); });
+}
+
+bool FacetSelection::operator==(const FacetSelection& other) const {
+    return values == other.values;
+}
+
+FacetIndex::FacetIndex()
+    : facets(FacetCount)
+{
+}
+
+QString FacetIndex::facetName(Facet facet) {
+    switch (facet) {
+    case CategoryFacet: return "Category";
+    case PriceFacet: return "Price";
+    case StockFacet: return "Availability";
+    case RatingFacet: return "Rating";
+    case SellerFacet: return "Seller";
+    default: return QString();
+    }
+}
+
+void FacetIndex::build(const CatalogStore& store) {
+    int rowCount = store.size();
+
+    QVector<QVector<int>> categoryRows(store.categories().size());
+    QVector<QVector<int>> priceRows(PRICE_BUCKET_COUNT);
+    QVector<int> inStockRows;
+    QVector<int> outOfStockRows;
+    QMap<int, QVector<int>> sellerRows;  // Ordered by seller id
+
+    const quint16* category = store.categoryIds().constData();
+    const double* price = store.prices().constData();
+    const qint32* stock = store.stock().constData();
+    const qint32* seller = store.sellerIds().constData();
+    for (int row = 0; row < rowCount; ++row) {
+        categoryRows[category[row]].append(row);
+        priceRows[priceBucket(price[row])].append(row);
+        (stock[row] > 0 ? inStockRows : outOfStockRows).append(row);
+        sellerRows[seller[row]].append(row);
+    }
+
+    facets.fill(QVector<Value>(), FacetCount);
+    for (int id = 0; id < categoryRows.size(); ++id) {
+        QString name = store.categories().at(id);
+        facets[CategoryFacet].append(Value{name, name, CompressedBitmap::fromRows(categoryRows.at(id))});
+    }
+    for (int i = 0; i < PRICE_BUCKET_COUNT; ++i) {
+        facets[PriceFacet].append(Value{PRICE_BUCKETS[i].key, PRICE_BUCKETS[i].label,
+                                        CompressedBitmap::fromRows(priceRows.at(i))});
+    }
+    facets[StockFacet].append(Value{"in", "In stock", CompressedBitmap::fromRows(inStockRows)});
+    facets[StockFacet].append(Value{"out", "Out of stock", CompressedBitmap::fromRows(outOfStockRows)});
+    for (auto it = sellerRows.cbegin(); it != sellerRows.cend(); ++it) {
+        // Seller names are not in the store; the UI labels sellers by key
+        QString key = QString::number(it.key());
+        facets[SellerFacet].append(Value{key, key, CompressedBitmap::fromRows(it.value())});
+    }
+    rebuildRatings(store);
+}
+
+void FacetIndex::rebuildRatings(const CatalogStore& store) {
+    QVector<QVector<int>> ratingRows(5);
+    const float* rating = store.ratings().constData();
+    for (int row = 0; row < store.size(); ++row) {
+        ratingRows[ratingBucket(rating[row])].append(row);
+    }
+
+    facets[RatingFacet].clear();
+    for (int stars = 4; stars >= 1; --stars) {
+        QString label = stars == 4 ? QString("★ 4 - 5") : QString("★ %1 - %2").arg(stars).arg(stars + 1);
+        facets[RatingFacet].append(Value{QString::number(stars), label, CompressedBitmap::fromRows(ratingRows.at(stars))});
+    }
+    facets[RatingFacet].append(Value{"0", "No reviews", CompressedBitmap::fromRows(ratingRows.at(0))});
+}
+
+bool FacetIndex::facetRows(Facet facet, const QSet<QString>& keys, CompressedBitmap* rows) const {
+    if (keys.isEmpty()) {
+        return false;
+    }
+    *rows = CompressedBitmap();
+    for (const Value& value : facets.at(facet)) {
+        if (keys.contains(value.key)) {
+            *rows = *rows | value.rows;
+        }
+    }
+    return true;
+}
+
+SelectionBitmap FacetIndex::evaluate(const FacetSelection& selection, int rowCount) const {
+    bool constrained = false;
+    CompressedBitmap combined;
+    for (int facet = 0; facet < FacetCount; ++facet) {
+        CompressedBitmap rows;
+        if (!facetRows(static_cast<Facet>(facet), selection.values.at(facet), &rows)) {
+            continue;
+        }
+        combined = constrained ? (combined & rows) : rows;
+        constrained = true;
+    }
+    return constrained ? combined.toSelection(rowCount) : SelectionBitmap(rowCount, true);
+}
+
+FacetCounts FacetIndex::counts(const FacetSelection& selection, const SelectionBitmap& base) const {
+    QVector<CompressedBitmap> ticked(FacetCount);
+    QVector<bool> constrained(FacetCount, false);
+    for (int facet = 0; facet < FacetCount; ++facet) {
+        constrained[facet] = facetRows(static_cast<Facet>(facet), selection.values.at(facet), &ticked[facet]);
+    }
+
+    FacetCounts result(FacetCount);
+    for (int facet = 0; facet < FacetCount; ++facet) {
+        // Every facet except this one narrows the rows being counted
+        SelectionBitmap others = base;
+        bool othersConstrained = false;
+        CompressedBitmap otherRows;
+        for (int other = 0; other < FacetCount; ++other) {
+            if (other == facet || !constrained.at(other)) {
+                continue;
+            }
+            otherRows = othersConstrained ? (otherRows & ticked.at(other)) : ticked.at(other);
+            othersConstrained = true;
+        }
+        if (othersConstrained) {
+            others &= otherRows.toSelection(base.size());
+        }
+
+        for (const Value& value : facets.at(facet)) {
+            result[facet].append(FacetValueCount{value.key, value.label, value.rows.countWithin(others)});
+        }
+    }
+    return result;
+}
@@ -0,0 +1,114 @@
+#ifndef FACETINDEX_H
+#define FACETINDEX_H
+
+#include "selectionbitmap.h"
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class CatalogStore;
+
+// Set of catalog rows split into 65536-row containers. A container keeps a
+// sorted array of its rows while it has fewer than 4096 of them and switches
+// to a 1024-word bitmap above that, so sparse facet values such as a small
+// seller cost a few bytes per product and dense ones at most a bit each.
+class CompressedBitmap {
+public:
+    CompressedBitmap();
+
+    // rows must be ascending
+    static CompressedBitmap fromRows(const QVector<int>& rows);
+
+    int cardinality() const;
+    bool isEmpty() const;
+    bool contains(int row) const;
+
+    CompressedBitmap operator&(const CompressedBitmap& other) const;
+    CompressedBitmap operator|(const CompressedBitmap& other) const;
+
+    // Number of rows also set in selection, without building the intersection
+    int countWithin(const SelectionBitmap& selection) const;
+    SelectionBitmap toSelection(int size) const;
+
+private:
+    struct Container {
+        int high;                   // row >> 16
+        int cardinality;
+        QVector<quint16> values;    // Sorted low 16 bits while sparse
+        QVector<quint64> words;     // 1024 words once dense
+
+        Container() : high(0), cardinality(0) {}
+        bool isDense() const { return !words.isEmpty(); }
+    };
+
+    static void toDense(Container& container);
+    static void fitContainer(Container& container);
+    static Container intersect(const Container& a, const Container& b);
+    static Container unite(const Container& a, const Container& b);
+
+    QVector<Container> containers;  // Sorted by high
+};
+
+// Which values are ticked in each facet. Values within a facet are OR'ed,
+// facets are AND'ed, and a facet with nothing ticked does not filter.
+struct FacetSelection {
+    QVector<QSet<QString>> values;
+
+    FacetSelection();
+    bool isEmpty() const;
+    bool operator==(const FacetSelection& other) const;
+};
+
+struct FacetValueCount {
+    QString key;
+    QString label;
+    int count;
+};
+
+// Counts for every value of every facet, indexed like FacetIndex::Facet
+typedef QVector<QVector<FacetValueCount>> FacetCounts;
+
+// One compressed bitmap of catalog rows per facet value: category, price
+// bucket, stock, rating bucket and seller. Keys are stable across catalog
+// refreshes (category name, bucket name, seller id) so a selection survives
+// a rebuild.
+class FacetIndex {
+public:
+    enum Facet {
+        CategoryFacet,
+        PriceFacet,
+        StockFacet,
+        RatingFacet,
+        SellerFacet,
+        FacetCount
+    };
+
+    FacetIndex();
+
+    static QString facetName(Facet facet);
+
+    void build(const CatalogStore& store);
+    void rebuildRatings(const CatalogStore& store);
+
+    // Rows passing every facet of selection
+    SelectionBitmap evaluate(const FacetSelection& selection, int rowCount) const;
+
+    // For each value: how many rows of base it would leave if ticked, with
+    // the other facets' selections applied. A facet's own ticks do not
+    // shrink its counts, so alternatives stay visible.
+    FacetCounts counts(const FacetSelection& selection, const SelectionBitmap& base) const;
+
+private:
+    struct Value {
+        QString key;
+        QString label;
+        CompressedBitmap rows;
+    };
+
+    // Rows matching any ticked value of facet; false when nothing is ticked
+    bool facetRows(Facet facet, const QSet<QString>& keys, CompressedBitmap* rows) const;
+
+    QVector<QVector<Value>> facets;
+};
+
+#endif // FACETINDEX_H
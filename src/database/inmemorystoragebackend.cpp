@@ -0,0 +1,775 @@
+#include "inmemorystoragebackend.h"
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <QPromise>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+InMemoryStorageBackend::InMemoryStorageBackend()
+    : initialized(false)
+    , checkoutResult(CheckoutEngine::Committed)
+    , catalogVersion(1)
+    , nextUserId(1)
+    , nextProductId(1)
+    , nextCartId(1)
+    , nextOrderId(1)
+    , nextOrderItemId(1)
+    , nextReviewId(1)
+{
+}
+
+InMemoryStorageBackend& InMemoryStorageBackend::getInstance() {
+    static InMemoryStorageBackend instance;
+    return instance;
+}
+
+bool InMemoryStorageBackend::initialize() {
+    QMutexLocker locker(&mutex);
+    if (initialized) {
+        return true;
+    }
+    initialized = true;
+
+    // Same default admin as the SQLite schema
+    QString hashedPassword = QCryptographicHash::hash(
+        QString("admin123").toUtf8(),
+        QCryptographicHash::Sha256
+    ).toHex();
+    addUser(User("admin@marketplace.com", "admin", hashedPassword, true));
+
+    qDebug() << "In-memory storage initialized";
+    return true;
+}
+
+// Users
+
+bool InMemoryStorageBackend::addUser(const User& user) {
+    QMutexLocker locker(&mutex);
+    if (userIdByEmail.contains(user.getEmail()) || userIdByUsername.contains(user.getUsername())) {
+        qDebug() << "Error adding user: email or username already taken";
+        return false;
+    }
+
+    UserRecord record;
+    record.id = nextUserId++;
+    record.user = user;
+    users.insert(record.id, record);
+    userIdByEmail.insert(user.getEmail(), record.id);
+    userIdByUsername.insert(user.getUsername(), record.id);
+    return true;
+}
+
+User InMemoryStorageBackend::getUserByEmail(const QString& email) {
+    QMutexLocker locker(&mutex);
+    return users.value(userIdByEmail.value(email, -1)).user;
+}
+
+User InMemoryStorageBackend::getUserByUsername(const QString& username) {
+    QMutexLocker locker(&mutex);
+    return users.value(userIdByUsername.value(username, -1)).user;
+}
+
+User InMemoryStorageBackend::getUserById(int userId) {
+    QMutexLocker locker(&mutex);
+    return users.value(userId).user;
+}
+
+bool InMemoryStorageBackend::userExists(const QString& email, const QString& username) {
+    QMutexLocker locker(&mutex);
+    return userIdByEmail.contains(email) || userIdByUsername.contains(username);
+}
+
+int InMemoryStorageBackend::getUserIdByEmail(const QString& email) {
+    QMutexLocker locker(&mutex);
+    return userIdByEmail.value(email, -1);
+}
+
+QList<User> InMemoryStorageBackend::getAllUsers() {
+    QMutexLocker locker(&mutex);
+    QList<int> ids = users.keys();
+    std::sort(ids.begin(), ids.end());
+
+    QList<User> result;
+    for (int id : ids) {
+        result.append(users.value(id).user);
+    }
+    return result;
+}
+
+bool InMemoryStorageBackend::isUserAdmin(int userId) {
+    QMutexLocker locker(&mutex);
+    return users.contains(userId) && users.value(userId).user.isAdmin();
+}
+
+bool InMemoryStorageBackend::isUserSeller(const QString& email) {
+    QMutexLocker locker(&mutex);
+    return users.value(userIdByEmail.value(email, -1)).seller;
+}
+
+bool InMemoryStorageBackend::suspendUser(int userId) {
+    QMutexLocker locker(&mutex);
+    if (!users.contains(userId)) {
+        return false;
+    }
+    users[userId].user.setSuspended(true);
+    return true;
+}
+
+bool InMemoryStorageBackend::unsuspendUser(int userId) {
+    QMutexLocker locker(&mutex);
+    if (!users.contains(userId)) {
+        return false;
+    }
+    users[userId].user.setSuspended(false);
+    return true;
+}
+
+bool InMemoryStorageBackend::resetUserPassword(int userId, const QString& newHashedPassword) {
+    QMutexLocker locker(&mutex);
+    if (!users.contains(userId)) {
+        qDebug() << "Failed to reset password: User not found with ID:" << userId;
+        return false;
+    }
+    users[userId].user.setHashedPassword(newHashedPassword);
+    return true;
+}
+
+bool InMemoryStorageBackend::updateUserRole(int userId, bool isAdmin, bool isSeller) {
+    QMutexLocker locker(&mutex);
+    if (!users.contains(userId)) {
+        return false;
+    }
+    users[userId].user.setAdmin(isAdmin);
+    users[userId].seller = isSeller;
+    return true;
+}
+
+// Products
+
+bool InMemoryStorageBackend::addProduct(const Product& product) {
+    QMutexLocker locker(&mutex);
+    Product stored = product;
+    stored.id = nextProductId++;
+    products.insert(stored.id, stored);
+    productIdsBySeller.insert(stored.sellerId, stored.id);
+    catalogVersion++;
+    return true;
+}
+
+bool InMemoryStorageBackend::updateProductStock(int productId, int newStock) {
+    QMutexLocker locker(&mutex);
+    if (!products.contains(productId)) {
+        return false;
+    }
+    // Stock does not move the catalog version, as in the SQLite trigger
+    products[productId].stock = newStock;
+    return true;
+}
+
+bool InMemoryStorageBackend::decrementProductStock(int productId, int quantity) {
+    QMutexLocker locker(&mutex);
+    if (!products.contains(productId) || products.value(productId).stock < quantity) {
+        return false;
+    }
+    products[productId].stock -= quantity;
+    return true;
+}
+
+bool InMemoryStorageBackend::deleteProduct(int productId) {
+    QMutexLocker locker(&mutex);
+    if (!products.contains(productId)) {
+        return false;
+    }
+    productIdsBySeller.remove(products.value(productId).sellerId, productId);
+    products.remove(productId);
+    catalogVersion++;
+    return true;
+}
+
+Product InMemoryStorageBackend::getProductById(int productId) {
+    QMutexLocker locker(&mutex);
+    return products.value(productId);
+}
+
+QList<Product> InMemoryStorageBackend::getAllProducts() {
+    QMutexLocker locker(&mutex);
+    QList<Product> all = products.values();
+    for (Product& product : all) {
+        product.hasImageData = !product.imageData.isEmpty();
+        product.imageData.clear();
+    }
+    return all;
+}
+
+QList<Product> InMemoryStorageBackend::getProductsBySeller(int sellerId) {
+    QMutexLocker locker(&mutex);
+    QList<int> ids = productIdsBySeller.values(sellerId);
+    std::sort(ids.begin(), ids.end(), std::greater<int>());
+
+    QList<Product> result;
+    for (int id : ids) {
+        result.append(products.value(id));
+    }
+    return result;
+}
+
+QByteArray InMemoryStorageBackend::getProductImage(int productId) {
+    QMutexLocker locker(&mutex);
+    return products.value(productId).imageData;
+}
+
+QList<Product> InMemoryStorageBackend::getSellerProducts(const QString& sellerEmail, int offset, int limit, int* total) {
+    QMutexLocker locker(&mutex);
+    QList<Product> all = getProductsBySeller(userIdByEmail.value(sellerEmail, -1));
+    if (total) {
+        *total = all.size();
+    }
+
+    QList<Product> page = all.mid(offset, limit < 0 ? -1 : limit);
+    for (Product& product : page) {
+        product.hasImageData = !product.imageData.isEmpty();
+        product.imageData.clear();
+    }
+    return page;
+}
+
+qint64 InMemoryStorageBackend::getCatalogVersion() {
+    QMutexLocker locker(&mutex);
+    return catalogVersion;
+}
+
+// Cart
+
+bool InMemoryStorageBackend::addToCart(int userId, int productId, int quantity, int* cartItemId) {
+    QMutexLocker locker(&mutex);
+    if (!products.contains(productId)) {
+        qDebug() << "Failed to add to cart: Product not found with ID:" << productId;
+        return false;
+    }
+    const Product& product = products[productId];
+    if (product.stock < quantity) {
+        qDebug() << "Failed to add to cart: Insufficient stock. Available:" << product.stock << "Requested:" << quantity;
+        return false;
+    }
+
+    CartItem item;
+    item.id = nextCartId++;
+    item.userId = userId;
+    item.productId = productId;
+    item.quantity = quantity;
+    item.price = product.price;
+    cart.insert(item.id, item);
+    cartIdsByUser.insert(userId, item.id);
+    cartVersions[userId]++;
+    if (cartItemId) {
+        *cartItemId = item.id;
+    }
+    return true;
+}
+
+bool InMemoryStorageBackend::updateCartItemQuantity(int cartItemId, int quantity) {
+    QMutexLocker locker(&mutex);
+    if (!cart.contains(cartItemId)) {
+        return false;
+    }
+    cart[cartItemId].quantity = quantity;
+    cartVersions[cart.value(cartItemId).userId]++;
+    return true;
+}
+
+bool InMemoryStorageBackend::removeFromCart(int cartItemId) {
+    QMutexLocker locker(&mutex);
+    if (!cart.contains(cartItemId)) {
+        return false;
+    }
+    int userId = cart.value(cartItemId).userId;
+    cartIdsByUser.remove(userId, cartItemId);
+    cart.remove(cartItemId);
+    cartVersions[userId]++;
+    return true;
+}
+
+QList<CartItem> InMemoryStorageBackend::getCartItems(int userId) {
+    QMutexLocker locker(&mutex);
+    QList<int> ids = cartIdsByUser.values(userId);
+    std::sort(ids.begin(), ids.end());
+
+    QList<CartItem> items;
+    for (int id : ids) {
+        items.append(cart.value(id));
+    }
+    return items;
+}
+
+CartView InMemoryStorageBackend::getCartView(int userId) {
+    QMutexLocker locker(&mutex);
+    CartView view;
+    for (const CartItem& item : getCartItems(userId)) {
+        CartLine line = cartLine(item);
+        if (!line.productMissing) {
+            view.total += item.quantity * item.price;
+        }
+        view.lines.append(line);
+    }
+    return view;
+}
+
+CartLine InMemoryStorageBackend::cartLine(const CartItem& item) const {
+    CartLine line;
+    line.cartItemId = item.id;
+    line.productId = item.productId;
+    line.quantity = item.quantity;
+    line.price = item.price;
+    line.productMissing = !products.contains(item.productId);
+    if (!line.productMissing) {
+        const Product& product = products[item.productId];
+        line.productName = product.name;
+        line.currentPrice = product.price;
+        line.stock = product.stock;
+        line.imageUrl = product.imageUrl;
+        line.hasImageData = !product.imageData.isEmpty();
+    }
+    return line;
+}
+
+CartLine InMemoryStorageBackend::getCartLine(int cartItemId) {
+    QMutexLocker locker(&mutex);
+    auto it = cart.constFind(cartItemId);
+    return it != cart.constEnd() ? cartLine(it.value()) : CartLine();
+}
+
+qint64 InMemoryStorageBackend::getCartVersion(int userId) {
+    QMutexLocker locker(&mutex);
+    return cartVersions.value(userId, 0);
+}
+
+bool InMemoryStorageBackend::clearCart(int userId) {
+    QMutexLocker locker(&mutex);
+    for (int id : cartIdsByUser.values(userId)) {
+        cart.remove(id);
+    }
+    cartIdsByUser.remove(userId);
+    cartVersions[userId]++;
+    return true;
+}
+
+// Orders
+
+QFuture<int> InMemoryStorageBackend::createOrder(int userId, const QList<CartItem>& items) {
+    // Nothing here waits on a lock held by another process, so resolve at once
+    QPromise<int> promise;
+    promise.start();
+    promise.addResult(placeOrder(userId, items));
+    promise.finish();
+    return promise.future();
+}
+
+int InMemoryStorageBackend::placeOrder(int userId, const QList<CartItem>& items) {
+    QMutexLocker locker(&mutex);
+
+    // Check every line before touching stock so a failed checkout changes nothing
+    for (const CartItem& item : items) {
+        if (!products.contains(item.productId)) {
+            checkoutResult = CheckoutEngine::ProductNotFound;
+            return -1;
+        }
+        if (products.value(item.productId).stock < item.quantity) {
+            checkoutResult = CheckoutEngine::InsufficientStock;
+            return -1;
+        }
+    }
+
+    Order order;
+    order.id = nextOrderId++;
+    order.userId = userId;
+    order.orderDate = QDateTime::currentMSecsSinceEpoch();
+    order.status = "Pending";
+    for (const CartItem& item : items) {
+        Product& product = products[item.productId];
+        product.stock -= item.quantity;
+
+        OrderItem orderItem;
+        orderItem.id = nextOrderItemId++;
+        orderItem.orderId = order.id;
+        orderItem.productId = item.productId;
+        orderItem.productName = product.name;
+        orderItem.sellerId = product.sellerId;
+        orderItem.category = product.category;
+        orderItem.quantity = item.quantity;
+        orderItem.price = item.price;
+        order.items.append(orderItem);
+        order.totalAmount += item.price * item.quantity;
+    }
+    order.itemCount = order.items.size();
+
+    orders.insert(order.id, order);
+    ordersByUserDate.insert(UserDateKey(userId, order.orderDate), order.id);
+    clearCart(userId);
+
+    checkoutResult = CheckoutEngine::Committed;
+    return order.id;
+}
+
+CheckoutEngine::Result InMemoryStorageBackend::lastCheckoutResult() const {
+    QMutexLocker locker(&mutex);
+    return checkoutResult;
+}
+
+QList<int> InMemoryStorageBackend::userOrderIds(int userId, qint64 fromMs, qint64 toMs) const {
+    // The map is ordered by (user, date), so a user's range is one contiguous run
+    QList<int> ids;
+    auto it = ordersByUserDate.upperBound(UserDateKey(userId, toMs));
+    auto begin = ordersByUserDate.lowerBound(UserDateKey(userId, fromMs));
+    while (it != begin) {
+        --it;
+        ids.append(it.value());
+    }
+    return ids;
+}
+
+OrderSummary InMemoryStorageBackend::summarize(const Order& order) const {
+    OrderSummary summary;
+    summary.id = order.id;
+    summary.orderDate = order.orderDate;
+    summary.status = order.status;
+    summary.totalAmount = order.totalAmount;
+    summary.itemCount = order.items.size();
+    return summary;
+}
+
+QList<Order> InMemoryStorageBackend::getUserOrders(int userId) {
+    QMutexLocker locker(&mutex);
+    QList<Order> result;
+    for (int id : userOrderIds(userId, std::numeric_limits<qint64>::min(), std::numeric_limits<qint64>::max())) {
+        result.append(orders.value(id));
+    }
+    return result;
+}
+
+QList<Order> InMemoryStorageBackend::getUserOrdersByDateRange(int userId, const QDateTime& startDate, const QDateTime& endDate) {
+    QMutexLocker locker(&mutex);
+    QList<Order> result;
+    for (int id : userOrderIds(userId, startDate.toMSecsSinceEpoch(), endDate.toMSecsSinceEpoch())) {
+        Order order = orders.value(id);
+        order.items.clear();
+        result.append(order);
+    }
+    return result;
+}
+
+QList<Order> InMemoryStorageBackend::getUserOrdersByStatus(int userId, const QString& status) {
+    QMutexLocker locker(&mutex);
+    QList<Order> result;
+    for (int id : userOrderIds(userId, std::numeric_limits<qint64>::min(), std::numeric_limits<qint64>::max())) {
+        const Order& order = orders[id];
+        if (order.status == status) {
+            Order copy = order;
+            copy.items.clear();
+            result.append(copy);
+        }
+    }
+    return result;
+}
+
+QList<OrderSummary> InMemoryStorageBackend::getUserOrderSummaries(int userId, const QDateTime& from,
+                                                                  const QDateTime& to, const QString& status,
+                                                                  const OrderSummary& after, int limit) {
+    QMutexLocker locker(&mutex);
+    qint64 fromMs = from.isValid() ? from.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+    qint64 toMs = to.isValid() ? to.toMSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+    if (after.id != -1) {
+        toMs = qMin(toMs, after.orderDate);
+    }
+
+    QList<OrderSummary> result;
+    for (int id : userOrderIds(userId, fromMs, toMs)) {
+        const Order& order = orders[id];
+        // Keep collecting past the limit until the date changes, so every
+        // order sharing the last timestamp is there to be ordered by id
+        if (limit >= 0 && result.size() >= limit
+            && (result.isEmpty() || order.orderDate != result.last().orderDate)) {
+            break;
+        }
+        if (after.id != -1 && order.orderDate == after.orderDate && order.id >= after.id) {
+            continue;
+        }
+        if (status.isEmpty() || order.status == status) {
+            result.append(summarize(order));
+        }
+    }
+
+    std::stable_sort(result.begin(), result.end(), [](const OrderSummary& a, const OrderSummary& b) {
+        return a.orderDate != b.orderDate ? a.orderDate > b.orderDate : a.id > b.id;
+    });
+    if (limit >= 0 && result.size() > limit) {
+        result.erase(result.begin() + limit, result.end());
+    }
+    return result;
+}
+
+Order InMemoryStorageBackend::getOrderById(int orderId) {
+    QMutexLocker locker(&mutex);
+    return orders.value(orderId);
+}
+
+bool InMemoryStorageBackend::updateOrderStatus(int orderId, const QString& status) {
+    QMutexLocker locker(&mutex);
+    if (!orders.contains(orderId)) {
+        return false;
+    }
+    orders[orderId].status = status;
+    return true;
+}
+
+QList<Order> InMemoryStorageBackend::getSellerOrders(const QString& sellerEmail, int offset, int limit, int* total) {
+    QMutexLocker locker(&mutex);
+    if (total) {
+        *total = 0;
+    }
+    // An unknown seller would otherwise match the -1 of deleted products
+    auto seller = userIdByEmail.constFind(sellerEmail);
+    if (seller == userIdByEmail.constEnd()) {
+        return QList<Order>();
+    }
+    int sellerId = seller.value();
+
+    QList<Order> matches;
+    for (const Order& order : orders) {
+        Order sellerOrder = order;
+        sellerOrder.items.clear();
+        sellerOrder.totalAmount = 0.0;
+        sellerOrder.itemCount = 0;
+        for (const OrderItem& item : order.items) {
+            if (products.value(item.productId).sellerId == sellerId) {
+                sellerOrder.itemCount += item.quantity;
+                sellerOrder.totalAmount += item.quantity * item.price;
+            }
+        }
+        if (sellerOrder.itemCount > 0) {
+            sellerOrder.customerEmail = users.value(order.userId).user.getEmail();
+            matches.append(sellerOrder);
+        }
+    }
+
+    std::sort(matches.begin(), matches.end(), [](const Order& a, const Order& b) {
+        return a.orderDate != b.orderDate ? a.orderDate > b.orderDate : a.id > b.id;
+    });
+    if (total) {
+        *total = matches.size();
+    }
+    return matches.mid(offset, limit < 0 ? -1 : limit);
+}
+
+// Reviews
+
+bool InMemoryStorageBackend::addReview(const Review& review) {
+    QMutexLocker locker(&mutex);
+    Review stored = review;
+    stored.id = nextReviewId++;
+    reviews.insert(stored.id, stored);
+    reviewIdsByProduct.insert(stored.productId, stored.id);
+    return true;
+}
+
+bool InMemoryStorageBackend::updateReview(const Review& review) {
+    QMutexLocker locker(&mutex);
+    if (!reviews.contains(review.id)) {
+        return false;
+    }
+    reviews[review.id].rating = review.rating;
+    reviews[review.id].comment = review.comment;
+    return true;
+}
+
+bool InMemoryStorageBackend::deleteReview(int reviewId) {
+    QMutexLocker locker(&mutex);
+    if (!reviews.contains(reviewId)) {
+        return false;
+    }
+    reviewIdsByProduct.remove(reviews.value(reviewId).productId, reviewId);
+    reviews.remove(reviewId);
+    return true;
+}
+
+Review InMemoryStorageBackend::getReviewById(int reviewId) {
+    QMutexLocker locker(&mutex);
+    return reviews.value(reviewId);
+}
+
+QList<Review> InMemoryStorageBackend::getProductReviews(int productId) {
+    QMutexLocker locker(&mutex);
+    QList<Review> result;
+    for (int id : reviewIdsByProduct.values(productId)) {
+        result.append(reviews.value(id));
+    }
+    std::sort(result.begin(), result.end(), [](const Review& a, const Review& b) {
+        return a.reviewDate > b.reviewDate;
+    });
+    return result;
+}
+
+Review InMemoryStorageBackend::getUserProductReview(int userId, int productId) {
+    QMutexLocker locker(&mutex);
+    for (int id : reviewIdsByProduct.values(productId)) {
+        const Review& review = reviews[id];
+        if (review.userId == userId) {
+            return review;
+        }
+    }
+    return Review();
+}
+
+double InMemoryStorageBackend::getProductAverageRating(int productId) {
+    QMutexLocker locker(&mutex);
+    QList<int> ids = reviewIdsByProduct.values(productId);
+    if (ids.isEmpty()) {
+        return 0.0;
+    }
+
+    double sum = 0.0;
+    for (int id : ids) {
+        sum += reviews.value(id).rating;
+    }
+    return sum / ids.size();
+}
+
+bool InMemoryStorageBackend::hasUserPurchasedProduct(int userId, int productId) {
+    QMutexLocker locker(&mutex);
+    for (int id : userOrderIds(userId, std::numeric_limits<qint64>::min(), std::numeric_limits<qint64>::max())) {
+        const Order& order = orders[id];
+        if (order.status != "Delivered" && order.status != "Shipped") {
+            continue;
+        }
+        for (const OrderItem& item : order.items) {
+            if (item.productId == productId) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+QHash<int, RatingSummary> InMemoryStorageBackend::getRatingSummaries() {
+    QMutexLocker locker(&mutex);
+    QHash<int, RatingSummary> summaries;
+    for (const Review& review : reviews) {
+        RatingSummary& summary = summaries[review.productId];
+        summary.average += review.rating;  // Sum until divided below
+        summary.count++;
+    }
+    for (RatingSummary& summary : summaries) {
+        summary.average /= summary.count;
+    }
+    return summaries;
+}
+
+QHash<int, QString> InMemoryStorageBackend::getSellerNames() {
+    QMutexLocker locker(&mutex);
+    QHash<int, QString> names;
+    for (int sellerId : productIdsBySeller.uniqueKeys()) {
+        if (users.contains(sellerId)) {
+            names.insert(sellerId, users.value(sellerId).user.getUsername());
+        }
+    }
+    return names;
+}
+
+// Sales reports
+
+double InMemoryStorageBackend::getTotalSales() {
+    return getSalesSummary().totalSales;
+}
+
+int InMemoryStorageBackend::getTotalOrders() {
+    return getSalesSummary().totalOrders;
+}
+
+double InMemoryStorageBackend::getAverageOrderValue() {
+    return getSalesSummary().averageOrderValue;
+}
+
+SalesSummary InMemoryStorageBackend::getSalesSummary() {
+    QMutexLocker locker(&mutex);
+    SalesSummary summary;
+    for (const Order& order : orders) {
+        summary.totalSales += order.totalAmount;
+    }
+    summary.totalOrders = orders.size();
+    summary.averageOrderValue = orders.isEmpty() ? 0.0 : summary.totalSales / orders.size();
+    return summary;
+}
+
+QList<SalesRollupRow> InMemoryStorageBackend::getSalesRollup(RollupGranularity granularity, const QDateTime& from,
+                                                             const QDateTime& to, int sellerId) {
+    QMutexLocker locker(&mutex);
+    QString fromKey = SalesRollup::bucketKey(granularity, from);
+    QString toKey = SalesRollup::bucketKey(granularity, to);
+
+    // Aggregated on demand; ordered by (bucket, seller, category) like the table
+    QMap<QString, SalesRollupRow> rows;
+    for (const Order& order : orders) {
+        if (SalesRollup::statusWeight(order.status) == 0) {
+            continue;
+        }
+        QString bucket = SalesRollup::bucketKey(granularity, order.orderDateTime());
+        if (bucket < fromKey || bucket > toKey) {
+            continue;
+        }
+
+        QSet<QString> counted;
+        for (const OrderItem& item : order.items) {
+            // Seller and category as recorded at checkout, like the SQL rollup
+            if (item.sellerId == -1 || (sellerId != -1 && item.sellerId != sellerId)) {
+                continue;
+            }
+            QString key = QString("%1|%2|%3").arg(bucket).arg(item.sellerId, 10, 10, QChar('0')).arg(item.category);
+            SalesRollupRow& row = rows[key];
+            row.bucket = bucket;
+            row.sellerId = item.sellerId;
+            row.category = item.category;
+            row.revenue += item.quantity * item.price;
+            row.units += item.quantity;
+            if (!counted.contains(key)) {
+                counted.insert(key);
+                row.orderCount++;
+            }
+        }
+    }
+    return rows.values();
+}
+
+// Sessions
+
+bool InMemoryStorageBackend::saveSession(const StoredSession& session) {
+    QMutexLocker locker(&mutex);
+    sessions.insert(session.tokenHash, session);
+    return true;
+}
+
+bool InMemoryStorageBackend::deleteSession(const QByteArray& tokenHash) {
+    QMutexLocker locker(&mutex);
+    return sessions.remove(tokenHash) > 0;
+}
+
+int InMemoryStorageBackend::deleteExpiredSessions(qint64 nowMs) {
+    QMutexLocker locker(&mutex);
+    int removed = 0;
+    for (auto it = sessions.begin(); it != sessions.end();) {
+        if (it->expiresAt <= nowMs) {
+            it = sessions.erase(it);
+            removed++;
+        } else {
+            ++it;
+        }
+    }
+    return removed;
+}
+
+StoredSession InMemoryStorageBackend::getSession(const QByteArray& tokenHash, qint64 nowMs) {
+    QMutexLocker locker(&mutex);
+    StoredSession session = sessions.value(tokenHash);
+    return session.expiresAt > nowMs ? session : StoredSession();
+}
@@ -0,0 +1,152 @@
+#ifndef INMEMORYSTORAGEBACKEND_H
+#define INMEMORYSTORAGEBACKEND_H
+
+#include "storagebackend.h"
+#include <QHash>
+#include <QMap>
+#include <QMultiHash>
+#include <QMultiMap>
+#include <QPair>
+#include <QRecursiveMutex>
+
+// Storage held entirely in memory: hash maps keyed by id plus ordered indexes
+// for the range and "newest first" queries. Nothing is persisted; start the
+// app with --storage=memory to benchmark pages or run load tests without disk.
+class InMemoryStorageBackend : public StorageBackend {
+public:
+    static InMemoryStorageBackend& getInstance();
+
+    bool initialize() override;
+
+    // Users
+    bool addUser(const User& user) override;
+    User getUserByEmail(const QString& email) override;
+    User getUserByUsername(const QString& username) override;
+    User getUserById(int userId) override;
+    bool userExists(const QString& email, const QString& username) override;
+    int getUserIdByEmail(const QString& email) override;
+    QList<User> getAllUsers() override;
+    bool isUserAdmin(int userId) override;
+    bool isUserSeller(const QString& email) override;
+    bool suspendUser(int userId) override;
+    bool unsuspendUser(int userId) override;
+    bool resetUserPassword(int userId, const QString& newHashedPassword) override;
+    bool updateUserRole(int userId, bool isAdmin, bool isSeller) override;
+
+    // Products
+    bool addProduct(const Product& product) override;
+    bool updateProductStock(int productId, int newStock) override;
+    bool decrementProductStock(int productId, int quantity) override;
+    bool deleteProduct(int productId) override;
+    Product getProductById(int productId) override;
+    QList<Product> getAllProducts() override;
+    QList<Product> getProductsBySeller(int sellerId) override;
+    QByteArray getProductImage(int productId) override;
+    qint64 getCatalogVersion() override;
+    QList<Product> getSellerProducts(const QString& sellerEmail, int offset = 0, int limit = 50,
+                                     int* total = nullptr) override;
+
+    // Cart
+    bool addToCart(int userId, int productId, int quantity, int* cartItemId = nullptr) override;
+    bool updateCartItemQuantity(int cartItemId, int quantity) override;
+    bool removeFromCart(int cartItemId) override;
+    QList<CartItem> getCartItems(int userId) override;
+    CartView getCartView(int userId) override;
+    CartLine getCartLine(int cartItemId) override;
+    qint64 getCartVersion(int userId) override;
+    bool clearCart(int userId) override;
+
+    // Orders
+    QFuture<int> createOrder(int userId, const QList<CartItem>& items) override;
+    CheckoutEngine::Result lastCheckoutResult() const override;
+    QList<Order> getUserOrders(int userId) override;
+    QList<Order> getUserOrdersByDateRange(int userId, const QDateTime& startDate, const QDateTime& endDate) override;
+    QList<Order> getUserOrdersByStatus(int userId, const QString& status) override;
+    QList<OrderSummary> getUserOrderSummaries(int userId, const QDateTime& from = QDateTime(),
+                                              const QDateTime& to = QDateTime(),
+                                              const QString& status = QString(),
+                                              const OrderSummary& after = OrderSummary(),
+                                              int limit = -1) override;
+    Order getOrderById(int orderId) override;
+    bool updateOrderStatus(int orderId, const QString& status) override;
+    QList<Order> getSellerOrders(const QString& sellerEmail, int offset = 0, int limit = 50,
+                                 int* total = nullptr) override;
+
+    // Reviews
+    bool addReview(const Review& review) override;
+    bool updateReview(const Review& review) override;
+    bool deleteReview(int reviewId) override;
+    Review getReviewById(int reviewId) override;
+    QList<Review> getProductReviews(int productId) override;
+    Review getUserProductReview(int userId, int productId) override;
+    double getProductAverageRating(int productId) override;
+    bool hasUserPurchasedProduct(int userId, int productId) override;
+    QHash<int, RatingSummary> getRatingSummaries() override;
+    QHash<int, QString> getSellerNames() override;
+
+    // Sales reports
+    double getTotalSales() override;
+    int getTotalOrders() override;
+    double getAverageOrderValue() override;
+    SalesSummary getSalesSummary() override;
+    QList<SalesRollupRow> getSalesRollup(RollupGranularity granularity, const QDateTime& from,
+                                         const QDateTime& to, int sellerId = -1) override;
+
+    // Sessions
+    bool saveSession(const StoredSession& session) override;
+    bool deleteSession(const QByteArray& tokenHash) override;
+    int deleteExpiredSessions(qint64 nowMs) override;
+    StoredSession getSession(const QByteArray& tokenHash, qint64 nowMs) override;
+
+private:
+    InMemoryStorageBackend();
+
+    struct UserRecord {
+        int id;
+        User user;
+        bool seller;
+
+        UserRecord() : id(-1), seller(false) {}
+    };
+
+    typedef QPair<int, qint64> UserDateKey;  // (user id, order date)
+
+    // Newest first over the user's slice of ordersByUserDate
+    QList<int> userOrderIds(int userId, qint64 fromMs, qint64 toMs) const;
+    OrderSummary summarize(const Order& order) const;
+    CartLine cartLine(const CartItem& item) const;
+    int placeOrder(int userId, const QList<CartItem>& items);
+
+    mutable QRecursiveMutex mutex;
+    bool initialized;
+    CheckoutEngine::Result checkoutResult;
+    qint64 catalogVersion;
+
+    QHash<int, UserRecord> users;
+    QHash<QString, int> userIdByEmail;
+    QHash<QString, int> userIdByUsername;
+
+    QMap<int, Product> products;                // Ordered by id
+    QMultiHash<int, int> productIdsBySeller;
+
+    QMap<int, CartItem> cart;                   // Ordered by id, i.e. insertion
+    QMultiHash<int, int> cartIdsByUser;
+    QHash<int, qint64> cartVersions;          // By user id
+
+    QHash<int, Order> orders;                   // Items are kept inside each order
+    QMultiMap<UserDateKey, int> ordersByUserDate;
+
+    QHash<int, Review> reviews;
+    QMultiHash<int, int> reviewIdsByProduct;
+
+    QHash<QByteArray, StoredSession> sessions;
+
+    int nextUserId;
+    int nextProductId;
+    int nextCartId;
+    int nextOrderId;
+    int nextOrderItemId;
+    int nextReviewId;
+};
+
+#endif // INMEMORYSTORAGEBACKEND_H
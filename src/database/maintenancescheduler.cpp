@@ -0,0 +1,266 @@
+#include "maintenancescheduler.h"
+#include "orderarchiver.h"
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QEvent>
+#include <QDebug>
+
+namespace {
+const qint64 MINUTE_MS = 60 * 1000;
+const qint64 HOUR_MS = 60 * MINUTE_MS;
+}
+
+MaintenanceScheduler::MaintenanceScheduler(QObject *parent)
+    : QObject(parent)
+    , archiver(nullptr)
+    , nextTask(0)
+{
+    connect(&timer, &QTimer::timeout, this, &MaintenanceScheduler::tick);
+    sinceInput.start();
+}
+
+void MaintenanceScheduler::setDatabase(const QSqlDatabase& database) {
+    db = database;
+}
+
+void MaintenanceScheduler::setArchiver(OrderArchiver* orderArchiver) {
+    archiver = orderArchiver;
+}
+
+void MaintenanceScheduler::setConfig(const MaintenanceConfig& newConfig) {
+    config = newConfig;
+    if (timer.isActive()) {
+        timer.start(config.checkIntervalMs);
+    }
+}
+
+MaintenanceConfig MaintenanceScheduler::getConfig() const {
+    return config;
+}
+
+QString MaintenanceScheduler::taskName(Task task) {
+    switch (task) {
+    case Checkpoint: return "wal_checkpoint";
+    case ArchiveOrders: return "archive_orders";
+    case IncrementalVacuum: return "incremental_vacuum";
+    case Optimize: return "optimize";
+    case Analyze: return "analyze";
+    default: return "unknown";
+    }
+}
+
+qint64 MaintenanceScheduler::taskIntervalMs(Task task) const {
+    switch (task) {
+    case Checkpoint: return 5 * MINUTE_MS;
+    case ArchiveOrders: return 10 * MINUTE_MS;
+    case IncrementalVacuum: return HOUR_MS;
+    case Optimize: return 6 * HOUR_MS;
+    case Analyze: return 24 * HOUR_MS;
+    default: return 24 * HOUR_MS;
+    }
+}
+
+bool MaintenanceScheduler::createLogTable() {
+    QSqlQuery query(db);
+    if (!query.exec("CREATE TABLE IF NOT EXISTS maintenance_log ("
+                    "    id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                    "    task TEXT NOT NULL,"
+                    "    started_at INTEGER NOT NULL,"
+                    "    duration_ms INTEGER NOT NULL,"
+                    "    success INTEGER NOT NULL,"
+                    "    detail TEXT"
+                    ")")) {
+        qDebug() << "Error creating maintenance_log table:" << query.lastError().text();
+        return false;
+    }
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_maintenance_log_task ON maintenance_log (task, started_at)")) {
+        qDebug() << "Error creating maintenance_log index:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+void MaintenanceScheduler::loadLastRuns() {
+    // Intervals carry over restarts, so a quick relaunch does not redo ANALYZE
+    QSqlQuery query(db);
+    if (!query.exec("SELECT task, MAX(started_at) FROM maintenance_log WHERE success = 1 GROUP BY task")) {
+        qDebug() << "Error reading maintenance_log:" << query.lastError().text();
+        return;
+    }
+    while (query.next()) {
+        QString name = query.value(0).toString();
+        for (int task = 0; task < TaskCount; ++task) {
+            if (taskName(static_cast<Task>(task)) == name) {
+                lastRun[task] = query.value(1).toLongLong();
+            }
+        }
+    }
+}
+
+void MaintenanceScheduler::start() {
+    loadLastRuns();
+    if (QCoreApplication::instance()) {
+        QCoreApplication::instance()->installEventFilter(this);
+    }
+    timer.start(config.checkIntervalMs);
+}
+
+void MaintenanceScheduler::stop() {
+    timer.stop();
+    if (QCoreApplication::instance()) {
+        QCoreApplication::instance()->removeEventFilter(this);
+    }
+}
+
+bool MaintenanceScheduler::eventFilter(QObject* watched, QEvent* event) {
+    switch (event->type()) {
+    case QEvent::KeyPress:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+    case QEvent::TouchBegin:
+        sinceInput.restart();
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+bool MaintenanceScheduler::isDue(Task task) const {
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    return now - lastRun.value(task, 0) >= taskIntervalMs(task);
+}
+
+void MaintenanceScheduler::tick() {
+    if (sinceInput.elapsed() < config.idleThresholdMs) {
+        return;
+    }
+
+    // Round-robin so one busy task cannot starve the others
+    for (int i = 0; i < TaskCount; ++i) {
+        Task task = static_cast<Task>((nextTask + i) % TaskCount);
+        if (isDue(task)) {
+            nextTask = (task + 1) % TaskCount;
+            runTask(task);
+            return;
+        }
+    }
+}
+
+bool MaintenanceScheduler::runTask(Task task) {
+    QString detail;
+    qint64 startedAt = QDateTime::currentMSecsSinceEpoch();
+    QElapsedTimer duration;
+    duration.start();
+
+    bool success = execute(task, detail);
+
+    qint64 elapsed = duration.elapsed();
+    lastRun[task] = startedAt;
+    record(task, startedAt, elapsed, success, detail);
+    qDebug() << "Maintenance" << taskName(task) << (success ? "done" : "failed")
+             << "in" << elapsed << "ms" << detail;
+    return success;
+}
+
+bool MaintenanceScheduler::execute(Task task, QString& detail) {
+    QSqlQuery query(db);
+    switch (task) {
+    case Checkpoint:
+        // PASSIVE copies what it can without waiting on readers or writers
+        if (!query.exec("PRAGMA wal_checkpoint(PASSIVE)") || !query.next()) {
+            break;
+        }
+        detail = QString("busy=%1 log=%2 checkpointed=%3")
+            .arg(query.value(0).toInt()).arg(query.value(1).toInt()).arg(query.value(2).toInt());
+        return true;
+
+    case ArchiveOrders: {
+        if (!archiver || !archiver->isAttached()) {
+            detail = "archive not attached";
+            return true;
+        }
+        int moved = archiver->archiveBatch();
+        detail = QString("moved=%1").arg(moved);
+        return moved >= 0;
+    }
+
+    case IncrementalVacuum: {
+        // Files created before auto_vacuum was set stay at NONE, where
+        // incremental_vacuum does nothing
+        if (!query.exec("PRAGMA auto_vacuum") || !query.next()) {
+            break;
+        }
+        int autoVacuum = query.value(0).toInt();
+        if (autoVacuum != 2) {
+            detail = QString("skipped, auto_vacuum=%1 is not INCREMENTAL").arg(autoVacuum);
+            return true;
+        }
+
+        if (!query.exec("PRAGMA freelist_count") || !query.next()) {
+            break;
+        }
+        int freeBefore = query.value(0).toInt();
+        if (freeBefore > 0) {
+            if (!query.exec(QString("PRAGMA incremental_vacuum(%1)").arg(config.vacuumPagesPerRun))) {
+                break;
+            }
+            while (query.next()) {
+                // incremental_vacuum frees pages as its rows are stepped
+            }
+        }
+        if (!query.exec("PRAGMA freelist_count") || !query.next()) {
+            break;
+        }
+        int freeAfter = query.value(0).toInt();
+        detail = QString("free_pages=%1 released=%2").arg(freeBefore).arg(freeBefore - freeAfter);
+        return true;
+    }
+
+    case Optimize:
+        if (!query.exec(QString("PRAGMA analysis_limit = %1").arg(config.analysisLimit))
+            || !query.exec("PRAGMA optimize")) {
+            break;
+        }
+        return true;
+
+    case Analyze:
+        // analysis_limit samples each index instead of reading all of it
+        if (!query.exec(QString("PRAGMA analysis_limit = %1").arg(config.analysisLimit))
+            || !query.exec("ANALYZE main")) {
+            break;
+        }
+        detail = QString("analysis_limit=%1").arg(config.analysisLimit);
+        return true;
+
+    default:
+        detail = "unknown task";
+        return false;
+    }
+
+    detail = query.lastError().text();
+    return false;
+}
+
+void MaintenanceScheduler::record(Task task, qint64 startedAt, qint64 durationMs,
+                                  bool success, const QString& detail) {
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO maintenance_log (task, started_at, duration_ms, success, detail) "
+                  "VALUES (?, ?, ?, ?, ?)");
+    query.addBindValue(taskName(task));
+    query.addBindValue(startedAt);
+    query.addBindValue(durationMs);
+    query.addBindValue(success);
+    query.addBindValue(detail);
+    if (!query.exec()) {
+        qDebug() << "Error writing maintenance_log:" << query.lastError().text();
+        return;
+    }
+
+    query.prepare("DELETE FROM maintenance_log WHERE id <= (SELECT MAX(id) FROM maintenance_log) - ?");
+    query.addBindValue(config.logRetention);
+    query.exec();
+}
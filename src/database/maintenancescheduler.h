@@ -0,0 +1,80 @@
+#ifndef MAINTENANCESCHEDULER_H
+#define MAINTENANCESCHEDULER_H
+
+#include <QtSql/QSqlDatabase>
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+#include <QTimer>
+
+class OrderArchiver;
+
+struct MaintenanceConfig {
+    int checkIntervalMs;     // How often the scheduler looks for idle time
+    int idleThresholdMs;     // No input for this long counts as idle
+    int analysisLimit;       // Rows ANALYZE samples per index
+    int vacuumPagesPerRun;   // Free pages returned per incremental_vacuum
+    int logRetention;        // Rows kept in maintenance_log
+
+    MaintenanceConfig()
+        : checkIntervalMs(5000), idleThresholdMs(30000), analysisLimit(400)
+        , vacuumPagesPerRun(256), logRetention(1000) {}
+};
+
+// Runs database housekeeping while the user is not interacting with the app:
+// ANALYZE, PRAGMA optimize, incremental vacuum, passive WAL checkpoints and
+// order archival. One small task runs per idle tick, so a click never waits
+// behind more than one slice. Every run is recorded in maintenance_log.
+class MaintenanceScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    enum Task {
+        Checkpoint,
+        ArchiveOrders,
+        IncrementalVacuum,
+        Optimize,
+        Analyze,
+        TaskCount
+    };
+
+    explicit MaintenanceScheduler(QObject *parent = nullptr);
+
+    void setDatabase(const QSqlDatabase& database);
+    void setArchiver(OrderArchiver* archiver);
+    void setConfig(const MaintenanceConfig& config);
+    MaintenanceConfig getConfig() const;
+
+    bool createLogTable();
+    void start();
+    void stop();
+
+    // Runs a task immediately, idle or not; returns whether it succeeded
+    bool runTask(Task task);
+
+    static QString taskName(Task task);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private slots:
+    void tick();
+
+private:
+    qint64 taskIntervalMs(Task task) const;
+    bool isDue(Task task) const;
+    bool execute(Task task, QString& detail);
+    void record(Task task, qint64 startedAt, qint64 durationMs, bool success, const QString& detail);
+    void loadLastRuns();
+
+    QSqlDatabase db;
+    OrderArchiver* archiver;
+    MaintenanceConfig config;
+    QTimer timer;
+    QElapsedTimer sinceInput;
+    QHash<int, qint64> lastRun;  // Task -> epoch ms of last run
+    int nextTask;
+};
+
+#endif // MAINTENANCESCHEDULER_H
@@ -0,0 +1,194 @@
+#include "orderarchiver.h"
+#include "checkoutengine.h"
+#include "salesrollup.h"
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QDateTime>
+#include <QDebug>
+
+OrderArchiver::OrderArchiver(QObject *parent)
+    : QObject(parent)
+    , attached(false)
+{
+}
+
+void OrderArchiver::setDatabase(const QSqlDatabase& database) {
+    db = database;
+}
+
+void OrderArchiver::setConfig(const ArchiveConfig& newConfig) {
+    config = newConfig;
+}
+
+ArchiveConfig OrderArchiver::getConfig() const {
+    return config;
+}
+
+bool OrderArchiver::isAttached() const {
+    return attached;
+}
+
+bool OrderArchiver::attach() {
+    if (!attached && !config.archivePath.isEmpty()) {
+        QSqlQuery query(db);
+        query.prepare("ATTACH DATABASE ? AS archive");
+        query.addBindValue(config.archivePath);
+        if (query.exec()) {
+            attached = true;
+            query.exec("PRAGMA archive.journal_mode = WAL");
+            if (!createArchiveTables()) {
+                query.exec("DETACH DATABASE archive");
+                attached = false;
+            }
+        } else {
+            qDebug() << "Error attaching order archive:" << query.lastError().text();
+        }
+    }
+
+    if (!createViews(attached)) {
+        return false;
+    }
+    if (attached) {
+        qDebug() << "Order archive attached at:" << config.archivePath;
+    }
+    return attached;
+}
+
+bool OrderArchiver::createArchiveTables() {
+    // Ids are copied from main, where AUTOINCREMENT guarantees they are never reused
+    const char* statements[] = {
+        "CREATE TABLE IF NOT EXISTS archive.orders ("
+        "    id INTEGER PRIMARY KEY,"
+        "    user_id INTEGER NOT NULL,"
+        "    order_date INTEGER NOT NULL,"
+        "    status TEXT NOT NULL,"
+        "    total_amount REAL NOT NULL"
+        ")",
+        "CREATE TABLE IF NOT EXISTS archive.order_items ("
+        "    id INTEGER PRIMARY KEY,"
+        "    order_id INTEGER NOT NULL,"
+        "    product_id INTEGER NOT NULL,"
+        "    product_name TEXT,"
+        "    seller_id INTEGER,"
+        "    category TEXT,"
+        "    quantity INTEGER NOT NULL,"
+        "    price REAL NOT NULL"
+        ")",
+        "CREATE INDEX IF NOT EXISTS archive.idx_orders_user_date ON orders (user_id, order_date)",
+        "CREATE INDEX IF NOT EXISTS archive.idx_order_items_order ON order_items (order_id)",
+        "CREATE INDEX IF NOT EXISTS archive.idx_order_items_product ON order_items (product_id)"
+    };
+
+    QSqlQuery query(db);
+    for (const char* statement : statements) {
+        if (!query.exec(statement)) {
+            qDebug() << "Error creating archive tables:" << query.lastError().text();
+            return false;
+        }
+    }
+    // Archives written before items carried their seller need the columns too
+    return SalesRollup::migrateOrderItems(db, "archive");
+}
+
+QStringList OrderArchiver::viewStatements(bool withArchive) {
+    QString orderColumns = "id, user_id, order_date, status, total_amount";
+    QString itemColumns = "id, order_id, product_id, product_name, seller_id, category, quantity, price";
+
+    QString ordersView = QString("SELECT %1 FROM main.orders").arg(orderColumns);
+    QString itemsView = QString("SELECT %1 FROM main.order_items").arg(itemColumns);
+    if (withArchive) {
+        // In WAL mode a batch commits atomically per file, not across both,
+        // so a crash mid-commit can leave an order in each; main's copy wins
+        ordersView += QString(" UNION ALL SELECT %1 FROM archive.orders a "
+                              "WHERE NOT EXISTS (SELECT 1 FROM main.orders m WHERE m.id = a.id)")
+                          .arg(orderColumns);
+        itemsView += QString(" UNION ALL SELECT %1 FROM archive.order_items a "
+                             "WHERE NOT EXISTS (SELECT 1 FROM main.orders m WHERE m.id = a.order_id)")
+                         .arg(itemColumns);
+    }
+
+    return {
+        "DROP VIEW IF EXISTS temp.all_orders",
+        "DROP VIEW IF EXISTS temp.all_order_items",
+        "CREATE TEMP VIEW all_orders AS " + ordersView,
+        "CREATE TEMP VIEW all_order_items AS " + itemsView
+    };
+}
+
+bool OrderArchiver::createViews(bool withArchive) {
+    QSqlQuery query(db);
+    for (const QString& statement : viewStatements(withArchive)) {
+        if (!query.exec(statement)) {
+            qDebug() << "Error creating order views:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+QStringList OrderArchiver::connectionSetup() const {
+    QStringList statements;
+    if (attached) {
+        QString path = config.archivePath;
+        path.replace("'", "''");
+        statements << QString("ATTACH DATABASE '%1' AS archive").arg(path);
+    }
+    statements << viewStatements(attached);
+    return statements;
+}
+
+int OrderArchiver::archiveBatch() {
+    if (!attached) {
+        return 0;
+    }
+
+    qint64 cutoff = QDateTime::currentDateTime().addDays(-config.minAgeDays).toMSecsSinceEpoch();
+
+    QSqlQuery query(db);
+    if (!query.exec("BEGIN IMMEDIATE")) {
+        // Someone else is writing; try again on the next run
+        if (!CheckoutEngine::isBusyError(query.lastError())) {
+            qDebug() << "Error starting archive batch:" << query.lastError().text();
+            return -1;
+        }
+        return 0;
+    }
+
+    bool ok = query.exec("CREATE TEMP TABLE IF NOT EXISTS archive_batch (id INTEGER PRIMARY KEY)")
+        && query.exec("DELETE FROM temp.archive_batch");
+    if (ok) {
+        query.prepare("INSERT INTO temp.archive_batch (id) "
+                      "SELECT id FROM main.orders "
+                      "WHERE status IN ('Delivered', 'Cancelled') AND order_date < ? "
+                      "ORDER BY order_date LIMIT ?");
+        query.addBindValue(cutoff);
+        query.addBindValue(config.batchSize);
+        ok = query.exec();
+    }
+    int moved = ok ? query.numRowsAffected() : 0;
+
+    // WAL does not make a commit spanning two files atomic, so the copies use
+    // OR REPLACE: a batch cut short after the archive commit just repeats.
+    if (ok && moved > 0) {
+        ok = query.exec("INSERT OR REPLACE INTO archive.orders (id, user_id, order_date, status, total_amount) "
+                        "SELECT id, user_id, order_date, status, total_amount FROM main.orders "
+                        "WHERE id IN (SELECT id FROM temp.archive_batch)")
+            && query.exec("INSERT OR REPLACE INTO archive.order_items "
+                          "(id, order_id, product_id, product_name, seller_id, category, quantity, price) "
+                          "SELECT id, order_id, product_id, product_name, seller_id, category, quantity, price "
+                          "FROM main.order_items "
+                          "WHERE order_id IN (SELECT id FROM temp.archive_batch)")
+            && query.exec("DELETE FROM main.order_items WHERE order_id IN (SELECT id FROM temp.archive_batch)")
+            && query.exec("DELETE FROM main.orders WHERE id IN (SELECT id FROM temp.archive_batch)");
+    }
+
+    if (!ok || !query.exec("COMMIT")) {
+        qDebug() << "Error archiving orders:" << query.lastError().text();
+        query.exec("ROLLBACK");
+        return -1;
+    }
+    if (moved > 0) {
+        emit ordersArchived(moved);
+    }
+    return moved;
+}
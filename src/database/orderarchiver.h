@@ -0,0 +1,56 @@
+#ifndef ORDERARCHIVER_H
+#define ORDERARCHIVER_H
+
+#include <QtSql/QSqlDatabase>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+struct ArchiveConfig {
+    QString archivePath;   // File attached as the "archive" schema
+    int minAgeDays;        // Finished orders older than this move to the archive
+    int batchSize;         // Orders moved per transaction
+
+    ArchiveConfig() : minAgeDays(90), batchSize(200) {}
+};
+
+// Moves delivered and cancelled orders past a configurable age out of
+// marketplace.db into an attached archive file, a batch per transaction.
+// Readers go through the TEMP views all_orders / all_order_items, which union
+// both stores, so archived orders stay visible in history and reports.
+// MaintenanceScheduler decides when a batch runs.
+class OrderArchiver : public QObject {
+    Q_OBJECT
+
+public:
+    explicit OrderArchiver(QObject *parent = nullptr);
+
+    void setDatabase(const QSqlDatabase& database);
+    void setConfig(const ArchiveConfig& config);
+    ArchiveConfig getConfig() const;
+
+    // Attaches the archive, creates its tables and the union views.
+    // Falls back to views over the main tables when the archive is unavailable.
+    bool attach();
+    bool isAttached() const;
+
+    // Statements that give another connection the same views (for the read pool)
+    QStringList connectionSetup() const;
+
+    // Moves one batch; returns how many orders moved, or -1 on error
+    int archiveBatch();
+
+signals:
+    void ordersArchived(int count);
+
+private:
+    bool createArchiveTables();
+    bool createViews(bool withArchive);
+    static QStringList viewStatements(bool withArchive);
+
+    QSqlDatabase db;
+    ArchiveConfig config;
+    bool attached;
+};
+
+#endif // ORDERARCHIVER_H
@@ -0,0 +1,136 @@
+#include "readconnectionpool.h"
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QDebug>
+
+ReadConnectionPool::ReadConnectionPool()
+    : maxReaders(0)
+    , nextConnectionId(0)
+{
+}
+
+void ReadConnectionPool::configure(const QString& path, int readerCount, int busyTimeoutMs) {
+    databasePath = path;
+    connectOptions = QString("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=%1").arg(busyTimeoutMs);
+    if (readerCount > maxReaders) {
+        readers.release(readerCount - maxReaders);
+        maxReaders = readerCount;
+    }
+    qDebug() << "Read connection pool configured with" << maxReaders << "readers";
+}
+
+void ReadConnectionPool::setConnectionSetup(const QStringList& statements) {
+    setupStatements = statements;
+}
+
+bool ReadConnectionPool::isConfigured() const {
+    return maxReaders > 0 && !databasePath.isEmpty();
+}
+
+int ReadConnectionPool::getMaxReaders() const {
+    return maxReaders;
+}
+
+ReadConnectionPool::ThreadConnection::~ThreadConnection() {
+    // Runs on the owning thread when it exits, which is where Qt wants the
+    // connection closed.
+    {
+        QSqlDatabase connection = QSqlDatabase::database(connectionName, false);
+        if (connection.isOpen()) {
+            connection.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+ReadConnectionPool::ThreadConnection* ReadConnectionPool::connectionForThread() {
+    if (threadConnections.hasLocalData()) {
+        return threadConnections.localData();
+    }
+
+    ThreadConnection* connection = new ThreadConnection();
+    connection->connectionName = QString("marketplace_read_%1").arg(nextConnectionId.fetchAndAddRelaxed(1));
+
+    QSqlDatabase readDb = QSqlDatabase::addDatabase("QSQLITE", connection->connectionName);
+    readDb.setDatabaseName(databasePath);
+    readDb.setConnectOptions(connectOptions);
+    if (!readDb.open()) {
+        qDebug() << "Error opening read connection:" << readDb.lastError().text();
+    } else {
+        QSqlQuery query(readDb);
+        for (const QString& statement : setupStatements) {
+            if (!query.exec(statement)) {
+                qDebug() << "Error setting up read connection:" << query.lastError().text();
+            }
+        }
+    }
+
+    threadConnections.setLocalData(connection);
+    return connection;
+}
+
+ReadSnapshot::ReadSnapshot(ReadConnectionPool& readPool)
+    : pool(readPool)
+    , connection(nullptr)
+    , valid(false)
+{
+    if (!pool.isConfigured()) {
+        return;
+    }
+
+    connection = pool.connectionForThread();
+    if (connection->depth++ > 0) {
+        valid = database().isOpen();
+        return;
+    }
+
+    pool.readers.acquire();
+    QSqlDatabase readDb = database();
+    if (!readDb.isOpen()) {
+        return;
+    }
+
+    // A deferred BEGIN only starts the read transaction on the first read, so
+    // touch the schema right away to pin the snapshot here.
+    QSqlQuery query(readDb);
+    if (!query.exec("BEGIN")) {
+        qDebug() << "Error starting read snapshot:" << query.lastError().text();
+        return;
+    }
+    if (!query.exec("SELECT COUNT(*) FROM sqlite_master")) {
+        qDebug() << "Error starting read snapshot:" << query.lastError().text();
+        query.exec("ROLLBACK");
+        return;
+    }
+    query.finish();
+    valid = true;
+}
+
+ReadSnapshot::~ReadSnapshot() {
+    if (!connection) {
+        return;
+    }
+    if (--connection->depth > 0) {
+        return;
+    }
+
+    QSqlDatabase readDb = database();
+    if (valid && readDb.isOpen()) {
+        QSqlQuery query(readDb);
+        if (!query.exec("COMMIT")) {
+            qDebug() << "Error ending read snapshot:" << query.lastError().text();
+        }
+    }
+    pool.readers.release();
+}
+
+bool ReadSnapshot::isValid() const {
+    return valid;
+}
+
+QSqlDatabase ReadSnapshot::database() const {
+    if (!connection) {
+        return QSqlDatabase();
+    }
+    return QSqlDatabase::database(connection->connectionName, false);
+}
@@ -0,0 +1,67 @@
+#ifndef READCONNECTIONPOOL_H
+#define READCONNECTIONPOOL_H
+
+#include <QtSql/QSqlDatabase>
+#include <QSemaphore>
+#include <QString>
+#include <QStringList>
+#include <QThreadStorage>
+#include <QAtomicInt>
+
+// Pool of read-only SQLite connections used for reports and other long reads.
+// With the database in WAL mode these readers never block the write connection
+// and each ReadSnapshot sees one consistent version of the data.
+// QSqlDatabase connections are bound to the thread that opened them, so every
+// thread gets its own connection; the semaphore caps how many read at once.
+class ReadConnectionPool {
+public:
+    ReadConnectionPool();
+
+    void configure(const QString& databasePath, int maxReaders, int busyTimeoutMs);
+    // Run on every new connection, e.g. ATTACH and TEMP views
+    void setConnectionSetup(const QStringList& statements);
+    bool isConfigured() const;
+    int getMaxReaders() const;
+
+private:
+    friend class ReadSnapshot;
+
+    struct ThreadConnection {
+        QString connectionName;
+        int depth;
+
+        ThreadConnection() : depth(0) {}
+        ~ThreadConnection();
+    };
+
+    ThreadConnection* connectionForThread();
+
+    QString databasePath;
+    QString connectOptions;
+    QStringList setupStatements;
+    int maxReaders;
+    QSemaphore readers;
+    QThreadStorage<ThreadConnection*> threadConnections;
+    QAtomicInt nextConnectionId;
+};
+
+// Holds a read transaction on a pooled connection for its lifetime. Nested
+// snapshots on the same thread share the outer transaction.
+class ReadSnapshot {
+public:
+    explicit ReadSnapshot(ReadConnectionPool& pool);
+    ~ReadSnapshot();
+
+    bool isValid() const;
+    QSqlDatabase database() const;
+
+private:
+    ReadSnapshot(const ReadSnapshot&) = delete;
+    ReadSnapshot& operator=(const ReadSnapshot&) = delete;
+
+    ReadConnectionPool& pool;
+    ReadConnectionPool::ThreadConnection* connection;
+    bool valid;
+};
+
+#endif // READCONNECTIONPOOL_H
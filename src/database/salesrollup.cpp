@@ -0,0 +1,217 @@
+#include "salesrollup.h"
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QDebug>
+
+QString SalesRollup::tableName(RollupGranularity granularity) {
+    return granularity == RollupGranularity::Hourly ? "sales_rollup_hourly" : "sales_rollup_daily";
+}
+
+QString SalesRollup::bucketExpression(RollupGranularity granularity, const QString& column) {
+    // order_date is epoch milliseconds; buckets follow local wall-clock time
+    if (granularity == RollupGranularity::Hourly) {
+        return QString("strftime('%Y-%m-%d %H:00', %1 / 1000, 'unixepoch', 'localtime')").arg(column);
+    }
+    return QString("strftime('%Y-%m-%d', %1 / 1000, 'unixepoch', 'localtime')").arg(column);
+}
+
+QString SalesRollup::bucketKey(RollupGranularity granularity, const QDateTime& time) {
+    QDateTime local = time.toLocalTime();
+    if (granularity == RollupGranularity::Hourly) {
+        return local.toString("yyyy-MM-dd HH:00");
+    }
+    return local.toString("yyyy-MM-dd");
+}
+
+int SalesRollup::statusWeight(const QString& status) {
+    return status == "Cancelled" ? 0 : 1;
+}
+
+bool SalesRollup::createTables(QSqlDatabase& db) {
+    QSqlQuery query(db);
+    const RollupGranularity granularities[] = { RollupGranularity::Hourly, RollupGranularity::Daily };
+    for (RollupGranularity granularity : granularities) {
+        QString table = tableName(granularity);
+        if (!query.exec(QString(
+                "CREATE TABLE IF NOT EXISTS %1 ("
+                "    bucket TEXT NOT NULL,"
+                "    seller_id INTEGER NOT NULL,"
+                "    category TEXT NOT NULL DEFAULT '',"
+                "    revenue REAL NOT NULL DEFAULT 0,"
+                "    units INTEGER NOT NULL DEFAULT 0,"
+                "    order_count INTEGER NOT NULL DEFAULT 0,"
+                "    PRIMARY KEY (bucket, seller_id, category)"
+                ") WITHOUT ROWID").arg(table))) {
+            qDebug() << "Error creating" << table << "table:" << query.lastError().text();
+            return false;
+        }
+        if (!query.exec(QString("CREATE INDEX IF NOT EXISTS idx_%1_seller ON %1 (seller_id, bucket)").arg(table))) {
+            qDebug() << "Error creating" << table << "index:" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SalesRollup::migrateOrderItems(QSqlDatabase& db, const QString& schema) {
+    QSqlQuery query(db);
+    if (!query.exec(QString("PRAGMA %1.table_info(order_items)").arg(schema))) {
+        qDebug() << "Error reading" << schema << "order_items schema:" << query.lastError().text();
+        return false;
+    }
+    bool hasSeller = false;
+    while (query.next()) {
+        if (query.value("name").toString() == "seller_id") {
+            hasSeller = true;
+        }
+    }
+    query.finish();
+    if (hasSeller) {
+        return true;
+    }
+
+    qDebug() << "Adding seller_id and category to" << schema << "order_items";
+
+    // Items of products deleted before this ran stay NULL and are left out
+    bool ok = query.exec("BEGIN IMMEDIATE")
+        && query.exec(QString("ALTER TABLE %1.order_items ADD COLUMN seller_id INTEGER").arg(schema))
+        && query.exec(QString("ALTER TABLE %1.order_items ADD COLUMN category TEXT").arg(schema))
+        && query.exec(QString("UPDATE %1.order_items SET "
+                              "seller_id = (SELECT p.seller_id FROM main.products p WHERE p.id = product_id), "
+                              "category = (SELECT p.category FROM main.products p WHERE p.id = product_id)")
+                      .arg(schema))
+        && query.exec(QString("DELETE FROM main.%1").arg(tableName(RollupGranularity::Hourly)))
+        && query.exec(QString("DELETE FROM main.%1").arg(tableName(RollupGranularity::Daily)))
+        && query.exec("COMMIT");
+    if (!ok) {
+        qDebug() << "Error migrating" << schema << "order_items:" << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
+    return true;
+}
+
+bool SalesRollup::applyOrder(QSqlDatabase& db, int orderId, int sign) {
+    const RollupGranularity granularities[] = { RollupGranularity::Hourly, RollupGranularity::Daily };
+    for (RollupGranularity granularity : granularities) {
+        QString table = tableName(granularity);
+        QString bucket = bucketExpression(granularity, "o.order_date");
+
+        QSqlQuery query(db);
+        query.prepare(QString(
+            "INSERT INTO %1 (bucket, seller_id, category, revenue, units, order_count) "
+            "SELECT %2, oi.seller_id, COALESCE(oi.category, ''), "
+            "       ? * SUM(oi.quantity * oi.price), ? * SUM(oi.quantity), ? "
+            "FROM orders o "
+            "JOIN order_items oi ON oi.order_id = o.id "
+            "WHERE o.id = ? AND oi.seller_id IS NOT NULL "
+            "GROUP BY 1, oi.seller_id, COALESCE(oi.category, '') "
+            "ON CONFLICT (bucket, seller_id, category) DO UPDATE SET "
+            "    revenue = revenue + excluded.revenue,"
+            "    units = units + excluded.units,"
+            "    order_count = order_count + excluded.order_count").arg(table, bucket));
+        query.addBindValue(sign);
+        query.addBindValue(sign);
+        query.addBindValue(sign);
+        query.addBindValue(orderId);
+        if (!query.exec()) {
+            qDebug() << "Error updating" << table << ":" << query.lastError().text();
+            return false;
+        }
+
+        if (sign < 0) {
+            query.prepare(QString(
+                "DELETE FROM %1 WHERE order_count <= 0 "
+                "AND bucket = (SELECT %2 FROM orders o WHERE o.id = ?)").arg(table, bucket));
+            query.addBindValue(orderId);
+            if (!query.exec()) {
+                qDebug() << "Error pruning" << table << ":" << query.lastError().text();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool SalesRollup::needsBackfill(QSqlDatabase& db) {
+    QSqlQuery query(db);
+    if (query.exec("SELECT NOT EXISTS (SELECT 1 FROM sales_rollup_daily) "
+                   "AND EXISTS (SELECT 1 FROM all_orders WHERE status <> 'Cancelled')") && query.next()) {
+        return query.value(0).toBool();
+    }
+    return false;
+}
+
+bool SalesRollup::backfill(QSqlDatabase& db) {
+    qDebug() << "Backfilling sales rollups from order history";
+
+    QSqlQuery query(db);
+    if (!query.exec("BEGIN IMMEDIATE")) {
+        qDebug() << "Error starting rollup backfill:" << query.lastError().text();
+        return false;
+    }
+
+    const RollupGranularity granularities[] = { RollupGranularity::Hourly, RollupGranularity::Daily };
+    for (RollupGranularity granularity : granularities) {
+        QString table = tableName(granularity);
+        bool ok = query.exec(QString("DELETE FROM %1").arg(table))
+            && query.exec(QString(
+                "INSERT INTO %1 (bucket, seller_id, category, revenue, units, order_count) "
+                "SELECT %2, oi.seller_id, COALESCE(oi.category, ''), "
+                "       SUM(oi.quantity * oi.price), SUM(oi.quantity), COUNT(DISTINCT o.id) "
+                "FROM all_orders o "
+                "JOIN all_order_items oi ON oi.order_id = o.id "
+                "WHERE o.status <> 'Cancelled' AND oi.seller_id IS NOT NULL "
+                "GROUP BY 1, oi.seller_id, COALESCE(oi.category, '')")
+                .arg(table, bucketExpression(granularity, "o.order_date")));
+        if (!ok) {
+            qDebug() << "Error backfilling" << table << ":" << query.lastError().text();
+            query.exec("ROLLBACK");
+            return false;
+        }
+    }
+
+    if (!query.exec("COMMIT")) {
+        qDebug() << "Error committing rollup backfill:" << query.lastError().text();
+        query.exec("ROLLBACK");
+        return false;
+    }
+    qDebug() << "Sales rollup backfill complete";
+    return true;
+}
+
+QList<SalesRollupRow> SalesRollup::query(QSqlDatabase& db, RollupGranularity granularity,
+                                         const QDateTime& from, const QDateTime& to, int sellerId) {
+    QList<SalesRollupRow> rows;
+    QString sql = QString("SELECT bucket, seller_id, category, revenue, units, order_count "
+                          "FROM %1 WHERE bucket >= ? AND bucket <= ?").arg(tableName(granularity));
+    if (sellerId != -1) {
+        sql += " AND seller_id = ?";
+    }
+    sql += " ORDER BY bucket";
+
+    QSqlQuery query(db);
+    query.prepare(sql);
+    query.addBindValue(bucketKey(granularity, from));
+    query.addBindValue(bucketKey(granularity, to));
+    if (sellerId != -1) {
+        query.addBindValue(sellerId);
+    }
+
+    if (!query.exec()) {
+        qDebug() << "Error reading sales rollup:" << query.lastError().text();
+        return rows;
+    }
+
+    while (query.next()) {
+        SalesRollupRow row;
+        row.bucket = query.value(0).toString();
+        row.sellerId = query.value(1).toInt();
+        row.category = query.value(2).toString();
+        row.revenue = query.value(3).toDouble();
+        row.units = query.value(4).toInt();
+        row.orderCount = query.value(5).toInt();
+        rows.append(row);
+    }
+    return rows;
+}
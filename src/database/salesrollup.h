@@ -0,0 +1,61 @@
+#ifndef SALESROLLUP_H
+#define SALESROLLUP_H
+
+#include <QtSql/QSqlDatabase>
+#include <QDateTime>
+#include <QList>
+#include <QString>
+
+enum class RollupGranularity {
+    Hourly,
+    Daily
+};
+
+struct SalesRollupRow {
+    QString bucket;     // "yyyy-MM-dd" or "yyyy-MM-dd HH:00", local time
+    int sellerId;
+    QString category;
+    double revenue;
+    int units;
+    int orderCount;
+
+    SalesRollupRow() : sellerId(-1), revenue(0.0), units(0), orderCount(0) {}
+};
+
+// Pre-aggregated revenue, units and order counts per (time bucket, seller,
+// category). Kept current by checkout and order status changes so charts read
+// a handful of rows instead of scanning orders. Seller and category come from
+// the order_items row, recorded at checkout, so a reversal always hits the
+// bucket the order was added to even if the product changed since.
+class SalesRollup {
+public:
+    static bool createTables(QSqlDatabase& db);
+
+    // Adds the seller_id/category snapshot to schema.order_items if it is
+    // missing, filled from the products as they are now, and empties the
+    // rollups so the next start rebuilds them from it.
+    static bool migrateOrderItems(QSqlDatabase& db, const QString& schema);
+
+    // Adds (sign = 1) or removes (sign = -1) one order's items from both
+    // rollups. Must run inside the transaction that changes the order.
+    static bool applyOrder(QSqlDatabase& db, int orderId, int sign);
+
+    // Rebuilds both rollups from the order history, archived orders included.
+    static bool backfill(QSqlDatabase& db);
+    static bool needsBackfill(QSqlDatabase& db);
+
+    static QList<SalesRollupRow> query(QSqlDatabase& db, RollupGranularity granularity,
+                                       const QDateTime& from, const QDateTime& to, int sellerId = -1);
+
+    // Whether moving an order between these statuses changes what it counts for
+    static int statusWeight(const QString& status);
+
+    // The bucket a local time falls in, formatted like the bucket column
+    static QString bucketKey(RollupGranularity granularity, const QDateTime& time);
+
+private:
+    static QString tableName(RollupGranularity granularity);
+    static QString bucketExpression(RollupGranularity granularity, const QString& column);
+};
+
+#endif // SALESROLLUP_H
@@ -0,0 +1,83 @@
+#include "selectionbitmap.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+SelectionBitmap::SelectionBitmap()
+    : bitCount(0)
+{
+}
+
+SelectionBitmap::SelectionBitmap(int size, bool value)
+    : words((size + 63) / 64, value ? ~quint64(0) : quint64(0))
+    , bitCount(size)
+{
+    clearTail();
+}
+
+int SelectionBitmap::size() const {
+    return bitCount;
+}
+
+int SelectionBitmap::count() const {
+    int total = 0;
+    for (quint64 word : words) {
+        total += qPopulationCount(word);
+    }
+    return total;
+}
+
+bool SelectionBitmap::isEmpty() const {
+    return std::all_of(words.cbegin(), words.cend(), [](quint64 word) { return word == 0; });
+}
+
+SelectionBitmap& SelectionBitmap::operator&=(const SelectionBitmap& other) {
+    Q_ASSERT(bitCount == other.bitCount);
+    quint64* mine = words.data();
+    const quint64* theirs = other.words.constData();
+    for (int i = 0; i < words.size(); ++i) {
+        mine[i] &= theirs[i];
+    }
+    return *this;
+}
+
+SelectionBitmap& SelectionBitmap::operator|=(const SelectionBitmap& other) {
+    Q_ASSERT(bitCount == other.bitCount);
+    quint64* mine = words.data();
+    const quint64* theirs = other.words.constData();
+    for (int i = 0; i < words.size(); ++i) {
+        mine[i] |= theirs[i];
+    }
+    return *this;
+}
+
+QVector<int> SelectionBitmap::rows() const {
+    QVector<int> result;
+    result.reserve(count());
+    for (int i = 0; i < words.size(); ++i) {
+        quint64 word = words.at(i);
+        while (word) {
+            result.append(i * 64 + qCountTrailingZeroBits(word));
+            word &= word - 1;
+        }
+    }
+    return result;
+}
+
+int SelectionBitmap::wordCount() const {
+    return words.size();
+}
+
+quint64* SelectionBitmap::data() {
+    return words.data();
+}
+
+const quint64* SelectionBitmap::constData() const {
+    return words.constData();
+}
+
+void SelectionBitmap::clearTail() {
+    // Bits past the last row stay zero so count() and rows() need no masking
+    if (bitCount % 64 != 0 && !words.isEmpty()) {
+        words.last() &= (quint64(1) << (bitCount % 64)) - 1;
+    }
+}
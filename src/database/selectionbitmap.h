@@ -0,0 +1,36 @@
+#ifndef SELECTIONBITMAP_H
+#define SELECTIONBITMAP_H
+
+#include <QVector>
+
+// One bit per catalog row, packed into 64-bit words
+class SelectionBitmap {
+public:
+    SelectionBitmap();
+    explicit SelectionBitmap(int size, bool value = false);
+
+    int size() const;
+    bool test(int row) const { return (words.at(row >> 6) >> (row & 63)) & 1; }
+    void set(int row) { words[row >> 6] |= quint64(1) << (row & 63); }
+    void reset(int row) { words[row >> 6] &= ~(quint64(1) << (row & 63)); }
+    int count() const;
+    bool isEmpty() const;
+
+    SelectionBitmap& operator&=(const SelectionBitmap& other);
+    SelectionBitmap& operator|=(const SelectionBitmap& other);
+
+    // Set rows in ascending order
+    QVector<int> rows() const;
+
+    int wordCount() const;
+    quint64* data();
+    const quint64* constData() const;
+
+private:
+    void clearTail();
+
+    QVector<quint64> words;
+    int bitCount;
+};
+
+#endif // SELECTIONBITMAP_H
@@ -0,0 +1,62 @@
+#include "storagebackend.h"
+#include "databasemanager.h"
+#include "inmemorystoragebackend.h"
+#include <QCryptographicHash>
+#include <QtGlobal>
+#include <QDebug>
+
+OrderStatus orderStatusFromString(const QString& status) {
+    if (status == "Pending") return OrderStatus::Pending;
+    if (status == "Processing") return OrderStatus::Processing;
+    if (status == "Shipped") return OrderStatus::Shipped;
+    if (status == "Delivered") return OrderStatus::Delivered;
+    if (status == "Cancelled") return OrderStatus::Cancelled;
+    return OrderStatus::Unknown;
+}
+
+QByteArray StoredSession::hashToken(const QByteArray& token) {
+    return QCryptographicHash::hash(token, QCryptographicHash::Sha256);
+}
+
+StorageBackend::Kind StorageBackend::kind = StorageBackend::Sqlite;
+bool StorageBackend::instantiated = false;
+
+void StorageBackend::select(Kind newKind) {
+    if (instantiated && newKind != kind) {
+        qDebug() << "Storage backend already in use, ignoring switch";
+        return;
+    }
+    kind = newKind;
+}
+
+StorageBackend::Kind StorageBackend::kindFromArguments(const QStringList& arguments) {
+    QString name;
+    for (const QString& argument : arguments) {
+        if (argument.startsWith("--storage=")) {
+            name = argument.mid(QString("--storage=").length());
+        }
+    }
+    if (name.isEmpty()) {
+        name = qEnvironmentVariable("MARKETPLACE_STORAGE");
+    }
+
+    if (name.compare("memory", Qt::CaseInsensitive) == 0) {
+        return InMemory;
+    }
+    if (!name.isEmpty() && name.compare("sqlite", Qt::CaseInsensitive) != 0) {
+        qDebug() << "Unknown storage backend" << name << "- using sqlite";
+    }
+    return Sqlite;
+}
+
+StorageBackend::Kind StorageBackend::selectedKind() {
+    return kind;
+}
+
+StorageBackend& StorageBackend::getInstance() {
+    instantiated = true;
+    if (kind == InMemory) {
+        return InMemoryStorageBackend::getInstance();
+    }
+    return DatabaseManager::getInstance();
+}
@@ -0,0 +1,282 @@
+#ifndef STORAGEBACKEND_H
+#define STORAGEBACKEND_H
+
+#include <QString>
+#include <QByteArray>
+#include <QDateTime>
+#include <QList>
+#include <QHash>
+#include <QStringList>
+#include "../auth/user.h"
+#include "checkoutengine.h"
+#include "salesrollup.h"
+
+struct CartItem {
+    int id;
+    int userId;
+    int productId;
+    int quantity;
+    double price;  // Price at time of adding to cart
+    
+    CartItem() : id(-1), userId(-1), productId(-1), quantity(0), price(0.0) {}
+};
+
+// A cart row joined with the product as it is now
+struct CartLine {
+    int cartItemId;
+    int productId;
+    QString productName;
+    int quantity;
+    double price;         // Price when added; what checkout charges
+    double currentPrice;  // Product price now
+    int stock;
+    QString imageUrl;     // Thumbnail reference; image_data is not loaded
+    bool hasImageData;
+    bool productMissing;  // Product was deleted after it was added
+    
+    CartLine() : cartItemId(-1), productId(-1), quantity(0), price(0.0), currentPrice(0.0)
+        , stock(0), hasImageData(false), productMissing(false) {}
+    
+    bool priceChanged() const { return !productMissing && qAbs(currentPrice - price) > 0.005; }
+    bool outOfStock() const { return productMissing || stock < quantity; }
+};
+
+struct CartView {
+    QList<CartLine> lines;
+    double total;         // Sum of quantity * price over lines whose product still exists
+    
+    CartView() : total(0.0) {}
+};
+
+struct OrderItem {
+    int id;
+    int orderId;
+    int productId;
+    QString productName;
+    int sellerId;      // Seller and category at checkout, -1/empty if unknown
+    QString category;
+    int quantity;
+    double price;
+    
+    OrderItem() : id(-1), orderId(-1), productId(-1), sellerId(-1), quantity(0), price(0.0) {}
+};
+
+struct Order {
+    int id;
+    int userId;
+    qint64 orderDate;        // Milliseconds since the Unix epoch
+    QString status;
+    double totalAmount;      // Seller-scoped queries only count that seller's items
+    QString customerEmail;
+    int itemCount;
+    QList<OrderItem> items;
+    
+    Order() : id(-1), userId(-1), orderDate(0), totalAmount(0.0), itemCount(0) {}
+    
+    QDateTime orderDateTime() const { return QDateTime::fromMSecsSinceEpoch(orderDate); }
+};
+
+// Values of Order::status; the database stores the names
+enum class OrderStatus {
+    Pending,
+    Processing,
+    Shipped,
+    Delivered,
+    Cancelled,
+    Unknown
+};
+
+OrderStatus orderStatusFromString(const QString& status);
+
+// One row of order history without the item rows; load those with getOrderById
+struct OrderSummary {
+    int id;
+    qint64 orderDate;  // Milliseconds since the Unix epoch
+    QString status;
+    double totalAmount;
+    int itemCount;
+    
+    OrderSummary() : id(-1), orderDate(0), totalAmount(0.0), itemCount(0) {}
+    
+    QDateTime orderDateTime() const { return QDateTime::fromMSecsSinceEpoch(orderDate); }
+};
+
+class Product {
+public:
+    int id;
+    QString name;
+    QString description;
+    double price;
+    QByteArray imageData;
+    int sellerId;
+    QString category;
+    QString imageUrl;  // URL for fetching the image
+    int stock;        // Stock quantity
+    bool hasImageData;  // Set when imageData was left out but the product has one
+    
+    Product() : id(-1), price(0.0), sellerId(-1), stock(0), hasImageData(false) {}
+};
+
+struct Review {
+    int id;
+    int productId;
+    int userId;
+    QString username;  // Store username for display
+    int rating;       // 1-5 stars
+    QString comment;
+    qint64 reviewDate;  // Milliseconds since the Unix epoch
+    
+    Review() : id(-1), productId(-1), userId(-1), rating(0), reviewDate(0) {}
+    
+    QDateTime reviewDateTime() const { return QDateTime::fromMSecsSinceEpoch(reviewDate); }
+};
+
+struct RatingSummary {
+    double average;
+    int count;
+    
+    RatingSummary() : average(0.0), count(0) {}
+};
+
+struct SalesSummary {
+    double totalSales;
+    int totalOrders;
+    double averageOrderValue;
+    
+    SalesSummary() : totalSales(0.0), totalOrders(0), averageOrderValue(0.0) {}
+};
+
+struct StoredSession {
+    QByteArray tokenHash;  // hashToken() of the 16 raw token bytes; empty if not found
+    QString userId;
+    qint64 expiresAt;   // Milliseconds since the Unix epoch
+    
+    StoredSession() : expiresAt(0) {}
+    
+    // SHA-256, so a copy of the sessions table cannot be replayed as logins
+    static QByteArray hashToken(const QByteArray& token);
+};
+
+// Everything the pages need from storage: users, products, carts, orders,
+// reviews and sales reports. DatabaseManager implements it on SQLite and
+// InMemoryStorageBackend on hash maps, so UI and business logic can be run
+// and measured without touching disk. The backend is chosen once at startup.
+class StorageBackend {
+public:
+    enum Kind {
+        Sqlite,
+        InMemory
+    };
+
+    virtual ~StorageBackend() {}
+
+    // Must be called before the first getInstance()
+    static void select(Kind kind);
+    // --storage=memory|sqlite on the command line, else MARKETPLACE_STORAGE
+    static Kind kindFromArguments(const QStringList& arguments);
+    static Kind selectedKind();
+    static StorageBackend& getInstance();
+
+    // Safe to call more than once
+    virtual bool initialize() = 0;
+
+    // Users
+    virtual bool addUser(const User& user) = 0;
+    virtual User getUserByEmail(const QString& email) = 0;
+    virtual User getUserByUsername(const QString& username) = 0;
+    virtual User getUserById(int userId) = 0;
+    virtual bool userExists(const QString& email, const QString& username) = 0;
+    virtual int getUserIdByEmail(const QString& email) = 0;
+    virtual QList<User> getAllUsers() = 0;
+    virtual bool isUserAdmin(int userId) = 0;
+    virtual bool isUserSeller(const QString& email) = 0;
+    virtual bool suspendUser(int userId) = 0;
+    virtual bool unsuspendUser(int userId) = 0;
+    virtual bool resetUserPassword(int userId, const QString& newHashedPassword) = 0;
+    virtual bool updateUserRole(int userId, bool isAdmin, bool isSeller) = 0;
+
+    // Products
+    virtual bool addProduct(const Product& product) = 0;
+    virtual bool updateProductStock(int productId, int newStock) = 0;
+    virtual bool decrementProductStock(int productId, int quantity) = 0;
+    virtual bool deleteProduct(int productId) = 0;
+    virtual Product getProductById(int productId) = 0;
+    virtual QList<Product> getAllProducts() = 0;
+    virtual QList<Product> getProductsBySeller(int sellerId) = 0;
+    // Encoded image_data of one product, empty if none; safe from worker threads
+    virtual QByteArray getProductImage(int productId) = 0;
+    // Changes whenever any product row does; cached copies of the catalog
+    // compare it with the version they were built from
+    virtual qint64 getCatalogVersion() = 0;
+    // Seller dashboard pages; total receives the full row count when given.
+    // Product pages leave out image_data to keep them light.
+    virtual QList<Product> getSellerProducts(const QString& sellerEmail, int offset = 0, int limit = 50,
+                                             int* total = nullptr) = 0;
+
+    // Cart
+    virtual bool addToCart(int userId, int productId, int quantity, int* cartItemId = nullptr) = 0;
+    virtual bool updateCartItemQuantity(int cartItemId, int quantity) = 0;
+    virtual bool removeFromCart(int cartItemId) = 0;
+    virtual QList<CartItem> getCartItems(int userId) = 0;
+    virtual CartView getCartView(int userId) = 0;
+    // One line of getCartView; cartItemId stays -1 if the row is gone
+    virtual CartLine getCartLine(int cartItemId) = 0;
+    // Bumped by every write to the user's cart rows, 0 if it was never written
+    virtual qint64 getCartVersion(int userId) = 0;
+    virtual bool clearCart(int userId) = 0;
+
+    // Orders
+    // Resolves to the new order id, or -1; lastCheckoutResult() says why
+    virtual QFuture<int> createOrder(int userId, const QList<CartItem>& items) = 0;
+    virtual CheckoutEngine::Result lastCheckoutResult() const = 0;
+    virtual QList<Order> getUserOrders(int userId) = 0;
+    virtual QList<Order> getUserOrdersByDateRange(int userId, const QDateTime& startDate, const QDateTime& endDate) = 0;
+    virtual QList<Order> getUserOrdersByStatus(int userId, const QString& status) = 0;
+    // Newest first by (date, id); null dates and an empty status leave that
+    // filter off. A limit returns one page, continuing after `after`, the last
+    // row of the previous page (a default OrderSummary starts at the top).
+    virtual QList<OrderSummary> getUserOrderSummaries(int userId, const QDateTime& from = QDateTime(),
+                                                      const QDateTime& to = QDateTime(),
+                                                      const QString& status = QString(),
+                                                      const OrderSummary& after = OrderSummary(),
+                                                      int limit = -1) = 0;
+    virtual Order getOrderById(int orderId) = 0;
+    virtual bool updateOrderStatus(int orderId, const QString& status) = 0;
+    virtual QList<Order> getSellerOrders(const QString& sellerEmail, int offset = 0, int limit = 50,
+                                         int* total = nullptr) = 0;
+
+    // Reviews
+    virtual bool addReview(const Review& review) = 0;
+    virtual bool updateReview(const Review& review) = 0;
+    virtual bool deleteReview(int reviewId) = 0;
+    virtual Review getReviewById(int reviewId) = 0;
+    virtual QList<Review> getProductReviews(int productId) = 0;
+    virtual Review getUserProductReview(int userId, int productId) = 0;
+    virtual double getProductAverageRating(int productId) = 0;
+    virtual bool hasUserPurchasedProduct(int userId, int productId) = 0;
+    // Every reviewed product's average and count, for grids that show many at once
+    virtual QHash<int, RatingSummary> getRatingSummaries() = 0;
+    // Seller id -> username for every user with a product listed
+    virtual QHash<int, QString> getSellerNames() = 0;
+
+    // Sales reports
+    virtual double getTotalSales() = 0;
+    virtual int getTotalOrders() = 0;
+    virtual double getAverageOrderValue() = 0;
+    virtual SalesSummary getSalesSummary() = 0;
+    virtual QList<SalesRollupRow> getSalesRollup(RollupGranularity granularity, const QDateTime& from,
+                                                 const QDateTime& to, int sellerId = -1) = 0;
+
+    // Sessions, so a restart does not log everyone out; keyed by token hash.
+    // getSession is safe from worker threads.
+    virtual bool saveSession(const StoredSession& session) = 0;
+    virtual bool deleteSession(const QByteArray& tokenHash) = 0;
+    virtual int deleteExpiredSessions(qint64 nowMs) = 0;
+    virtual StoredSession getSession(const QByteArray& tokenHash, qint64 nowMs) = 0;
+
+private:
+    static Kind kind;
+    static bool instantiated;
+};
+
+#endif // STORAGEBACKEND_H
@@ -0,0 +1,142 @@
+#include "trigramindex.h"
+#include <algorithm>
+
+namespace {
+quint64 packTrigram(QChar a, QChar b, QChar c) {
+    return (quint64(a.unicode()) << 32) | (quint64(b.unicode()) << 16) | quint64(c.unicode());
+}
+
+QString normalizeCodePoint(char32_t codePoint) {
+    // ASCII is by far the common case and needs no decomposition
+    if (codePoint < 0x80) {
+        return QString(QChar(char16_t(codePoint >= 'A' && codePoint <= 'Z' ? codePoint + 32 : codePoint)));
+    }
+
+    char32_t folded = QChar::toCaseFolded(codePoint);
+    QString decomposed = QString::fromUcs4(&folded, 1).normalized(QString::NormalizationForm_KD);
+    QString result;
+    result.reserve(decomposed.size());
+    for (QChar ch : decomposed) {
+        QChar::Category category = ch.category();
+        if (category != QChar::Mark_NonSpacing && category != QChar::Mark_SpacingCombining
+            && category != QChar::Mark_Enclosing) {
+            result.append(ch);
+        }
+    }
+    return result.toCaseFolded();
+}
+}
+
+TrigramIndex::TrigramIndex()
+    : products(0)
+{
+}
+
+QString TrigramIndex::normalize(QStringView text) {
+    QString result;
+    result.reserve(text.size());
+    for (int i = 0; i < text.size(); ++i) {
+        char32_t codePoint = text.at(i).unicode();
+        if (text.at(i).isHighSurrogate() && i + 1 < text.size() && text.at(i + 1).isLowSurrogate()) {
+            codePoint = QChar::surrogateToUcs4(text.at(i), text.at(i + 1));
+            ++i;
+        }
+        result.append(normalizeCodePoint(codePoint));
+    }
+    return result;
+}
+
+void TrigramIndex::appendTrigrams(const QString& normalized, QVector<quint64>& out) {
+    for (int i = 0; i + 2 < normalized.size(); ++i) {
+        out.append(packTrigram(normalized.at(i), normalized.at(i + 1), normalized.at(i + 2)));
+    }
+}
+
+QVector<quint64> TrigramIndex::trigrams(QStringView name, QStringView description) {
+    // Name and description are indexed separately so no trigram spans both
+    QVector<quint64> result;
+    appendTrigrams(normalize(name), result);
+    appendTrigrams(normalize(description), result);
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+void TrigramIndex::clear() {
+    postings.clear();
+    products = 0;
+}
+
+void TrigramIndex::addProduct(int productId, QStringView name, QStringView description) {
+    for (quint64 trigram : trigrams(name, description)) {
+        QVector<int>& list = postings[trigram];
+        // Ids usually arrive in ascending order, so this is an append
+        auto it = std::lower_bound(list.begin(), list.end(), productId);
+        if (it == list.end() || *it != productId) {
+            list.insert(it, productId);
+        }
+    }
+    ++products;
+}
+
+void TrigramIndex::removeProduct(int productId, QStringView name, QStringView description) {
+    for (quint64 trigram : trigrams(name, description)) {
+        auto entry = postings.find(trigram);
+        if (entry == postings.end()) {
+            continue;
+        }
+        QVector<int>& list = entry.value();
+        auto it = std::lower_bound(list.begin(), list.end(), productId);
+        if (it != list.end() && *it == productId) {
+            list.erase(it);
+        }
+        if (list.isEmpty()) {
+            postings.erase(entry);
+        }
+    }
+    products = qMax(0, products - 1);
+}
+
+bool TrigramIndex::lookup(const QString& text, QVector<int>* productIds) const {
+    QVector<quint64> queryTrigrams;
+    appendTrigrams(normalize(text), queryTrigrams);
+    if (queryTrigrams.isEmpty()) {
+        return false;
+    }
+    std::sort(queryTrigrams.begin(), queryTrigrams.end());
+    queryTrigrams.erase(std::unique(queryTrigrams.begin(), queryTrigrams.end()), queryTrigrams.end());
+
+    QVector<const QVector<int>*> lists;
+    lists.reserve(queryTrigrams.size());
+    for (quint64 trigram : queryTrigrams) {
+        auto entry = postings.constFind(trigram);
+        if (entry == postings.constEnd()) {
+            productIds->clear();
+            return true;
+        }
+        lists.append(&entry.value());
+    }
+
+    // Intersect shortest first so the working set only shrinks
+    std::sort(lists.begin(), lists.end(), [](const QVector<int>* a, const QVector<int>* b) {
+        return a->size() < b->size();
+    });
+    QVector<int> result = *lists.first();
+    QVector<int> next;
+    for (int i = 1; i < lists.size() && !result.isEmpty(); ++i) {
+        next.clear();
+        std::set_intersection(result.cbegin(), result.cend(), lists.at(i)->cbegin(), lists.at(i)->cend(),
+                              std::back_inserter(next));
+        result.swap(next);
+    }
+    *productIds = result;
+    return true;
+}
+
+int TrigramIndex::productCount() const {
+    return products;
+}
+
+int TrigramIndex::trigramCount() const {
+    return postings.size();
+}
@@ -0,0 +1,47 @@
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+
+// Inverted index from character trigrams to the products whose name or
+// description contains them. Text is normalized first: case folded,
+// decomposed and stripped of combining marks, so "Café" and "CAFE" index
+// the same trigrams.
+//
+// A lookup intersects the posting lists of the query's trigrams and returns
+// candidates: every product whose text contains the query (ignoring case) is
+// among them, but callers still confirm each candidate with
+// QString::contains to keep the exact substring semantics. Queries shorter
+// than three characters after normalization cannot use the index.
+class TrigramIndex {
+public:
+    TrigramIndex();
+
+    // Folds case, then decomposes and drops combining marks, one character at
+    // a time, so any substring match in the original is one here too
+    static QString normalize(QStringView text);
+
+    void clear();
+    void addProduct(int productId, QStringView name, QStringView description);
+    // Needs the text the product was indexed with to find its postings
+    void removeProduct(int productId, QStringView name, QStringView description);
+
+    // False when the query is too short; otherwise productIds holds the
+    // sorted candidate ids
+    bool lookup(const QString& text, QVector<int>* productIds) const;
+
+    int productCount() const;
+    int trigramCount() const;
+
+private:
+    static QVector<quint64> trigrams(QStringView name, QStringView description);
+    static void appendTrigrams(const QString& normalized, QVector<quint64>& out);
+
+    QHash<quint64, QVector<int>> postings;  // Each list sorted by product id
+    int products;
+};
+
+#endif // TRIGRAMINDEX_H
@@ -8,7 +8,7 @@
 
 SellerDashboard::SellerDashboard(QWidget *parent)
     : QMainWindow(parent)
-    , db(DatabaseManager::getInstance())
+    , db(StorageBackend::getInstance())
 {
     setupUI();
     refreshOrderList();
@@ -299,7 +299,7 @@ void SellerDashboard::refreshOrderList() {
         const Order& order = orders[i];
         
         orderTable->setItem(i, 0, new QTableWidgetItem(QString::number(order.id)));
-        orderTable->setItem(i, 1, new QTableWidgetItem(order.orderDate.toString("yyyy-MM-dd hh:mm")));
+        orderTable->setItem(i, 1, new QTableWidgetItem(order.orderDateTime().toString("yyyy-MM-dd hh:mm")));
         orderTable->setItem(i, 2, new QTableWidgetItem(order.customerEmail));
         orderTable->setItem(i, 3, new QTableWidgetItem(QString::number(order.itemCount)));
         orderTable->setItem(i, 4, new QTableWidgetItem(QString("$%1").arg(order.totalAmount, 0, 'f', 2)));
@@ -5,7 +5,7 @@
 #include <QTableWidget>
 #include <QPushButton>
 #include <QLabel>
-#include "../database/databasemanager.h"
+#include "../database/storagebackend.h"
 
 class SellerDashboard : public QMainWindow {
     Q_OBJECT
@@ -35,7 +35,7 @@ private:
     QPushButton *deleteProductButton;
     QLabel *totalSalesLabel;
     QLabel *totalOrdersLabel;
-    DatabaseManager& db;
+    StorageBackend& db;
 
     void setupUI();
     void setupOrderManagement();
@@ -0,0 +1,218 @@
+#include "cartmodel.h"
+#include "../auth/authmanager.h"
+#include <QColor>
+
+namespace {
+// Lines whose product is gone cannot be bought and stay out of the total
+double payableSubtotal(const CartLine& line) {
+    return line.productMissing ? 0.0 : line.price * line.quantity;
+}
+}
+
+CartModel& CartModel::getInstance() {
+    static CartModel instance(StorageBackend::getInstance());
+    return instance;
+}
+
+CartModel::CartModel(StorageBackend& storage, QObject *parent)
+    : QAbstractTableModel(parent)
+    , storage(storage)
+    , currentUserId(-1)
+    , cartVersion(-1)
+    , catalogVersion(-1)
+    , cartTotal(0.0)
+{
+    // Never keep one user's cart around for the next
+    connect(&AuthManager::getInstance(), &AuthManager::logoutSuccess, this, &CartModel::clear);
+}
+
+int CartModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : lines.size();
+}
+
+int CartModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant CartModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= lines.size()) {
+        return QVariant();
+    }
+
+    const CartLine& line = lines.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case ProductColumn:
+            return line.productMissing ? QString("(Product no longer available)") : line.productName;
+        case QuantityColumn: return QString::number(line.quantity);
+        case PriceColumn: return QString("$%1").arg(line.price, 0, 'f', 2);
+        case SubtotalColumn: return QString("$%1").arg(payableSubtotal(line), 0, 'f', 2);
+        default: return QVariant();
+        }
+    // Flag lines that checkout would reject or that no longer match the catalog
+    case Qt::ForegroundRole:
+        if (index.column() == ProductColumn && line.outOfStock()) {
+            return QColor("#e74c3c");
+        }
+        if (index.column() == PriceColumn && !line.outOfStock() && line.priceChanged()) {
+            return QColor("#e67e22");
+        }
+        return QVariant();
+    case Qt::ToolTipRole:
+        if (index.column() == ProductColumn && line.outOfStock()) {
+            return line.productMissing
+                ? QString("This product has been removed")
+                : QString("Only %1 left in stock").arg(line.stock);
+        }
+        if (index.column() == PriceColumn && !line.outOfStock() && line.priceChanged()) {
+            return QString("Price is now $%1").arg(line.currentPrice, 0, 'f', 2);
+        }
+        return QVariant();
+    case CartItemIdRole:
+        return line.cartItemId;
+    default:
+        return QVariant();
+    }
+}
+
+QVariant CartModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    switch (section) {
+    case ProductColumn: return "Product";
+    case QuantityColumn: return "Quantity";
+    case PriceColumn: return "Price";
+    case SubtotalColumn: return "Subtotal";
+    default: return QVariant();
+    }
+}
+
+void CartModel::sync(int userId) {
+    if (userId == -1) {
+        clear();
+        return;
+    }
+    if (userId != currentUserId
+        || storage.getCartVersion(userId) != cartVersion
+        || storage.getCatalogVersion() != catalogVersion) {
+        currentUserId = userId;
+        reload();
+    }
+}
+
+void CartModel::clear() {
+    beginResetModel();
+    currentUserId = -1;
+    cartVersion = -1;
+    catalogVersion = -1;
+    lines.clear();
+    endResetModel();
+    adjustTotal(-cartTotal);
+}
+
+void CartModel::reload() {
+    // Versions first: a write landing during the read then shows up as a
+    // mismatch on the next sync instead of being missed
+    qint64 newCartVersion = storage.getCartVersion(currentUserId);
+    qint64 newCatalogVersion = storage.getCatalogVersion();
+    CartView view = storage.getCartView(currentUserId);
+
+    beginResetModel();
+    cartVersion = newCartVersion;
+    catalogVersion = newCatalogVersion;
+    lines = QVector<CartLine>(view.lines.cbegin(), view.lines.cend());
+    endResetModel();
+    adjustTotal(view.total - cartTotal);
+}
+
+bool CartModel::acceptOwnWrite() {
+    qint64 current = storage.getCartVersion(currentUserId);
+    if (current != cartVersion + 1) {
+        return false;
+    }
+    cartVersion = current;
+    return true;
+}
+
+bool CartModel::add(int userId, int productId, int quantity) {
+    int cartItemId = -1;
+    if (!storage.addToCart(userId, productId, quantity, &cartItemId)) {
+        return false;
+    }
+    if (userId != currentUserId) {
+        // Not loaded; the next sync reads the whole cart anyway
+        return true;
+    }
+
+    CartLine line = storage.getCartLine(cartItemId);
+    if (!acceptOwnWrite() || line.cartItemId == -1) {
+        reload();
+        return true;
+    }
+    beginInsertRows(QModelIndex(), lines.size(), lines.size());
+    lines.append(line);
+    endInsertRows();
+    adjustTotal(payableSubtotal(line));
+    return true;
+}
+
+bool CartModel::setQuantity(int row, int quantity) {
+    if (row < 0 || row >= lines.size()) {
+        return false;
+    }
+    if (!storage.updateCartItemQuantity(lines.at(row).cartItemId, quantity)) {
+        return false;
+    }
+    if (!acceptOwnWrite()) {
+        reload();
+        return true;
+    }
+
+    CartLine& line = lines[row];
+    double before = payableSubtotal(line);
+    line.quantity = quantity;
+    double delta = payableSubtotal(line) - before;
+    emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+    adjustTotal(delta);
+    return true;
+}
+
+bool CartModel::remove(int row) {
+    if (row < 0 || row >= lines.size()) {
+        return false;
+    }
+    if (!storage.removeFromCart(lines.at(row).cartItemId)) {
+        return false;
+    }
+    if (!acceptOwnWrite()) {
+        reload();
+        return true;
+    }
+
+    double subtotal = payableSubtotal(lines.at(row));
+    beginRemoveRows(QModelIndex(), row, row);
+    lines.remove(row);
+    endRemoveRows();
+    adjustTotal(-subtotal);
+    return true;
+}
+
+void CartModel::adjustTotal(double delta) {
+    // Summing deltas drifts by fractions of a cent; an empty cart is exactly zero
+    cartTotal = lines.isEmpty() ? 0.0 : cartTotal + delta;
+    emit totalChanged(cartTotal);
+}
+
+int CartModel::userId() const {
+    return currentUserId;
+}
+
+double CartModel::total() const {
+    return cartTotal;
+}
+
+const CartLine& CartModel::lineAt(int row) const {
+    return lines.at(row);
+}
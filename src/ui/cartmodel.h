@@ -0,0 +1,73 @@
+#ifndef CARTMODEL_H
+#define CARTMODEL_H
+
+#include "../database/storagebackend.h"
+#include <QAbstractTableModel>
+#include <QVector>
+
+// The logged-in user's cart, kept in memory between visits to the cart page.
+// It is read in full once; after that adds, removals and quantity changes
+// write through to storage and are applied here as single-row deltas, with
+// the total adjusted by the difference. The storage cart version tells
+// whether anything else wrote to the cart: each of our writes must move it by
+// exactly one, and sync() compares it before the page is shown. A mismatch,
+// or a catalog change that could alter prices or stock, re-reads the cart.
+class CartModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        ProductColumn,
+        QuantityColumn,
+        PriceColumn,
+        SubtotalColumn,
+        ColumnCount
+    };
+
+    enum Roles {
+        CartItemIdRole = Qt::UserRole + 1
+    };
+
+    static CartModel& getInstance();
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // Makes the model hold userId's cart. Costs two single-row lookups when
+    // nothing changed since the last call.
+    void sync(int userId);
+    void clear();
+
+    // Write through to storage; false if storage refused the change
+    bool add(int userId, int productId, int quantity);
+    bool setQuantity(int row, int quantity);
+    bool remove(int row);
+
+    int userId() const;
+    double total() const;
+    const CartLine& lineAt(int row) const;
+
+signals:
+    void totalChanged(double total);
+
+private:
+    explicit CartModel(StorageBackend& storage, QObject *parent = nullptr);
+    CartModel(const CartModel&) = delete;
+    CartModel& operator=(const CartModel&) = delete;
+
+    void reload();
+    // True if our own write was the only one since cartVersion
+    bool acceptOwnWrite();
+    void adjustTotal(double delta);
+
+    StorageBackend& storage;
+    int currentUserId;
+    qint64 cartVersion;
+    qint64 catalogVersion;
+    QVector<CartLine> lines;    // Ordered by cart item id, like getCartView
+    double cartTotal;
+};
+
+#endif // CARTMODEL_H
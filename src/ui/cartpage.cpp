@@ -3,20 +3,23 @@
 #include <QMessageBox>
 #include <QDebug>
 #include <QFormLayout>
+#include <QColor>
 
 CartPage::CartPage(QWidget *parent)
     : ProtectedPage(parent)
     , cartTable(nullptr)
+    , cartModel(CartModel::getInstance())
     , checkoutButton(nullptr)
     , removeButton(nullptr)
     , totalLabel(nullptr)
     , mainLayout(nullptr)
-    , total(0.0)
-    , dbManager(DatabaseManager::getInstance())
+    , dbManager(StorageBackend::getInstance())
     , authManager(AuthManager::getInstance())
 {
     qDebug() << "CartPage constructor called";
     setupUI();
+    connect(&cartModel, &CartModel::totalChanged, this, &CartPage::updateTotal);
+    updateTotal(cartModel.total());
     // Don't load cart in constructor, wait for showEvent
 }
 
@@ -24,7 +27,7 @@ void CartPage::showEvent(QShowEvent* event)
 {
     qDebug() << "CartPage showEvent called";
     QWidget::showEvent(event);
-    loadCart(); // Reload cart data when page becomes visible
+    loadCart(); // Only re-reads if the cart changed since it was last shown
 }
 
 void CartPage::setupUI()
@@ -99,26 +102,27 @@ void CartPage::setupUI()
     mainLayout->addWidget(headerWidget);
     
     // Cart table with modern styling
-    cartTable = new QTableWidget(this);
+    cartTable = new QTableView(this);
+    cartTable->setModel(&cartModel);
     cartTable->setStyleSheet(
-        "QTableWidget {"
+        "QTableView {"
         "    background-color: white;"
         "    border: 1px solid #e0e0e0;"
         "    border-radius: 15px;"
         "    gridline-color: #f0f0f0;"
         "    padding: 10px;"
         "}"
-        "QTableWidget::item {"
+        "QTableView::item {"
         "    padding: 12px;"
         "    border-bottom: 1px solid #f0f0f0;"
         "    color: #2c3e50;"
         "    font-size: 14px;"
         "}"
-        "QTableWidget::item:selected {"
+        "QTableView::item:selected {"
         "    background-color: #f5f6fa;"
         "    color: #2c3e50;"
         "}"
-        "QTableWidget::item:hover:!selected {"
+        "QTableView::item:hover:!selected {"
         "    background-color: #f8f9fa;"
         "}"
         "QHeaderView::section {"
@@ -130,17 +134,16 @@ void CartPage::setupUI()
         "    font-weight: bold;"
         "    font-size: 14px;"
         "}"
-        "QTableWidget:focus {"
+        "QTableView:focus {"
         "    outline: none;"
         "    border: 1px solid #e0e0e0;"
         "}"
     );
     
-    cartTable->setColumnCount(4);
-    cartTable->setHorizontalHeaderLabels({"Product", "Quantity", "Price", "Subtotal"});
     cartTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
-    cartTable->setSelectionBehavior(QTableWidget::SelectRows);
-    cartTable->setSelectionMode(QTableWidget::SingleSelection);
+    cartTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    cartTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    cartTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     cartTable->setShowGrid(false);
     cartTable->verticalHeader()->setVisible(false);
     cartTable->setAlternatingRowColors(true);
@@ -215,76 +218,25 @@ void CartPage::setupUI()
 void CartPage::loadCart()
 {
     qDebug() << "loadCart() called";
-    // Clear existing rows
-    cartTable->setRowCount(0);
-    total = 0.0;
     
     int userId = authManager.getCurrentUserId();
     qDebug() << "Current user ID:" << userId;
     
     if (userId == -1) {
         qDebug() << "User not authenticated, redirecting to login...";
+        cartModel.clear();
         emit loginRequired();
         return;
     }
     
-    // Get cart items from database
-    qDebug() << "Fetching cart items from database...";
-    QList<CartItem> cartItems = dbManager.getCartItems(userId);
-    qDebug() << "Found" << cartItems.size() << "items in cart";
+    // Re-reads the cart only if it or the catalog changed since the last visit
+    cartModel.sync(userId);
+    qDebug() << "Found" << cartModel.rowCount() << "items in cart";
     
-    if (cartItems.isEmpty()) {
+    if (cartModel.rowCount() == 0) {
         qDebug() << "Cart is empty";
         QMessageBox::information(this, "Shopping Cart", "Your cart is empty. Add some products to your cart!");
-        return;
     }
-    
-    qDebug() << "Processing cart items...";
-    for (const CartItem& item : cartItems) {
-        qDebug() << "Processing cart item - ID:" << item.id << "Product ID:" << item.productId << "Quantity:" << item.quantity;
-        
-        // Get product details
-        Product product = dbManager.getProductById(item.productId);
-        if (product.id == -1) {
-            qDebug() << "ERROR: Product not found for cart item:" << item.productId;
-            continue;
-        }
-        
-        qDebug() << "Found product:" << product.name << "Price:" << product.price;
-        
-        int row = cartTable->rowCount();
-        cartTable->insertRow(row);
-        
-        // Product name
-        QTableWidgetItem* nameItem = new QTableWidgetItem(product.name);
-        nameItem->setFlags(nameItem->flags() & ~Qt::ItemIsEditable);
-        cartTable->setItem(row, 0, nameItem);
-        
-        // Quantity
-        QTableWidgetItem* quantityItem = new QTableWidgetItem(QString::number(item.quantity));
-        quantityItem->setFlags(quantityItem->flags() & ~Qt::ItemIsEditable);
-        cartTable->setItem(row, 1, quantityItem);
-        
-        // Price
-        QTableWidgetItem* priceItem = new QTableWidgetItem(QString("$%1").arg(item.price, 0, 'f', 2));
-        priceItem->setFlags(priceItem->flags() & ~Qt::ItemIsEditable);
-        cartTable->setItem(row, 2, priceItem);
-        
-        // Subtotal
-        double subtotal = item.price * item.quantity;
-        QTableWidgetItem* subtotalItem = new QTableWidgetItem(QString("$%1").arg(subtotal, 0, 'f', 2));
-        subtotalItem->setFlags(subtotalItem->flags() & ~Qt::ItemIsEditable);
-        cartTable->setItem(row, 3, subtotalItem);
-        
-        // Store cart item ID in the first column's data role
-        nameItem->setData(Qt::UserRole, item.id);
-        
-        total += subtotal;
-        qDebug() << "Added row" << row << "to cart table - Product:" << product.name << "Subtotal:" << subtotal;
-    }
-    
-    qDebug() << "Cart loading complete. Total:" << total;
-    updateTotal();
 }
 
 void CartPage::updateCart()
@@ -304,7 +256,7 @@ void CartPage::checkout()
         return;
     }
     
-    if (cartTable->rowCount() == 0) {
+    if (cartModel.rowCount() == 0) {
         QMessageBox::warning(this, "Checkout Failed", "Your cart is empty!");
         return;
     }
@@ -395,7 +347,7 @@ void CartPage::checkout()
     QLabel* itemCountLabel = new QLabel(QString("Items: %1").arg(cartItems.size()), &paymentDialog);
     summaryLayout->addWidget(itemCountLabel);
     
-    QLabel* totalLabel = new QLabel(QString("Total Amount: $%1").arg(total, 0, 'f', 2), &paymentDialog);
+    QLabel* totalLabel = new QLabel(QString("Total Amount: $%1").arg(cartModel.total(), 0, 'f', 2), &paymentDialog);
     totalLabel->setStyleSheet("font-size: 16px; font-weight: bold; color: #27ae60;");
     summaryLayout->addWidget(totalLabel);
     
@@ -448,31 +400,36 @@ void CartPage::checkout()
     connect(payButton, &QPushButton::clicked, &paymentDialog, &QDialog::accept);
     
     if (paymentDialog.exec() == QDialog::Accepted) {
+        double total = cartModel.total();
         // Create order
-        int orderId = dbManager.createOrder(userId, cartItems);
-        if (orderId != -1) {
-            // Clear cart after successful order
-            dbManager.clearCart(userId);
-            
-            QString message = QString("Order placed successfully!\n\n"
-                                   "Order ID: %1\n"
-                                   "Total amount: $%2\n\n"
-                                   "You can track your order in the Order History page.")
-                                .arg(orderId)
-                                .arg(total, 0, 'f', 2);
-            
-            QMessageBox::information(this, "Order Confirmation", message);
-            
-            // Clear cart display
-            cartTable->setRowCount(0);
-            total = 0.0;
-            updateTotal();
-            
-            // Emit signal to update order history
-            emit orderPlaced();
-        } else {
-            QMessageBox::critical(this, "Error", "Failed to create order. Please try again.");
-        }
+        // The checkout transaction also clears the cart. It runs on a worker,
+        // so keep a second checkout from starting until this one settles.
+        checkoutButton->setEnabled(false);
+        dbManager.createOrder(userId, cartItems).then(this, [this, userId, total](int orderId) {
+            checkoutButton->setEnabled(true);
+            if (orderId != -1) {
+                QString message = QString("Order placed successfully!\n\n"
+                                       "Order ID: %1\n"
+                                       "Total amount: $%2\n\n"
+                                       "You can track your order in the Order History page.")
+                                    .arg(orderId)
+                                    .arg(total, 0, 'f', 2);
+                
+                QMessageBox::information(this, "Order Confirmation", message);
+                
+                // The checkout moved the cart version, so this picks up the empty cart
+                cartModel.sync(userId);
+                
+                // Emit signal to update order history
+                emit orderPlaced();
+            } else if (dbManager.lastCheckoutResult() == CheckoutEngine::InsufficientStock) {
+                QMessageBox::warning(this, "Checkout Failed",
+                    "Some items in your cart are no longer available in the requested quantity.");
+                loadCart();
+            } else {
+                QMessageBox::critical(this, "Error", "Failed to create order. Please try again.");
+            }
+        });
     }
 }
 
@@ -483,28 +440,21 @@ void CartPage::removeSelectedItem()
         return;
     }
     
-    QList<QTableWidgetItem*> selectedItems = cartTable->selectedItems();
-    if (selectedItems.isEmpty()) {
+    QModelIndexList selectedRows = cartTable->selectionModel()->selectedRows();
+    if (selectedRows.isEmpty()) {
         QMessageBox::warning(this, "Remove Item", "Please select an item to remove");
         return;
     }
     
-    int row = selectedItems.first()->row();
-    QTableWidgetItem* nameItem = cartTable->item(row, 0);
-    int cartItemId = nameItem->data(Qt::UserRole).toInt();
-    
-    if (dbManager.removeFromCart(cartItemId)) {
-        double subtotal = cartTable->item(row, 3)->text().remove('$').toDouble();
-        total -= subtotal;
-        cartTable->removeRow(row);
-        updateTotal();
+    // The model drops the row and its subtotal without re-reading the cart
+    if (cartModel.remove(selectedRows.first().row())) {
         QMessageBox::information(this, "Success", "Item removed from cart");
     } else {
         QMessageBox::warning(this, "Error", "Failed to remove item from cart");
     }
 }
 
-void CartPage::updateTotal()
+void CartPage::updateTotal(double total)
 {
     totalLabel->setText(QString("Total: $%1").arg(total, 0, 'f', 2));
 } 
\ No newline at end of file
@@ -2,9 +2,10 @@
 #define CARTPAGE_H
 
 #include "protectedpage.h"
-#include "../database/databasemanager.h"
+#include "../database/storagebackend.h"
 #include "../auth/authmanager.h"
-#include <QTableWidget>
+#include "cartmodel.h"
+#include <QTableView>
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QLabel>
@@ -30,19 +31,19 @@ private slots:
     void updateCart();
     void checkout();
     void removeSelectedItem();
+    void updateTotal(double total);
 
 private:
     void setupUI();
     void loadCart();
-    void updateTotal();
 
-    QTableWidget* cartTable;
+    QTableView* cartTable;
+    CartModel& cartModel;
     QPushButton* checkoutButton;
     QPushButton* removeButton;
     QLabel* totalLabel;
     QVBoxLayout* mainLayout;
-    double total;
-    DatabaseManager& dbManager;
+    StorageBackend& dbManager;
     AuthManager& authManager;
 };
 
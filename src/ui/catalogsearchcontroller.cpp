@@ -0,0 +1,243 @@
+#include "catalogsearchcontroller.h"
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <limits>
+
+namespace {
+const int DEFAULT_DEBOUNCE_MS = 200;
+// How many products a worker scans between checks for a newer query
+const int CANCEL_CHECK_INTERVAL = 1024;
+}
+
+CatalogQuery::CatalogQuery()
+    : minPrice(0.0)
+    , maxPrice(std::numeric_limits<double>::max())
+    , inStockOnly(false)
+    , minRating(0.0f)
+    , sort(PriceAscending)
+{
+}
+
+bool CatalogQuery::sameFilters(const CatalogQuery& other) const {
+    return category == other.category
+        && minPrice == other.minPrice
+        && maxPrice == other.maxPrice
+        && inStockOnly == other.inStockOnly
+        && minRating == other.minRating;
+}
+
+CatalogSearchController::CatalogSearchController(QObject *parent)
+    : QObject(parent)
+    , haveMatches(false)
+    , generation(new QAtomicInteger<quint64>(0))
+{
+    debounce.setSingleShot(true);
+    debounce.setInterval(DEFAULT_DEBOUNCE_MS);
+    connect(&debounce, &QTimer::timeout, this, &CatalogSearchController::runQuery);
+}
+
+void CatalogSearchController::setProducts(const QVector<Product>& newProducts,
+                                          const QHash<int, RatingSummary>& newRatings) {
+    products = newProducts;
+    ratings = newRatings;
+    if (store) {
+        previousStore = store;
+    }
+    store.reset();
+    haveMatches = false;
+    lastMatches = SelectionBitmap();
+    runQuery();
+}
+
+void CatalogSearchController::setRatings(const QHash<int, RatingSummary>& newRatings) {
+    ratings = newRatings;
+    if (!store) {
+        // The pending build captured the old ratings; start it again with these
+        runQuery();
+        return;
+    }
+    // Columns are implicitly shared, so only the rating column and facet are copied
+    CatalogStore* updated = new CatalogStore(*store);
+    updated->setRatings(ratings);
+    store.reset(updated);
+    ratings.clear();
+
+    // Rating counts changed; matches only change under a minimum rating
+    if (query.minRating > 0) {
+        haveMatches = false;
+    }
+    runQuery();
+}
+
+void CatalogSearchController::setSearchText(const QString& text) {
+    QString trimmed = text.trimmed();
+    if (trimmed == query.text) {
+        return;
+    }
+    query.text = trimmed;
+    debounce.start();
+}
+
+void CatalogSearchController::setCategory(const QString& category) {
+    query.category = category;
+    runQuery();
+}
+
+void CatalogSearchController::setPriceRange(double minPrice, double maxPrice) {
+    query.minPrice = minPrice;
+    query.maxPrice = maxPrice;
+    runQuery();
+}
+
+void CatalogSearchController::setInStockOnly(bool inStockOnly) {
+    query.inStockOnly = inStockOnly;
+    runQuery();
+}
+
+void CatalogSearchController::setMinimumRating(float rating) {
+    query.minRating = rating;
+    runQuery();
+}
+
+void CatalogSearchController::setFacetSelection(const FacetSelection& selection) {
+    query.facets = selection;
+    runQuery();
+}
+
+void CatalogSearchController::setSortOrder(CatalogQuery::SortOrder sort) {
+    query.sort = sort;
+    runQuery();
+}
+
+CatalogQuery CatalogSearchController::currentQuery() const {
+    return query;
+}
+
+void CatalogSearchController::setDebounceInterval(int ms) {
+    debounce.setInterval(ms);
+}
+
+void CatalogSearchController::runQuery() {
+    debounce.stop();
+    quint64 current = generation->fetchAndAddOrdered(1) + 1;
+
+    // Any product matching the new text also matches text it contains, so
+    // the previous matches are a complete candidate set
+    bool narrowing = haveMatches
+        && matchedQuery.sameFilters(query)
+        && query.text.contains(matchedQuery.text, Qt::CaseInsensitive);
+
+    // Same text as last time: the previous matches need no text check at all
+    bool textChecked = narrowing && query.text == matchedQuery.text;
+
+    CatalogQuery submitted = query;
+    QtConcurrent::run(&CatalogSearchController::execute, products, ratings, store, previousStore,
+                      narrowing ? lastMatches : SelectionBitmap(), narrowing, textChecked, submitted,
+                      current, generation)
+        .then(this, [this, submitted, current](const Result& result) {
+            if (result.cancelled || generation->loadAcquire() != current) {
+                return;
+            }
+            // setProducts bumps the generation, so a current result always
+            // belongs to the current catalog
+            if (result.store) {
+                store = result.store;
+                previousStore.reset();
+                products.clear();
+                ratings.clear();
+            }
+            haveMatches = true;
+            matchedQuery = submitted;
+            lastMatches = result.matches;
+            emit resultsReady(result.rows);
+            emit facetCountsReady(result.facetCounts);
+        });
+}
+
+CatalogSearchController::Result CatalogSearchController::execute(const QVector<Product>& products,
+                                                                 const QHash<int, RatingSummary>& ratings,
+                                                                 QSharedPointer<const CatalogStore> store,
+                                                                 QSharedPointer<const CatalogStore> previousStore,
+                                                                 const SelectionBitmap& candidates,
+                                                                 bool narrowing, bool textChecked,
+                                                                 const CatalogQuery& query,
+                                                                 quint64 generation,
+                                                                 QSharedPointer<QAtomicInteger<quint64>> latest) {
+    Result result;
+    if (!store) {
+        store.reset(new CatalogStore(products, ratings, previousStore.data()));
+        result.store = store;
+    }
+
+    // Column filters first; each is one pass over a single array
+    SelectionBitmap selected = narrowing ? candidates : store->all();
+    if (!narrowing) {
+        if (!query.category.isEmpty()) {
+            selected &= store->category(store->categoryId(query.category));
+        }
+        if (query.minPrice > 0 || query.maxPrice < std::numeric_limits<double>::max()) {
+            selected &= store->priceRange(query.minPrice, query.maxPrice);
+        }
+        if (query.inStockOnly) {
+            selected &= store->inStock();
+        }
+        if (query.minRating > 0) {
+            selected &= store->minimumRating(query.minRating);
+        }
+    }
+
+    // The trigram index rules out most rows; the rest are confirmed below so
+    // results match a plain case-insensitive contains
+    if (!query.text.isEmpty() && !textChecked) {
+        SelectionBitmap indexed;
+        if (store->textCandidates(query.text, &indexed)) {
+            selected &= indexed;
+        }
+        QVector<int> rows = selected.rows();
+        for (int i = 0; i < rows.size(); ++i) {
+            if (i % CANCEL_CHECK_INTERVAL == 0 && latest->loadRelaxed() != generation) {
+                result.cancelled = true;
+                return result;
+            }
+            int row = rows.at(i);
+            if (!store->name(row).contains(query.text, Qt::CaseInsensitive)
+                && !store->description(row).contains(query.text, Qt::CaseInsensitive)) {
+                selected.reset(row);
+            }
+        }
+    }
+
+    if (latest->loadRelaxed() != generation) {
+        result.cancelled = true;
+        return result;
+    }
+
+    // Facets narrow what is shown but are counted against the base matches
+    const FacetIndex& facets = store->facets();
+    result.matches = selected;
+    result.facetCounts = facets.counts(query.facets, selected);
+    if (!query.facets.isEmpty()) {
+        selected &= facets.evaluate(query.facets, store->size());
+    }
+
+    const QVector<int>& order = query.sort == CatalogQuery::NameAscending ? store->nameOrder() : store->priceOrder();
+    bool descending = query.sort == CatalogQuery::PriceDescending;
+    int matchCount = selected.count();
+    result.rows.reserve(matchCount);
+    if (matchCount == store->size()) {
+        // Nothing filtered out: the permutation is the result
+        result.rows = order;
+        if (descending) {
+            std::reverse(result.rows.begin(), result.rows.end());
+        }
+    } else {
+        // One pass over the permutation keeps the selected rows in sorted order
+        for (int i = 0; i < order.size() && result.rows.size() < matchCount; ++i) {
+            int row = order.at(descending ? order.size() - 1 - i : i);
+            if (selected.test(row)) {
+                result.rows.append(row);
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,112 @@
+#ifndef CATALOGSEARCHCONTROLLER_H
+#define CATALOGSEARCHCONTROLLER_H
+
+#include "../database/storagebackend.h"
+#include "../database/catalogstore.h"
+#include <QObject>
+#include <QAtomicInteger>
+#include <QHash>
+#include <QSharedPointer>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+// Search text, filters and sort order applied to the catalog as one query
+struct CatalogQuery {
+    enum SortOrder {
+        PriceAscending,
+        PriceDescending,
+        NameAscending
+    };
+
+    QString text;
+    QString category;   // Empty for all categories
+    double minPrice;
+    double maxPrice;
+    bool inStockOnly;
+    float minRating;    // 0 for any rating
+    FacetSelection facets;
+    SortOrder sort;
+
+    CatalogQuery();
+
+    // True if the filters other than text and facets are the same
+    bool sameFilters(const CatalogQuery& other) const;
+};
+
+// Runs catalog queries for the browse page off the GUI thread. Text changes
+// are debounced; other changes run at once. Text and the column filters give
+// a base set of matches; facets are applied on top of it and counted against
+// it. When the new text contains the previous text under the same filters,
+// only the previous base matches are scanned again, and a facet change alone
+// reuses them as they are. Every query gets a generation number, and a worker stops as
+// soon as a newer query has been started, so only the latest query ever
+// reaches resultsReady.
+//
+// Queries run against a CatalogStore built once per catalog; text is first
+// narrowed through its trigram index and then checked with
+// QString::contains. Results are rows into the catalog passed to
+// setProducts, in display order.
+class CatalogSearchController : public QObject {
+    Q_OBJECT
+
+public:
+    explicit CatalogSearchController(QObject *parent = nullptr);
+
+    // Replaces the catalog and its ratings and re-runs the current query
+    void setProducts(const QVector<Product>& products, const QHash<int, RatingSummary>& ratings);
+    // Updates the ratings of the current catalog, e.g. after a review
+    void setRatings(const QHash<int, RatingSummary>& ratings);
+
+    void setSearchText(const QString& text);
+    void setCategory(const QString& category);
+    void setPriceRange(double minPrice, double maxPrice);
+    void setInStockOnly(bool inStockOnly);
+    void setMinimumRating(float rating);
+    void setFacetSelection(const FacetSelection& selection);
+    void setSortOrder(CatalogQuery::SortOrder sort);
+    CatalogQuery currentQuery() const;
+
+    void setDebounceInterval(int ms);
+
+signals:
+    void resultsReady(const QVector<int>& rows);
+    void facetCountsReady(const FacetCounts& counts);
+
+private slots:
+    void runQuery();
+
+private:
+    struct Result {
+        bool cancelled;
+        SelectionBitmap matches;    // Text and column filters only, kept for narrowing
+        QVector<int> rows;          // Display order
+        FacetCounts facetCounts;
+        QSharedPointer<const CatalogStore> store;  // Set when this run built it
+
+        Result() : cancelled(false) {}
+    };
+
+    static Result execute(const QVector<Product>& products, const QHash<int, RatingSummary>& ratings,
+                          QSharedPointer<const CatalogStore> store, QSharedPointer<const CatalogStore> previousStore,
+                          const SelectionBitmap& candidates, bool narrowing, bool textChecked,
+                          const CatalogQuery& query, quint64 generation,
+                          QSharedPointer<QAtomicInteger<quint64>> latest);
+
+    // Only held until a store has been built from them
+    QVector<Product> products;
+    QHash<int, RatingSummary> ratings;
+    QSharedPointer<const CatalogStore> store;
+    QSharedPointer<const CatalogStore> previousStore;  // Seeds the text index of the next store
+    CatalogQuery query;
+    QTimer debounce;
+
+    // Matches of the last completed query, for narrowing the next one
+    bool haveMatches;
+    CatalogQuery matchedQuery;
+    SelectionBitmap lastMatches;
+
+    QSharedPointer<QAtomicInteger<quint64>> generation;
+};
+
+#endif // CATALOGSEARCHCONTROLLER_H
@@ -0,0 +1,196 @@
+#include "facetpanel.h"
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QScrollArea>
+#include <QSignalBlocker>
+
+namespace {
+const int KeyRole = Qt::UserRole + 1;
+const int MAX_LIST_HEIGHT = 180;
+}
+
+FacetPanel::FacetPanel(QWidget *parent)
+    : QWidget(parent)
+    , clearButton(nullptr)
+{
+    setupUI();
+}
+
+void FacetPanel::setupUI()
+{
+    QVBoxLayout* outerLayout = new QVBoxLayout(this);
+    outerLayout->setContentsMargins(0, 0, 0, 0);
+
+    QScrollArea* scrollArea = new QScrollArea(this);
+    scrollArea->setWidgetResizable(true);
+    scrollArea->setFrameShape(QFrame::NoFrame);
+    scrollArea->setStyleSheet("QScrollArea { border: none; background: transparent; }");
+
+    QWidget* container = new QWidget(scrollArea);
+    container->setObjectName("facetContainer");
+    container->setStyleSheet(
+        "QWidget#facetContainer {"
+        "    background-color: white;"
+        "    border: 1px solid #e0e0e0;"
+        "    border-radius: 10px;"
+        "}"
+    );
+    QVBoxLayout* layout = new QVBoxLayout(container);
+    layout->setSpacing(8);
+    layout->setContentsMargins(15, 15, 15, 15);
+
+    QString titleStyle =
+        "QLabel {"
+        "    color: #2c3e50;"
+        "    font-size: 14px;"
+        "    font-weight: bold;"
+        "    margin-top: 6px;"
+        "}";
+    QString listStyle =
+        "QListWidget {"
+        "    border: none;"
+        "    background: transparent;"
+        "    color: #2c3e50;"
+        "    font-size: 13px;"
+        "}"
+        "QListWidget::item:disabled {"
+        "    color: #bdc3c7;"
+        "}";
+
+    for (int facet = 0; facet < FacetIndex::FacetCount; ++facet) {
+        QLabel* title = new QLabel(FacetIndex::facetName(static_cast<FacetIndex::Facet>(facet)), container);
+        title->setStyleSheet(titleStyle);
+        layout->addWidget(title);
+
+        QListWidget* list = new QListWidget(container);
+        list->setStyleSheet(listStyle);
+        list->setSelectionMode(QAbstractItemView::NoSelection);
+        list->setFocusPolicy(Qt::NoFocus);
+        list->setMaximumHeight(MAX_LIST_HEIGHT);
+        connect(list, &QListWidget::itemChanged, this, &FacetPanel::onItemChanged);
+        layout->addWidget(list);
+        lists.append(list);
+    }
+
+    clearButton = new QPushButton("Clear filters", container);
+    clearButton->setStyleSheet(
+        "QPushButton {"
+        "    background-color: #ecf0f1;"
+        "    color: #2c3e50;"
+        "    border: none;"
+        "    border-radius: 5px;"
+        "    padding: 8px;"
+        "}"
+        "QPushButton:hover {"
+        "    background-color: #dfe6e9;"
+        "}"
+    );
+    clearButton->setEnabled(false);
+    connect(clearButton, &QPushButton::clicked, this, &FacetPanel::clearSelection);
+    layout->addWidget(clearButton);
+    layout->addStretch();
+
+    scrollArea->setWidget(container);
+    outerLayout->addWidget(scrollArea);
+}
+
+QString FacetPanel::labelFor(int facet, const FacetValueCount& value) const {
+    QString label = value.label;
+    if (facet == FacetIndex::SellerFacet) {
+        label = sellerNames.value(value.key.toInt(), QString("Seller %1").arg(value.key));
+    }
+    return QString("%1 (%2)").arg(label).arg(value.count);
+}
+
+void FacetPanel::setCounts(const FacetCounts& counts) {
+    lastCounts = counts;
+
+    // Values can disappear with a catalog refresh; forget ticks on them
+    bool dropped = false;
+    for (int facet = 0; facet < counts.size() && facet < selected.values.size(); ++facet) {
+        QSet<QString> present;
+        for (const FacetValueCount& value : counts.at(facet)) {
+            present.insert(value.key);
+        }
+        QSet<QString>& ticked = selected.values[facet];
+        int before = ticked.size();
+        ticked.intersect(present);
+        dropped = dropped || ticked.size() != before;
+    }
+
+    for (int facet = 0; facet < lists.size() && facet < counts.size(); ++facet) {
+        QListWidget* list = lists.at(facet);
+        const QSet<QString>& ticked = selected.values.at(facet);
+
+        // Items are rebuilt only when the values change; counts update in place
+        QSignalBlocker blocker(list);
+        bool sameValues = list->count() == counts.at(facet).size();
+        for (int i = 0; sameValues && i < list->count(); ++i) {
+            sameValues = list->item(i)->data(KeyRole).toString() == counts.at(facet).at(i).key;
+        }
+        if (!sameValues) {
+            list->clear();
+        }
+
+        for (int i = 0; i < counts.at(facet).size(); ++i) {
+            const FacetValueCount& value = counts.at(facet).at(i);
+            QListWidgetItem* item = sameValues ? list->item(i) : new QListWidgetItem(list);
+            item->setData(KeyRole, value.key);
+            item->setText(labelFor(facet, value));
+            bool checked = ticked.contains(value.key);
+            item->setCheckState(checked ? Qt::Checked : Qt::Unchecked);
+            // A value with nothing left stays reachable only to untick it
+            Qt::ItemFlags flags = Qt::ItemIsUserCheckable;
+            if (value.count > 0 || checked) {
+                flags |= Qt::ItemIsEnabled;
+            }
+            item->setFlags(flags);
+        }
+    }
+
+    clearButton->setEnabled(!selected.isEmpty());
+    if (dropped) {
+        emit selectionChanged(selected);
+    }
+}
+
+void FacetPanel::setSellerNames(const QHash<int, QString>& names) {
+    sellerNames = names;
+    if (!lastCounts.isEmpty()) {
+        setCounts(lastCounts);
+    }
+}
+
+FacetSelection FacetPanel::selection() const {
+    return selected;
+}
+
+void FacetPanel::clearSelection() {
+    if (selected.isEmpty()) {
+        return;
+    }
+    selected = FacetSelection();
+    for (QListWidget* list : lists) {
+        QSignalBlocker blocker(list);
+        for (int i = 0; i < list->count(); ++i) {
+            list->item(i)->setCheckState(Qt::Unchecked);
+        }
+    }
+    clearButton->setEnabled(false);
+    emit selectionChanged(selected);
+}
+
+void FacetPanel::onItemChanged(QListWidgetItem* item) {
+    int facet = lists.indexOf(item->listWidget());
+    if (facet < 0) {
+        return;
+    }
+    QString key = item->data(KeyRole).toString();
+    if (item->checkState() == Qt::Checked) {
+        selected.values[facet].insert(key);
+    } else {
+        selected.values[facet].remove(key);
+    }
+    clearButton->setEnabled(!selected.isEmpty());
+    emit selectionChanged(selected);
+}
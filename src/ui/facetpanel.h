@@ -0,0 +1,44 @@
+#ifndef FACETPANEL_H
+#define FACETPANEL_H
+
+#include "../database/facetindex.h"
+#include <QWidget>
+#include <QHash>
+#include <QListWidget>
+#include <QPushButton>
+#include <QVector>
+
+// Sidebar listing every facet value with the number of products it would
+// show. Ticking values emits the new selection; counts are refreshed from
+// the search results via setCounts.
+class FacetPanel : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit FacetPanel(QWidget *parent = nullptr);
+
+    void setCounts(const FacetCounts& counts);
+    // Seller values are keyed by id; these label them
+    void setSellerNames(const QHash<int, QString>& names);
+
+    FacetSelection selection() const;
+    void clearSelection();
+
+signals:
+    void selectionChanged(const FacetSelection& selection);
+
+private slots:
+    void onItemChanged(QListWidgetItem* item);
+
+private:
+    void setupUI();
+    QString labelFor(int facet, const FacetValueCount& value) const;
+
+    QVector<QListWidget*> lists;
+    QPushButton* clearButton;
+    FacetSelection selected;
+    FacetCounts lastCounts;
+    QHash<int, QString> sellerNames;
+};
+
+#endif // FACETPANEL_H
@@ -0,0 +1,263 @@
+#include "imageservice.h"
+#include "remoteimageloader.h"
+#include "../database/storagebackend.h"
+#include <QtConcurrent/QtConcurrent>
+#include <QBuffer>
+#include <QImageReader>
+#include <QPainter>
+#include <QThread>
+#include <QTimer>
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+// Products without image data all share one cached "no image" rendition
+const int NO_IMAGE_ID = -1;
+const char* const NO_IMAGE_PATH = ":/images/no-image.png";
+}
+
+size_t qHash(const ImageKey& key, size_t seed) {
+    return qHashMulti(seed, key.productId, key.size.width(), key.size.height(), qRound(key.dpr * 100));
+}
+
+ImageService& ImageService::getInstance() {
+    static ImageService instance;
+    return instance;
+}
+
+ImageService::ImageService(QObject *parent)
+    : QObject(parent)
+    , pixmaps(DEFAULT_CACHE_KB)
+{
+    // Decoding is short work; keep a core free for the GUI thread
+    workers.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+QPixmap ImageService::request(int productId, const QByteArray& imageData, const QSize& size, qreal dpr,
+                              QObject* receiver, Callback callback) {
+    if (imageData.isEmpty()) {
+        productId = NO_IMAGE_ID;
+    }
+    ImageKey key{productId, size, dpr};
+    if (QPixmap* pixmap = pixmaps.object(key)) {
+        return *pixmap;
+    }
+
+    if (enqueue(key, receiver, callback)) {
+        startDecode(key, imageData);
+    }
+    return QPixmap();
+}
+
+QPixmap ImageService::requestUrl(int productId, const QUrl& imageUrl, const QSize& size, qreal dpr,
+                                 QObject* receiver, Callback callback) {
+    ImageKey key{productId, size, dpr};
+    if (QPixmap* pixmap = pixmaps.object(key)) {
+        return *pixmap;
+    }
+
+    if (enqueue(key, receiver, callback)) {
+        // After a failure the URL is left alone until its retry time
+        qint64 waitMs = 0;
+        auto retry = failedFetches.constFind(imageUrl);
+        if (retry != failedFetches.constEnd()) {
+            waitMs = retry->retryAtMs - QDateTime::currentMSecsSinceEpoch();
+        }
+        if (waitMs > 0) {
+            QTimer::singleShot(int(waitMs), this, [this, key, imageUrl]() {
+                startFetch(key, imageUrl);
+            });
+        } else {
+            startFetch(key, imageUrl);
+        }
+    }
+    return QPixmap();
+}
+
+void ImageService::startFetch(const ImageKey& key, const QUrl& imageUrl) {
+    RemoteImageLoader::getInstance().fetch(imageUrl, this, [this, key, imageUrl](const QByteArray& body) {
+        if (!body.isEmpty()) {
+            // Bytes that arrived but do not decode are cached as the placeholder
+            failedFetches.remove(imageUrl);
+            startDecode(key, body);
+            return;
+        }
+        FetchRetry& retry = failedFetches[imageUrl];
+        int delayMs = RETRY_BASE_MS << qMin(retry.failures, 8);
+        retry.failures++;
+        retry.retryAtMs = QDateTime::currentMSecsSinceEpoch() + qMin(delayMs, RETRY_MAX_MS);
+        failFetch(key);
+    });
+}
+
+QPixmap ImageService::requestStored(int productId, const QSize& size, qreal dpr,
+                                    QObject* receiver, Callback callback) {
+    ImageKey key{productId, size, dpr};
+    if (QPixmap* pixmap = pixmaps.object(key)) {
+        return *pixmap;
+    }
+
+    if (enqueue(key, receiver, callback)) {
+        StorageBackend* storage = &StorageBackend::getInstance();
+        QSize pixelSize = size * dpr;
+        QtConcurrent::run(&workers, [storage, productId, pixelSize]() {
+            return decode(storage->getProductImage(productId), pixelSize);
+        }).then(this, [this, key, dpr](const QImage& image) {
+            finishDecode(key, image, dpr);
+        });
+    }
+    return QPixmap();
+}
+
+bool ImageService::enqueue(const ImageKey& key, QObject* receiver, const Callback& callback) {
+    auto pending = inFlight.find(key);
+    if (pending != inFlight.end()) {
+        // A view repaints while the decode runs; one callback per receiver is enough
+        bool waiting = std::any_of(pending->cbegin(), pending->cend(),
+                                   [receiver](const Waiter& waiter) { return waiter.receiver == receiver; });
+        if (callback && !waiting) {
+            pending->append(Waiter{receiver, callback});
+        }
+        return false;
+    }
+    QList<Waiter>& waiters = inFlight[key];
+    if (callback) {
+        waiters.append(Waiter{receiver, callback});
+    }
+    return true;
+}
+
+void ImageService::startDecode(const ImageKey& key, const QByteArray& imageData) {
+    qreal dpr = key.dpr;
+    QSize pixelSize = key.size * dpr;
+    QtConcurrent::run(&workers, [imageData, pixelSize]() {
+        return decode(imageData, pixelSize);
+    }).then(this, [this, key, dpr](const QImage& image) {
+        finishDecode(key, image, dpr);
+    });
+}
+
+QPixmap ImageService::cached(int productId, const QSize& size, qreal dpr) const {
+    QPixmap* pixmap = pixmaps.object(ImageKey{productId, size, dpr});
+    return pixmap ? *pixmap : QPixmap();
+}
+
+QImage ImageService::decode(const QByteArray& imageData, const QSize& pixelSize) {
+    QBuffer buffer;
+    buffer.setData(imageData);
+    QImageReader reader;
+    if (imageData.isEmpty()) {
+        reader.setFileName(NO_IMAGE_PATH);
+    } else {
+        reader.setDevice(&buffer);
+    }
+
+    // Formats like JPEG can decode straight to a smaller size
+    QSize sourceSize = reader.size();
+    if (sourceSize.isValid() && reader.supportsOption(QImageIOHandler::ScaledSize)) {
+        reader.setScaledSize(sourceSize.scaled(pixelSize, Qt::KeepAspectRatio));
+    }
+
+    QImage image = reader.read();
+    if (image.isNull()) {
+        qDebug() << "Error decoding product image:" << reader.errorString();
+        return image;
+    }
+    if (image.width() > pixelSize.width() || image.height() > pixelSize.height()) {
+        image = image.scaled(pixelSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    // Premultiplied images turn into pixmaps without another conversion
+    return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+
+void ImageService::finishDecode(const ImageKey& key, const QImage& image, qreal dpr) {
+    QList<Waiter> waiters = inFlight.take(key);
+    // Decoded from bytes that were replaced meanwhile; the next paint asks again
+    bool keep = !forgotten.remove(key);
+
+    QPixmap pixmap;
+    if (!image.isNull()) {
+        pixmap = QPixmap::fromImage(image);
+        pixmap.setDevicePixelRatio(dpr);
+        int costKb = qMax(1, int(qint64(image.sizeInBytes()) / 1024));
+        if (keep) {
+            pixmaps.insert(key, new QPixmap(pixmap), costKb);
+        }
+    } else {
+        // Keep failed images on the placeholder rather than retrying every paint
+        pixmap = placeholder(key.size, dpr);
+        if (keep) {
+            pixmaps.insert(key, new QPixmap(pixmap), 1);
+        }
+    }
+
+    for (const Waiter& waiter : waiters) {
+        if (waiter.receiver) {
+            waiter.callback(pixmap);
+        }
+    }
+}
+
+void ImageService::failFetch(const ImageKey& key) {
+    QList<Waiter> waiters = inFlight.take(key);
+    forgotten.remove(key);
+
+    // Waiters repaint and ask again, which waits out the retry delay
+    QPixmap pixmap = placeholder(key.size, key.dpr);
+    for (const Waiter& waiter : waiters) {
+        if (waiter.receiver) {
+            waiter.callback(pixmap);
+        }
+    }
+}
+
+QPixmap ImageService::placeholder(const QSize& size, qreal dpr) {
+    ImageKey key{NO_IMAGE_ID, size, dpr};
+    auto it = placeholders.constFind(key);
+    if (it != placeholders.constEnd()) {
+        return it.value();
+    }
+
+    QPixmap pixmap(size * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor("#f0f0f0"));
+    painter.drawRoundedRect(QRect(QPoint(0, 0), size), 8, 8);
+    painter.end();
+
+    placeholders.insert(key, pixmap);
+    return pixmap;
+}
+
+void ImageService::setCacheLimit(int kilobytes) {
+    pixmaps.setMaxCost(kilobytes);
+}
+
+int ImageService::cacheLimit() const {
+    return pixmaps.maxCost();
+}
+
+void ImageService::clear() {
+    pixmaps.clear();
+}
+
+void ImageService::forget(const QSet<int>& productIds) {
+    if (productIds.isEmpty()) {
+        return;
+    }
+    const QList<ImageKey> keys = pixmaps.keys();
+    for (const ImageKey& key : keys) {
+        if (productIds.contains(key.productId)) {
+            pixmaps.remove(key);
+        }
+    }
+    for (auto it = inFlight.cbegin(); it != inFlight.cend(); ++it) {
+        if (productIds.contains(it.key().productId)) {
+            forgotten.insert(it.key());
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef IMAGESERVICE_H
+#define IMAGESERVICE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QPixmap>
+#include <QPointer>
+#include <QSet>
+#include <QSize>
+#include <QThreadPool>
+#include <QUrl>
+#include <functional>
+
+// Identifies one decoded rendition of a product image
+struct ImageKey {
+    int productId;
+    QSize size;     // Logical size the image is scaled to fit
+    qreal dpr;      // Device pixel ratio it is rendered for
+
+    bool operator==(const ImageKey& other) const {
+        return productId == other.productId && size == other.size && qFuzzyCompare(dpr, other.dpr);
+    }
+};
+
+size_t qHash(const ImageKey& key, size_t seed = 0);
+
+// Decodes and scales product images on a worker pool and keeps the results
+// in an LRU cache bounded by bytes. request() returns at once: either the
+// cached pixmap, or a null pixmap while the decode runs, in which case the
+// callback is invoked on the GUI thread once the image is ready. Requests for
+// a key that is already being decoded share that decode. requestUrl() does
+// the same for products whose image lives at Product::imageUrl, fetching the
+// bytes through RemoteImageLoader before decoding; a failed fetch is not
+// cached but retried with a growing delay. requestStored() does the same for
+// products loaded without their image_data, reading it on the worker.
+class ImageService : public QObject {
+    Q_OBJECT
+
+public:
+    typedef std::function<void(const QPixmap&)> Callback;
+
+    static ImageService& getInstance();
+
+    // The callback is dropped if receiver is destroyed before the decode finishes
+    QPixmap request(int productId, const QByteArray& imageData, const QSize& size, qreal dpr,
+                    QObject* receiver, Callback callback);
+    QPixmap requestUrl(int productId, const QUrl& imageUrl, const QSize& size, qreal dpr,
+                       QObject* receiver, Callback callback);
+    QPixmap requestStored(int productId, const QSize& size, qreal dpr, QObject* receiver, Callback callback);
+    QPixmap cached(int productId, const QSize& size, qreal dpr) const;
+
+    // Shown until a request completes
+    QPixmap placeholder(const QSize& size, qreal dpr);
+
+    void setCacheLimit(int kilobytes);
+    int cacheLimit() const;
+    void clear();
+    // Drops every rendition of these products, e.g. after their image changed;
+    // decodes already running for them are delivered but not cached
+    void forget(const QSet<int>& productIds);
+
+private:
+    explicit ImageService(QObject *parent = nullptr);
+    ImageService(const ImageService&) = delete;
+    ImageService& operator=(const ImageService&) = delete;
+
+    struct Waiter {
+        QPointer<QObject> receiver;
+        Callback callback;
+    };
+
+    struct FetchRetry {
+        int failures;
+        qint64 retryAtMs;  // Since the Unix epoch
+
+        FetchRetry() : failures(0), retryAtMs(0) {}
+    };
+
+    // Adds a waiter for key; true if nobody was waiting yet and work must start
+    bool enqueue(const ImageKey& key, QObject* receiver, const Callback& callback);
+    void startDecode(const ImageKey& key, const QByteArray& imageData);
+    void startFetch(const ImageKey& key, const QUrl& imageUrl);
+    static QImage decode(const QByteArray& imageData, const QSize& pixelSize);
+    void finishDecode(const ImageKey& key, const QImage& image, qreal dpr);
+    // Hands the waiters the placeholder without caching it
+    void failFetch(const ImageKey& key);
+
+    static const int DEFAULT_CACHE_KB = 64 * 1024;
+    static const int RETRY_BASE_MS = 2000;
+    static const int RETRY_MAX_MS = 5 * 60 * 1000;
+
+    QCache<ImageKey, QPixmap> pixmaps;       // Cost in KB
+    QHash<ImageKey, QList<Waiter>> inFlight;
+    QSet<ImageKey> forgotten;                // In flight when forget() ran
+    QHash<QUrl, FetchRetry> failedFetches;
+    QHash<ImageKey, QPixmap> placeholders;
+    QThreadPool workers;
+};
+
+#endif // IMAGESERVICE_H
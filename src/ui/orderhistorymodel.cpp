@@ -0,0 +1,103 @@
+#include "orderhistorymodel.h"
+
+OrderHistoryModel::OrderHistoryModel(StorageBackend& storage, QObject *parent)
+    : QAbstractTableModel(parent)
+    , storage(storage)
+    , userId(-1)
+    , exhausted(true)
+{
+}
+
+int OrderHistoryModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : rows.size();
+}
+
+int OrderHistoryModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant OrderHistoryModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= rows.size()) {
+        return QVariant();
+    }
+
+    const Row& row = rows.at(index.row());
+    const OrderSummary& order = row.summary;
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case IdColumn: return QString::number(order.id);
+        case DateColumn: return order.orderDateTime().toString("yyyy-MM-dd hh:mm:ss");
+        case StatusColumn: return order.status;
+        case ItemsColumn: return QString("%1 items").arg(order.itemCount);
+        case TotalColumn: return QString("$%1").arg(order.totalAmount, 0, 'f', 2);
+        default: return QVariant();
+        }
+    case OrderIdRole:
+        return order.id;
+    case StatusRole:
+        return int(row.status);
+    default:
+        return QVariant();
+    }
+}
+
+QVariant OrderHistoryModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    switch (section) {
+    case IdColumn: return "Order ID";
+    case DateColumn: return "Date";
+    case StatusColumn: return "Status";
+    case ItemsColumn: return "Items";
+    case TotalColumn: return "Total";
+    default: return QVariant();
+    }
+}
+
+bool OrderHistoryModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && !exhausted;
+}
+
+void OrderHistoryModel::fetchMore(const QModelIndex& parent) {
+    if (parent.isValid() || exhausted) {
+        return;
+    }
+
+    OrderSummary after = rows.isEmpty() ? OrderSummary() : rows.last().summary;
+    QList<OrderSummary> page = storage.getUserOrderSummaries(userId, from, to, status, after, PAGE_SIZE);
+    // A short page means the query has run out of rows
+    exhausted = page.size() < PAGE_SIZE;
+    if (page.isEmpty()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), rows.size(), rows.size() + page.size() - 1);
+    rows.reserve(rows.size() + page.size());
+    for (const OrderSummary& order : page) {
+        rows.append(Row{order, orderStatusFromString(order.status)});
+    }
+    endInsertRows();
+}
+
+void OrderHistoryModel::setQuery(int newUserId, const QDateTime& newFrom, const QDateTime& newTo,
+                                 const QString& newStatus) {
+    beginResetModel();
+    userId = newUserId;
+    from = newFrom;
+    to = newTo;
+    status = newStatus;
+    rows.clear();
+    exhausted = userId == -1;
+    endResetModel();
+    fetchMore(QModelIndex());
+}
+
+void OrderHistoryModel::clear() {
+    setQuery(-1);
+}
+
+int OrderHistoryModel::orderIdAt(int row) const {
+    return row >= 0 && row < rows.size() ? rows.at(row).summary.id : -1;
+}
@@ -0,0 +1,64 @@
+#ifndef ORDERHISTORYMODEL_H
+#define ORDERHISTORYMODEL_H
+
+#include "../database/storagebackend.h"
+#include <QAbstractTableModel>
+#include <QDateTime>
+#include <QVector>
+
+// A user's orders, newest first, read from storage one page at a time as the
+// view scrolls (canFetchMore/fetchMore). Status, date range and user go into
+// one query; each page continues after the last loaded row instead of using
+// an OFFSET, so later pages cost the same as the first.
+class OrderHistoryModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        IdColumn,
+        DateColumn,
+        StatusColumn,
+        ItemsColumn,
+        TotalColumn,
+        ColumnCount
+    };
+
+    enum Roles {
+        OrderIdRole = Qt::UserRole + 1,
+        StatusRole      // OrderStatus as an int
+    };
+
+    explicit OrderHistoryModel(StorageBackend& storage, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    // Drops the loaded rows and loads the first page; a userId of -1 leaves
+    // the model empty. Null dates and an empty status leave that filter off.
+    void setQuery(int userId, const QDateTime& from = QDateTime(), const QDateTime& to = QDateTime(),
+                  const QString& status = QString());
+    void clear();
+    int orderIdAt(int row) const;
+
+private:
+    struct Row {
+        OrderSummary summary;
+        OrderStatus status;     // Parsed once so painting never compares strings
+    };
+
+    static const int PAGE_SIZE = 100;
+
+    StorageBackend& storage;
+    int userId;
+    QDateTime from;
+    QDateTime to;
+    QString status;
+    QVector<Row> rows;
+    bool exhausted;
+};
+
+#endif // ORDERHISTORYMODEL_H
@@ -1,5 +1,6 @@
 #include "orderhistorypage.h"
 #include <QHeaderView>
+#include <QTableWidget>
 #include <QMessageBox>
 #include <QDebug>
 #include <QDialog>
@@ -20,13 +21,14 @@
 OrderHistoryPage::OrderHistoryPage(QWidget *parent)
     : ProtectedPage(parent)
     , ordersTable(nullptr)
+    , ordersModel(nullptr)
     , statusFilter(nullptr)
     , startDateFilter(nullptr)
     , endDateFilter(nullptr)
     , filterButton(nullptr)
     , resetButton(nullptr)
     , mainLayout(nullptr)
-    , dbManager(DatabaseManager::getInstance())
+    , dbManager(StorageBackend::getInstance())
     , authManager(AuthManager::getInstance())
 {
     qDebug() << "OrderHistoryPage constructor called";
@@ -303,22 +305,24 @@ void OrderHistoryPage::setupUI()
 
     mainLayout->addWidget(filterWidget);
     
-    // Orders table with modern styling
-    ordersTable = new QTableWidget(this);
+    // Orders table with modern styling; rows are paged in as it scrolls
+    ordersModel = new OrderHistoryModel(dbManager, this);
+    ordersTable = new QTableView(this);
+    ordersTable->setModel(ordersModel);
     ordersTable->setStyleSheet(
-        "QTableWidget {"
+        "QTableView {"
         "    background-color: white;"
         "    border: 1px solid #e0e0e0;"
         "    border-radius: 15px;"
         "    gridline-color: #f0f0f0;"
         "}"
-        "QTableWidget::item {"
+        "QTableView::item {"
         "    padding: 10px 8px;"
         "    border-bottom: 1px solid #f0f0f0;"
         "    color: #2c3e50;"
         "    font-size: 12px;"
         "}"
-        "QTableWidget::item:selected {"
+        "QTableView::item:selected {"
         "    background-color: #3498db15;"
         "    color: #2c3e50;"
         "    border-radius: 8px;"
@@ -338,18 +342,10 @@ void OrderHistoryPage::setupUI()
         "}"
     );
     
-    ordersTable->setColumnCount(5);
-    ordersTable->setHorizontalHeaderLabels({
-        "Order ID",
-        "Date",
-        "Status",
-        "Items",
-        "Total"
-    });
-    
     ordersTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
-    ordersTable->setSelectionBehavior(QTableWidget::SelectRows);
-    ordersTable->setSelectionMode(QTableWidget::SingleSelection);
+    ordersTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ordersTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    ordersTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     ordersTable->verticalHeader()->setVisible(false);
     ordersTable->setShowGrid(false);
     ordersTable->setAlternatingRowColors(true);
@@ -368,9 +364,8 @@ void OrderHistoryPage::setupUI()
     );
     mainLayout->addWidget(infoLabel);
     
-    connect(ordersTable, &QTableWidget::itemDoubleClicked, this, [this](QTableWidgetItem* item) {
-        int orderId = ordersTable->item(item->row(), 0)->text().toInt();
-        viewOrderDetails(orderId);
+    connect(ordersTable, &QTableView::doubleClicked, this, [this](const QModelIndex& index) {
+        viewOrderDetails(ordersModel->orderIdAt(index.row()));
     });
     
     setLayout(mainLayout);
@@ -379,52 +374,19 @@ void OrderHistoryPage::setupUI()
 void OrderHistoryPage::loadOrders()
 {
     qDebug() << "loadOrders() called";
-    ordersTable->setRowCount(0);
     
     int userId = authManager.getCurrentUserId();
     qDebug() << "Current user ID:" << userId;
     
     if (userId == -1) {
         qDebug() << "User not authenticated, redirecting to login...";
+        ordersModel->clear();
         emit loginRequired();
         return;
     }
     
-    QList<Order> orders = dbManager.getUserOrders(userId);
-    qDebug() << "Found" << orders.size() << "orders";
-    
-    for (const Order& order : orders) {
-        int row = ordersTable->rowCount();
-        ordersTable->insertRow(row);
-        
-        // Order ID
-        QTableWidgetItem* idItem = new QTableWidgetItem(QString::number(order.id));
-        idItem->setFlags(idItem->flags() & ~Qt::ItemIsEditable);
-        ordersTable->setItem(row, 0, idItem);
-        
-        // Date
-        QTableWidgetItem* dateItem = new QTableWidgetItem(
-            order.orderDate.toString("yyyy-MM-dd hh:mm:ss"));
-        dateItem->setFlags(dateItem->flags() & ~Qt::ItemIsEditable);
-        ordersTable->setItem(row, 1, dateItem);
-        
-        // Status
-        QTableWidgetItem* statusItem = new QTableWidgetItem(order.status);
-        statusItem->setFlags(statusItem->flags() & ~Qt::ItemIsEditable);
-        ordersTable->setItem(row, 2, statusItem);
-        
-        // Items count
-        QTableWidgetItem* itemsItem = new QTableWidgetItem(
-            QString("%1 items").arg(order.items.size()));
-        itemsItem->setFlags(itemsItem->flags() & ~Qt::ItemIsEditable);
-        ordersTable->setItem(row, 3, itemsItem);
-        
-        // Total
-        QTableWidgetItem* totalItem = new QTableWidgetItem(
-            QString("$%1").arg(order.totalAmount, 0, 'f', 2));
-        totalItem->setFlags(totalItem->flags() & ~Qt::ItemIsEditable);
-        ordersTable->setItem(row, 4, totalItem);
-    }
+    // Summaries only; the items are loaded when an order is opened
+    ordersModel->setQuery(userId);
 }
 
 void OrderHistoryPage::updateOrders()
@@ -450,44 +412,8 @@ void OrderHistoryPage::filterOrders()
     QDateTime startDate = startDateFilter->dateTime();
     QDateTime endDate = endDateFilter->dateTime();
     
-    QList<Order> orders;
-    if (!status.isEmpty()) {
-        orders = dbManager.getUserOrdersByStatus(userId, status);
-    } else {
-        orders = dbManager.getUserOrdersByDateRange(userId, startDate, endDate);
-    }
-    
-    ordersTable->setRowCount(0);
-    for (const Order& order : orders) {
-        if ((status.isEmpty() || order.status == status) &&
-            order.orderDate >= startDate && order.orderDate <= endDate) {
-            int row = ordersTable->rowCount();
-            ordersTable->insertRow(row);
-            
-            QTableWidgetItem* idItem = new QTableWidgetItem(QString::number(order.id));
-            idItem->setFlags(idItem->flags() & ~Qt::ItemIsEditable);
-            ordersTable->setItem(row, 0, idItem);
-            
-            QTableWidgetItem* dateItem = new QTableWidgetItem(
-                order.orderDate.toString("yyyy-MM-dd hh:mm:ss"));
-            dateItem->setFlags(dateItem->flags() & ~Qt::ItemIsEditable);
-            ordersTable->setItem(row, 1, dateItem);
-            
-            QTableWidgetItem* statusItem = new QTableWidgetItem(order.status);
-            statusItem->setFlags(statusItem->flags() & ~Qt::ItemIsEditable);
-            ordersTable->setItem(row, 2, statusItem);
-            
-            QTableWidgetItem* itemsItem = new QTableWidgetItem(
-                QString("%1 items").arg(order.items.size()));
-            itemsItem->setFlags(itemsItem->flags() & ~Qt::ItemIsEditable);
-            ordersTable->setItem(row, 3, itemsItem);
-            
-            QTableWidgetItem* totalItem = new QTableWidgetItem(
-                QString("$%1").arg(order.totalAmount, 0, 'f', 2));
-            totalItem->setFlags(totalItem->flags() & ~Qt::ItemIsEditable);
-            ordersTable->setItem(row, 4, totalItem);
-        }
-    }
+    // Both filters are applied in one indexed query
+    ordersModel->setQuery(userId, startDate, endDate, status);
 }
 
 void OrderHistoryPage::resetFilters()
@@ -581,7 +507,7 @@ void OrderHistoryPage::showOrderDetailsDialog(const Order& order)
         infoLayout->addWidget(valueWidget, row, 1);
     };
     
-    addInfoRow(0, "Order Date:", order.orderDate.toString("MMMM d, yyyy hh:mm:ss"));
+    addInfoRow(0, "Order Date:", order.orderDateTime().toString("MMMM d, yyyy hh:mm:ss"));
     addInfoRow(1, "Status:", getStatusWithIcon(order.status));
     
     layout->addWidget(infoContainer);
@@ -693,33 +619,46 @@ void OrderHistoryPage::showOrderDetailsDialog(const Order& order)
 
 QString OrderHistoryPage::getStatusWithIcon(const QString& status)
 {
-    if (status == "Pending") return "🕒 Pending";
-    if (status == "Processing") return "⚙️ Processing";
-    if (status == "Shipped") return "🚚 Shipped";
-    if (status == "Delivered") return "✅ Delivered";
-    if (status == "Cancelled") return "❌ Cancelled";
-    return status;
+    OrderStatus known = orderStatusFromString(status);
+    return known == OrderStatus::Unknown ? status : getStatusWithIcon(known);
 }
 
-QColor OrderHistoryPage::getStatusColor(const QString& status)
+QString OrderHistoryPage::getStatusWithIcon(OrderStatus status)
 {
-    if (status == "Pending") return QColor("#f39c12");
-    if (status == "Processing") return QColor("#3498db");
-    if (status == "Shipped") return QColor("#2ecc71");
-    if (status == "Delivered") return QColor("#27ae60");
-    if (status == "Cancelled") return QColor("#e74c3c");
-    return QColor("#95a5a6");
+    switch (status) {
+    case OrderStatus::Pending: return "🕒 Pending";
+    case OrderStatus::Processing: return "⚙️ Processing";
+    case OrderStatus::Shipped: return "🚚 Shipped";
+    case OrderStatus::Delivered: return "✅ Delivered";
+    case OrderStatus::Cancelled: return "❌ Cancelled";
+    default: return QString();
+    }
+}
+
+QColor OrderHistoryPage::getStatusColor(OrderStatus status)
+{
+    switch (status) {
+    case OrderStatus::Pending: return QColor("#f39c12");
+    case OrderStatus::Processing: return QColor("#3498db");
+    case OrderStatus::Shipped: return QColor("#2ecc71");
+    case OrderStatus::Delivered: return QColor("#27ae60");
+    case OrderStatus::Cancelled: return QColor("#e74c3c");
+    default: return QColor("#95a5a6");
+    }
 }
 
 void OrderTableItemDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
 {
-    if (index.column() == 2) { // Status column
+    if (index.column() == OrderHistoryModel::StatusColumn) {
         QStyleOptionViewItem opt = option;
         initStyleOption(&opt, index);
         
-        // Get the status text
-        QString status = index.data().toString();
+        // The model parses the status once; painting only switches on it
+        OrderStatus status = static_cast<OrderStatus>(index.data(OrderHistoryModel::StatusRole).toInt());
         QString displayText = OrderHistoryPage::getStatusWithIcon(status);
+        if (displayText.isEmpty()) {
+            displayText = index.data().toString();
+        }
         
         // Draw with custom colors
         painter->save();
@@ -826,7 +765,7 @@ bool OrderHistoryPage::submitReview(int productId, int rating, const QString& co
     review.username = authManager.getCurrentUserEmail();
     review.rating = rating;
     review.comment = comment;
-    review.reviewDate = QDateTime::currentDateTime();
+    review.reviewDate = QDateTime::currentMSecsSinceEpoch();
     
     // Check if user has already reviewed this product
     Review existingReview = dbManager.getUserProductReview(userId, productId);
@@ -2,9 +2,10 @@
 #define ORDERHISTORYPAGE_H
 
 #include "protectedpage.h"
-#include "../database/databasemanager.h"
+#include "../database/storagebackend.h"
 #include "../auth/authmanager.h"
-#include <QTableWidget>
+#include "orderhistorymodel.h"
+#include <QTableView>
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QLabel>
@@ -33,7 +34,8 @@ class OrderHistoryPage : public ProtectedPage {
 public:
     explicit OrderHistoryPage(QWidget *parent = nullptr);
     static QString getStatusWithIcon(const QString& status);
-    static QColor getStatusColor(const QString& status);
+    static QString getStatusWithIcon(OrderStatus status);
+    static QColor getStatusColor(OrderStatus status);
 
 signals:
     void loginRequired();
@@ -56,14 +58,15 @@ private:
     void showOrderDetailsDialog(const Order& order);
     void setupReviewDialog(QDialog& dialog, int& rating, QString& comment);
 
-    QTableWidget* ordersTable;
+    QTableView* ordersTable;
+    OrderHistoryModel* ordersModel;
     QComboBox* statusFilter;
     QDateTimeEdit* startDateFilter;
     QDateTimeEdit* endDateFilter;
     QPushButton* filterButton;
     QPushButton* resetButton;
     QVBoxLayout* mainLayout;
-    DatabaseManager& dbManager;
+    StorageBackend& dbManager;
     AuthManager& authManager;
 };
 
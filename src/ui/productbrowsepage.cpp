@@ -2,464 +2,57 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QMessageBox>
-#include <QNetworkReply>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QImage>
 #include <QPixmap>
 #include <QBuffer>
-#include <QMouseEvent>
 #include <QDialog>
 #include <QPushButton>
 #include <QSpinBox>
 #include <QLabel>
+#include <QDir>
 #include "../database/databasemanager.h"
 #include "../auth/authmanager.h"
-
-// ProductWidget implementation
-ProductWidget::ProductWidget(const Product& product, QWidget* parent)
-    : QWidget(parent)
-    , product(product)
-    , imageLabel(nullptr)
-    , nameLabel(nullptr)
-    , priceLabel(nullptr)
-    , ratingLabel(nullptr)
-    , dbManager(DatabaseManager::getInstance())
-{
-    setupUI();
-}
-
-void ProductWidget::mousePressEvent(QMouseEvent* event)
+#include "imageservice.h"
+#include "cartmodel.h"
+
+namespace {
+// The catalog carries only whether a product has stored image bytes. Those
+// are written once with the product and ids are never reused, so the flag and
+// the URL are enough to tell whether a cached rendition is still current.
+bool sameImage(const Product& a, const Product& b)
 {
-    if (event->button() == Qt::LeftButton) {
-        emit clicked(product);
+    if (a.imageUrl != b.imageUrl) {
+        return false;
     }
-    QWidget::mousePressEvent(event);
-}
-
-void ProductWidget::setupUI()
-{
-    QVBoxLayout* layout = new QVBoxLayout(this);
-    layout->setAlignment(Qt::AlignCenter);
-    layout->setSpacing(8);
-    layout->setContentsMargins(15, 15, 15, 15);
-    
-    // Image container with fixed size and shadow effect
-    QWidget* imageContainer = new QWidget(this);
-    imageContainer->setFixedSize(220, 220);
-    imageContainer->setStyleSheet(
-        "QWidget {"
-        "    background-color: white;"
-        "    border-radius: 10px;"
-        "    border: 1px solid #e0e0e0;"
-        "}"
-    );
-    QVBoxLayout* imageLayout = new QVBoxLayout(imageContainer);
-    imageLayout->setContentsMargins(10, 10, 10, 10);
-    
-    imageLabel = new QLabel(imageContainer);
-    imageLabel->setAlignment(Qt::AlignCenter);
-    QPixmap pixmap;
-    if (!product.imageData.isEmpty()) {
-        pixmap.loadFromData(product.imageData);
-    } else {
-        pixmap = QPixmap(":/images/no-image.png");
+    if ((a.hasImageData || !a.imageData.isEmpty()) != (b.hasImageData || !b.imageData.isEmpty())) {
+        return false;
     }
-    pixmap = pixmap.scaled(200, 200, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    imageLabel->setPixmap(pixmap);
-    imageLayout->addWidget(imageLabel);
-    layout->addWidget(imageContainer);
-    
-    // Category label with background
-    QLabel* categoryLabel = new QLabel(product.category, this);
-    categoryLabel->setAlignment(Qt::AlignCenter);
-    categoryLabel->setStyleSheet(
-        "QLabel {"
-        "    background-color: #f0f0f0;"
-        "    color: #666666;"
-        "    padding: 4px 8px;"
-        "    border-radius: 4px;"
-        "    font-size: 12px;"
-        "}"
-    );
-    layout->addWidget(categoryLabel);
-    
-    // Product name with improved visibility
-    nameLabel = new QLabel(product.name, this);
-    nameLabel->setAlignment(Qt::AlignCenter);
-    nameLabel->setStyleSheet(
-        "QLabel {"
-        "    color: #2c3e50;"
-        "    font-weight: bold;"
-        "    font-size: 16px;"
-        "    margin: 5px 0;"
-        "}"
-    );
-    nameLabel->setWordWrap(true);
-    layout->addWidget(nameLabel);
-    
-    // Seller name with icon
-    QString sellerName = dbManager.getUserById(product.sellerId).getUsername();
-    QLabel* sellerLabel = new QLabel(QString("👤 %1").arg(sellerName), this);
-    sellerLabel->setAlignment(Qt::AlignCenter);
-    sellerLabel->setStyleSheet(
-        "QLabel {"
-        "    color: #7f8c8d;"
-        "    font-size: 13px;"
-        "}"
-    );
-    layout->addWidget(sellerLabel);
-    
-    // Price with improved visibility
-    priceLabel = new QLabel(QString("$%1").arg(product.price, 0, 'f', 2), this);
-    priceLabel->setAlignment(Qt::AlignCenter);
-    priceLabel->setStyleSheet(
-        "QLabel {"
-        "    color: #27ae60;"
-        "    font-size: 18px;"
-        "    font-weight: bold;"
-        "    margin: 5px 0;"
-        "}"
-    );
-    layout->addWidget(priceLabel);
-    
-    // Stock information with icon
-    QLabel* quantityLabel = new QLabel(QString("📦 Available: %1").arg(product.stock), this);
-    quantityLabel->setAlignment(Qt::AlignCenter);
-    quantityLabel->setStyleSheet(
-        "QLabel {"
-        "    color: #e74c3c;"
-        "    font-size: 13px;"
-        "    font-weight: bold;"
-        "}"
-    );
-    layout->addWidget(quantityLabel);
-    
-    // Rating with improved visibility
-    double avgRating = dbManager.getProductAverageRating(product.id);
-    QList<Review> reviews = dbManager.getProductReviews(product.id);
-    QString ratingText = avgRating > 0 
-        ? QString("★ %1/5 (%2 reviews)").arg(avgRating, 0, 'f', 1).arg(reviews.size())
-        : "No reviews yet";
-    ratingLabel = new QLabel(ratingText, this);
-    ratingLabel->setAlignment(Qt::AlignCenter);
-    ratingLabel->setStyleSheet(
-        "QLabel {"
-        "    color: #f39c12;"
-        "    font-size: 13px;"
-        "    margin: 5px 0;"
-        "}"
-    );
-    layout->addWidget(ratingLabel);
-    
-    // Buttons container with improved styling
-    QWidget* buttonsContainer = new QWidget(this);
-    QVBoxLayout* buttonsLayout = new QVBoxLayout(buttonsContainer);
-    buttonsLayout->setSpacing(8);
-    
-    // Add to Cart button with improved styling
-    QPushButton* addToCartButton = new QPushButton("🛒 Add to Cart", this);
-    addToCartButton->setStyleSheet(
-        "QPushButton {"
-        "    background-color: #2ecc71;"
-        "    color: white;"
-        "    border: none;"
-        "    padding: 10px;"
-        "    border-radius: 5px;"
-        "    font-weight: bold;"
-        "    font-size: 14px;"
-        "}"
-        "QPushButton:hover {"
-        "    background-color: #27ae60;"
-        "}"
-        "QPushButton:pressed {"
-        "    background-color: #219a52;"
-        "}"
-    );
-    connect(addToCartButton, &QPushButton::clicked, [this]() {
-        emit addToCartClicked(product);
-    });
-    buttonsLayout->addWidget(addToCartButton);
-    
-    // View Reviews button with improved styling
-    QPushButton* viewReviewsBtn = new QPushButton("⭐ View Reviews", this);
-    viewReviewsBtn->setStyleSheet(
-        "QPushButton {"
-        "    background-color: #3498db;"
-        "    color: white;"
-        "    border: none;"
-        "    padding: 10px;"
-        "    border-radius: 5px;"
-        "    font-weight: bold;"
-        "    font-size: 14px;"
-        "}"
-        "QPushButton:hover {"
-        "    background-color: #2980b9;"
-        "}"
-        "QPushButton:pressed {"
-        "    background-color: #2472a4;"
-        "}"
-    );
-    connect(viewReviewsBtn, &QPushButton::clicked, this, &ProductWidget::showReviewsDialog);
-    buttonsLayout->addWidget(viewReviewsBtn);
-    
-    layout->addWidget(buttonsContainer);
-    
-    // Main widget styling
-    setLayout(layout);
-    setFixedSize(300, 520); // Increased size for better spacing
-    setStyleSheet(
-        "ProductWidget {"
-        "    background-color: white;"
-        "    border: 1px solid #e0e0e0;"
-        "    border-radius: 12px;"
-        "    padding: 5px;"
-        "}"
-        "ProductWidget:hover {"
-        "    border: 2px solid #3498db;"
-        "    background-color: #f8f9fa;"
-        "}"
-    );
-    setCursor(Qt::PointingHandCursor);
-}
-
-void ProductWidget::showReviewsDialog()
-{
-    QDialog dialog(this);
-    dialog.setWindowTitle(QString("Reviews for %1").arg(product.name));
-    dialog.setModal(true);
-    dialog.resize(500, 400);
-    
-    QVBoxLayout* layout = new QVBoxLayout(&dialog);
-    
-    // Product info section
-    QHBoxLayout* productInfoLayout = new QHBoxLayout();
-    
-    // Product image
-    QLabel* productImage = new QLabel(&dialog);
-    QPixmap pixmap;
-    if (!product.imageData.isEmpty()) {
-        pixmap.loadFromData(product.imageData);
-    } else {
-        pixmap = QPixmap(":/images/no-image.png");
+    if (!a.imageData.isEmpty() && !b.imageData.isEmpty()) {
+        return a.imageData == b.imageData;
     }
-    pixmap = pixmap.scaled(100, 100, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    productImage->setPixmap(pixmap);
-    productInfoLayout->addWidget(productImage);
-    
-    // Product details
-    QVBoxLayout* productDetailsLayout = new QVBoxLayout();
-    QLabel* nameLabel = new QLabel(product.name, &dialog);
-    nameLabel->setStyleSheet("font-size: 16px; font-weight: bold;");
-    productDetailsLayout->addWidget(nameLabel);
-    
-    double avgRating = dbManager.getProductAverageRating(product.id);
-    QList<Review> reviews = dbManager.getProductReviews(product.id);
-    
-    QString ratingText = avgRating > 0 
-        ? QString("★ %1/5 (%2 reviews)").arg(avgRating, 0, 'f', 1).arg(reviews.size())
-        : "No reviews yet";
-    QLabel* ratingLabel = new QLabel(ratingText, &dialog);
-    ratingLabel->setStyleSheet("color: #f39c12;");
-    productDetailsLayout->addWidget(ratingLabel);
-    
-    productInfoLayout->addLayout(productDetailsLayout);
-    productInfoLayout->addStretch();
-    layout->addLayout(productInfoLayout);
-    
-    // Add Review button (only if user is logged in)
-    AuthManager& authManager = AuthManager::getInstance();
-    if (authManager.getCurrentUserId() != -1) {
-        QPushButton* addReviewBtn = new QPushButton("Write a Review", &dialog);
-        addReviewBtn->setStyleSheet(
-            "QPushButton {"
-            "    background-color: #2ecc71;"
-            "    color: white;"
-            "    border: none;"
-            "    padding: 8px;"
-            "    border-radius: 4px;"
-            "}"
-            "QPushButton:hover {"
-            "    background-color: #27ae60;"
-            "}"
-        );
-        connect(addReviewBtn, &QPushButton::clicked, [this, &dialog]() {
-            dialog.close();
-            showAddReviewDialog();
-        });
-        layout->addWidget(addReviewBtn);
-    }
-    
-    // Separator line
-    QFrame* line = new QFrame(&dialog);
-    line->setFrameShape(QFrame::HLine);
-    line->setFrameShadow(QFrame::Sunken);
-    layout->addWidget(line);
-    
-    // Reviews section
-    QScrollArea* scrollArea = new QScrollArea(&dialog);
-    QWidget* scrollContent = new QWidget(scrollArea);
-    QVBoxLayout* reviewsLayout = new QVBoxLayout(scrollContent);
-    
-    setupReviewsSection(reviewsLayout, reviews);
-    
-    reviewsLayout->addStretch();
-    scrollContent->setLayout(reviewsLayout);
-    scrollArea->setWidget(scrollContent);
-    scrollArea->setWidgetResizable(true);
-    layout->addWidget(scrollArea);
-    
-    // Close button
-    QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, &dialog);
-    connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
-    layout->addWidget(buttonBox);
-    
-    dialog.setLayout(layout);
-    dialog.exec();
+    return true;
 }
-
-void ProductWidget::setupReviewsSection(QVBoxLayout* layout, const QList<Review>& reviews) {
-    for (const Review& review : reviews) {
-        QFrame* reviewCard = new QFrame();
-        reviewCard->setFrameStyle(QFrame::StyledPanel);
-        reviewCard->setStyleSheet("QFrame { background-color: #f5f5f5; border-radius: 8px; margin: 4px; padding: 8px; }"
-                                "QLabel { color: #333333; }");
-
-        QVBoxLayout* reviewLayout = new QVBoxLayout(reviewCard);
-
-        // Header with user and date
-        QHBoxLayout* headerLayout = new QHBoxLayout();
-        QLabel* userLabel = new QLabel(review.username);
-        userLabel->setStyleSheet("font-weight: bold; color: #333333;");
-        
-        QLabel* dateLabel = new QLabel(review.reviewDate.toString("yyyy-MM-dd"));
-        dateLabel->setStyleSheet("color: #666666;");
-        
-        headerLayout->addWidget(userLabel);
-        headerLayout->addStretch();
-        headerLayout->addWidget(dateLabel);
-
-        // Rating display
-        QString stars;
-        for (int i = 0; i < review.rating; i++) stars += "★";
-        for (int i = review.rating; i < 5; i++) stars += "☆";
-        QLabel* ratingLabel = new QLabel(stars);
-        ratingLabel->setStyleSheet("color: #ffd700;"); // Gold color for stars
-
-        // Review text
-        QLabel* commentLabel = new QLabel(review.comment);
-        commentLabel->setWordWrap(true);
-        commentLabel->setStyleSheet("color: #333333; margin-top: 4px;");
-        
-        reviewLayout->addLayout(headerLayout);
-        reviewLayout->addWidget(ratingLabel);
-        reviewLayout->addWidget(commentLabel);
-
-        layout->addWidget(reviewCard);
-    }
-
-    if (reviews.isEmpty()) {
-        QLabel* noReviewsLabel = new QLabel("No reviews yet");
-        noReviewsLabel->setStyleSheet("color: #666666; padding: 20px;");
-        noReviewsLabel->setAlignment(Qt::AlignCenter);
-        layout->addWidget(noReviewsLabel);
-    }
-}
-
-void ProductWidget::showAddReviewDialog()
-{
-    AuthManager& authManager = AuthManager::getInstance();
-    int userId = authManager.getCurrentUserId();
-    if (userId == -1) {
-        QMessageBox::warning(this, "Login Required", "Please log in to write a review.");
-        return;
-    }
-    
-    // Check if user has already reviewed this product
-    Review existingReview = dbManager.getUserProductReview(userId, product.id);
-    
-    QDialog* dialog = new QDialog(this);
-    dialog->setWindowTitle(existingReview.id != -1 ? "Update Review" : "Write a Review");
-    dialog->setModal(true);
-    
-    QVBoxLayout* layout = new QVBoxLayout(dialog);
-    
-    // Rating
-    QHBoxLayout* ratingLayout = new QHBoxLayout();
-    QLabel* ratingLabel = new QLabel("Rating:", dialog);
-    QSpinBox* ratingSpinBox = new QSpinBox(dialog);
-    ratingSpinBox->setRange(1, 5);
-    ratingSpinBox->setValue(existingReview.id != -1 ? existingReview.rating : 5);
-    ratingSpinBox->setPrefix("★ ");
-    ratingLayout->addWidget(ratingLabel);
-    ratingLayout->addWidget(ratingSpinBox);
-    layout->addLayout(ratingLayout);
-    
-    // Comment
-    QLabel* commentLabel = new QLabel("Your Review:", dialog);
-    layout->addWidget(commentLabel);
-    
-    QTextEdit* commentEdit = new QTextEdit(dialog);
-    commentEdit->setPlaceholderText("Write your review here...");
-    if (existingReview.id != -1) {
-        commentEdit->setText(existingReview.comment);
-    }
-    layout->addWidget(commentEdit);
-    
-    // Buttons
-    QDialogButtonBox* buttonBox = new QDialogButtonBox(
-        QDialogButtonBox::Ok | QDialogButtonBox::Cancel,
-        dialog
-    );
-    
-    // Connect the accepted signal to a lambda that validates and submits the review
-    connect(buttonBox, &QDialogButtonBox::accepted, [this, dialog, ratingSpinBox, commentEdit, existingReview, userId, &authManager]() {
-        QString comment = commentEdit->toPlainText().trimmed();
-        if (comment.isEmpty()) {
-            QMessageBox::warning(dialog, "Validation Error", "Please write a review comment.");
-            return;
-        }
-        
-        Review review;
-        review.id = existingReview.id;
-        review.productId = product.id;
-        review.userId = userId;
-        review.username = authManager.getCurrentUserEmail();
-        review.rating = ratingSpinBox->value();
-        review.comment = comment;
-        review.reviewDate = QDateTime::currentDateTime();
-        
-        bool success;
-        if (existingReview.id != -1) {
-            success = dbManager.updateReview(review);
-        } else {
-            success = dbManager.addReview(review);
-        }
-        
-        if (success) {
-            QMessageBox::information(dialog, "Success",
-                existingReview.id != -1 ? "Review updated successfully!" : "Review added successfully!");
-            dialog->accept();
-           // emit reviewAdded();
-        } else {
-            QMessageBox::warning(dialog, "Error", "Failed to save review. Please try again.");
-        }
-    });
-    
-    connect(buttonBox, &QDialogButtonBox::rejected, dialog, &QDialog::reject);
-    layout->addWidget(buttonBox);
-    
-    dialog->exec();
-    dialog->deleteLater();
 }
 
 ProductBrowsePage::ProductBrowsePage(QWidget *parent)
     : ProtectedPage(parent)
-    , networkManager(new QNetworkAccessManager(this))
-    , dbManager(DatabaseManager::getInstance())
+    , dbManager(StorageBackend::getInstance())
     , authManager(AuthManager::getInstance())
 {
+    // The snapshot mirrors the SQLite catalog; the in-memory backend is fast enough without one
+    QString snapshotPath;
+    if (StorageBackend::selectedKind() == StorageBackend::Sqlite) {
+        snapshotPath = QDir::currentPath() + "/catalog.snapshot";
+    }
+    catalogCache = new CatalogCache(dbManager, snapshotPath, this);
+    connect(catalogCache, &CatalogCache::catalogRefreshed, this, &ProductBrowsePage::onCatalogRefreshed);
+
+    searchController = new CatalogSearchController(this);
+    connect(searchController, &CatalogSearchController::resultsReady, this, &ProductBrowsePage::onSearchResults);
+    
     setupUI();
     fetchProducts();
 }
@@ -538,37 +131,6 @@ void ProductBrowsePage::setupUI()
         "    height: 12px;"
         "}";
 
-    categoryFilter = new QComboBox(this);
-    categoryFilter->addItem("All Categories");
-    categoryFilter->addItems({"Electronics", "Clothing", "Books", "Home & Garden", "Sports", "Other"});
-    categoryFilter->setStyleSheet(R"(
-        QComboBox {
-            padding: 5px 10px;
-            border: 1px solid #bdc3c7;
-            border-radius: 5px;
-            background: white;
-            color: #2c3e50;
-            min-width: 150px;
-        }
-        QComboBox::drop-down {
-            border: none;
-            padding-right: 5px;
-        }
-        QComboBox::down-arrow {
-            image: url(:/icons/dropdown-arrow.png);
-            width: 12px;
-            height: 12px;
-        }
-        QComboBox QAbstractItemView {
-            border: 1px solid #bdc3c7;
-            border-radius: 5px;
-            background: white;
-            color: #2c3e50;
-            selection-background-color: #ecf0f1;
-            selection-color: #2c3e50;
-        }
-    )");
-
     sortComboBox = new QComboBox(this);
     sortComboBox->addItems({"Price: Low to High", "Price: High to Low", "Name: A to Z"});
     sortComboBox->setStyleSheet(R"(
@@ -603,17 +165,29 @@ void ProductBrowsePage::setupUI()
     searchEdit->setPlaceholderText("🔍 Search products...");
     searchEdit->setStyleSheet(controlStyle);
 
-    controlsLayout->addWidget(categoryFilter);
     controlsLayout->addWidget(sortComboBox);
     controlsLayout->addWidget(searchEdit);
     mainLayout->addWidget(controlsContainer);
 
-    // Create scroll area for products
-    QScrollArea* scrollArea = new QScrollArea(this);
-    scrollArea->setWidgetResizable(true);
-    scrollArea->setFrameShape(QFrame::NoFrame);
-    scrollArea->setStyleSheet(
-        "QScrollArea {"
+    // Products are painted by the delegate, so only the visible cards cost anything
+    productModel = new ProductCatalogModel(dbManager, this);
+    cardDelegate = new ProductCardDelegate(this);
+
+    productView = new QListView(this);
+    productView->setViewMode(QListView::IconMode);
+    productView->setResizeMode(QListView::Adjust);
+    productView->setMovement(QListView::Static);
+    productView->setUniformItemSizes(true);
+    productView->setSpacing(10);
+    productView->setSelectionMode(QAbstractItemView::NoSelection);
+    productView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    productView->setMouseTracking(true);
+    productView->setFrameShape(QFrame::NoFrame);
+    productView->setCursor(Qt::PointingHandCursor);
+    productView->setModel(productModel);
+    productView->setItemDelegate(cardDelegate);
+    productView->setStyleSheet(
+        "QListView {"
         "    border: none;"
         "    background: transparent;"
         "}"
@@ -637,148 +211,114 @@ void ProductBrowsePage::setupUI()
         "}"
     );
 
-    productsContainer = new QWidget(scrollArea);
-    productsContainer->setStyleSheet(
-        "QWidget {"
-        "    background: transparent;"
-        "}"
-    );
-    
-    // Use QGridLayout instead of QVBoxLayout for products
-    productsLayout = new QGridLayout(productsContainer);
-    productsLayout->setSpacing(20);
-    productsLayout->setContentsMargins(0, 20, 0, 20);
-    scrollArea->setWidget(productsContainer);
-    mainLayout->addWidget(scrollArea);
-
-    connect(categoryFilter, &QComboBox::currentTextChanged, this, &ProductBrowsePage::onFilterChanged);
+    // Facets on the left, products on the right
+    facetPanel = new FacetPanel(this);
+    facetPanel->setFixedWidth(240);
+
+    QHBoxLayout* contentLayout = new QHBoxLayout();
+    contentLayout->setSpacing(20);
+    contentLayout->addWidget(facetPanel);
+    contentLayout->addWidget(productView, 1);
+    mainLayout->addLayout(contentLayout);
+
+    connect(cardDelegate, &ProductCardDelegate::cardClicked, this, &ProductBrowsePage::onCardClicked);
+    connect(cardDelegate, &ProductCardDelegate::addToCartClicked, this, &ProductBrowsePage::onCardAddToCartClicked);
+    connect(cardDelegate, &ProductCardDelegate::reviewsClicked, this, &ProductBrowsePage::onCardReviewsClicked);
+    connect(facetPanel, &FacetPanel::selectionChanged, this, &ProductBrowsePage::onFacetSelectionChanged);
+    connect(searchController, &CatalogSearchController::facetCountsReady, facetPanel, &FacetPanel::setCounts);
     connect(sortComboBox, &QComboBox::currentTextChanged, this, &ProductBrowsePage::onSortChanged);
     connect(searchEdit, &QLineEdit::textChanged, this, &ProductBrowsePage::onSearchTextChanged);
 }
 
 void ProductBrowsePage::fetchProducts()
 {
-    QList<Product> fetchedProducts = dbManager.getAllProducts();
-    
-    if (!fetchedProducts.isEmpty()) {
-        QVector<Product> productsVector;
-        for (const Product& product : fetchedProducts) {
-            productsVector.append(product);
-        }
-        onProductsFetchedSuccess(productsVector);
-    } else {
-        onProductsFetchedFailed("No products found in database");
+    // Paint from the snapshot file right away; the database is only read on
+    // a worker thread, and the grid is rebuilt if the catalog has changed
+    QList<Product> cachedProducts = catalogCache->load();
+    if (!cachedProducts.isEmpty()) {
+        onProductsFetchedSuccess(cachedProducts);
     }
+    catalogCache->refreshIfStale();
 }
 
-void ProductBrowsePage::onProductsFetchedSuccess(const QVector<Product>& fetchedProducts)
+void ProductBrowsePage::forgetChangedImages(const QVector<Product>& fetchedProducts)
 {
-    products = fetchedProducts;
-    filteredProducts = products;  // Initialize filtered products with all products
-    displayProducts();
+    // Cached renditions are keyed by product id alone, so ones whose source
+    // changed or went away must be dropped before the grid repaints
+    QHash<int, const Product*> previous;
+    for (const Product& product : products) {
+        previous.insert(product.id, &product);
+    }
+    QSet<int> changed;
+    for (const Product& product : fetchedProducts) {
+        const Product* old = previous.take(product.id);
+        if (old && !sameImage(*old, product)) {
+            changed.insert(product.id);
+        }
+    }
+    for (auto it = previous.cbegin(); it != previous.cend(); ++it) {
+        changed.insert(it.key());
+    }
+    ImageService::getInstance().forget(changed);
 }
 
-void ProductBrowsePage::onProductsFetchedFailed(const QString& error)
+void ProductBrowsePage::onCatalogRefreshed(const QList<Product>& fetchedProducts)
 {
-    QMessageBox::critical(this, "Error", "Failed to fetch products: " + error);
+    forgetChangedImages(fetchedProducts);
+    if (!fetchedProducts.isEmpty()) {
+        onProductsFetchedSuccess(fetchedProducts);
+    } else if (products.isEmpty()) {
+        onProductsFetchedFailed("No products found in database");
+    } else {
+        products.clear();
+        productModel->setCatalog(products);
+        searchController->setProducts(products, productModel->ratingSummaries());
+    }
 }
 
-void ProductBrowsePage::displayProducts()
+void ProductBrowsePage::onProductsFetchedSuccess(const QVector<Product>& fetchedProducts)
 {
-    // Clear existing widgets
-    clearProducts();
-    
-    int row = 0;
-    int col = 0;
-    int maxColumns = 3; // Display 3 products per row
-    
-    for (const Product& product : filteredProducts) {
-        ProductWidget* widget = new ProductWidget(product, productsContainer);
-        connect(widget, &ProductWidget::clicked, this, &ProductBrowsePage::handleProductClicked);
-        connect(widget, &ProductWidget::addToCartClicked, this, &ProductBrowsePage::showAddToCartDialog);
-        connect(widget, &ProductWidget::reviewAdded, this, &ProductBrowsePage::handleReviewAdded);
-        
-        productWidgets[product.id] = widget;
-        productsLayout->addWidget(widget, row, col);
-        
-        col++;
-        if (col >= maxColumns) {
-            col = 0;
-            row++;
-        }
-    }
-    
-    // Add stretch to center the grid if not enough products to fill the last row
-    if (col != 0) {
-        for (; col < maxColumns; col++) {
-            productsLayout->addItem(new QSpacerItem(0, 0, QSizePolicy::Expanding, QSizePolicy::Fixed), row, col);
-        }
-    }
+    products = fetchedProducts;
+    productModel->setCatalog(products);
+    productModel->refreshSummaries();
+    facetPanel->setSellerNames(productModel->sellerNamesById());
+    // The current search, filters and sort are re-applied to the new catalog
+    searchController->setProducts(products, productModel->ratingSummaries());
 }
 
-void ProductBrowsePage::clearProducts()
+void ProductBrowsePage::onProductsFetchedFailed(const QString& error)
 {
-    for (QWidget* widget : productWidgets.values()) {
-        productsLayout->removeWidget(widget);
-        delete widget;
-    }
-    productWidgets.clear();
+    QMessageBox::critical(this, "Error", "Failed to fetch products: " + error);
 }
 
-void ProductBrowsePage::onFilterChanged()
+void ProductBrowsePage::onFacetSelectionChanged(const FacetSelection& selection)
 {
-    QString category = categoryFilter->currentText();
-    filteredProducts.clear();
-    
-    if (category == "All Categories") {
-        filteredProducts = products;
-    } else {
-        for (const Product& product : products) {
-            if (product.category == category) {
-                filteredProducts.append(product);
-            }
-        }
-    }
-    
-    displayProducts();
+    searchController->setFacetSelection(selection);
 }
 
 void ProductBrowsePage::onSortChanged()
 {
     QString sortBy = sortComboBox->currentText();
     
-    if (sortBy == "Price: Low to High") {
-        std::sort(filteredProducts.begin(), filteredProducts.end(), 
-            [](const Product& a, const Product& b) { return a.price < b.price; });
-    }
-    else if (sortBy == "Price: High to Low") {
-        std::sort(filteredProducts.begin(), filteredProducts.end(), 
-            [](const Product& a, const Product& b) { return a.price > b.price; });
+    if (sortBy == "Price: High to Low") {
+        searchController->setSortOrder(CatalogQuery::PriceDescending);
     }
     else if (sortBy == "Name: A to Z") {
-        std::sort(filteredProducts.begin(), filteredProducts.end(), 
-            [](const Product& a, const Product& b) { return a.name < b.name; });
+        searchController->setSortOrder(CatalogQuery::NameAscending);
+    }
+    else {
+        searchController->setSortOrder(CatalogQuery::PriceAscending);
     }
-    
-    displayProducts();
 }
 
 void ProductBrowsePage::onSearchTextChanged(const QString& text)
 {
-    filteredProducts.clear();
-    
-    if (text.isEmpty()) {
-        filteredProducts = products;
-    } else {
-        for (const Product& product : products) {
-            if (product.name.contains(text, Qt::CaseInsensitive) ||
-                product.description.contains(text, Qt::CaseInsensitive)) {
-                filteredProducts.append(product);
-            }
-        }
-    }
-    
-    displayProducts();
+    searchController->setSearchText(text);
+}
+
+void ProductBrowsePage::onSearchResults(const QVector<int>& rows)
+{
+    productModel->setRows(rows);
 }
 
 void ProductBrowsePage::showAddToCartDialog(const Product& product)
@@ -838,7 +378,8 @@ void ProductBrowsePage::onAddToCartClicked(int productId, int quantity)
         return;
     }
 
-    if (dbManager.addToCart(userId, productId, quantity)) {
+    // Goes through the cart model so the cart page only applies the new line
+    if (CartModel::getInstance().add(userId, productId, quantity)) {
         QMessageBox::information(this, "Success", "Item added to cart successfully!");
     } else {
         QMessageBox::warning(this, "Error", "Failed to add item to cart");
@@ -859,14 +400,24 @@ void ProductBrowsePage::showReviewsDialog(const Product& product)
     
     // Product image
     QLabel* productImage = new QLabel(&dialog);
+    productImage->setFixedSize(100, 100);
+    productImage->setAlignment(Qt::AlignCenter);
+    ImageService& images = ImageService::getInstance();
+    auto showImage = [productImage](const QPixmap& decoded) {
+        productImage->setPixmap(decoded);
+    };
     QPixmap pixmap;
-    if (!product.imageData.isEmpty()) {
-        pixmap.loadFromData(product.imageData);
+    if (product.imageData.isEmpty() && product.hasImageData) {
+        pixmap = images.requestStored(product.id, QSize(100, 100), dialog.devicePixelRatioF(),
+                                      productImage, showImage);
+    } else if (product.imageData.isEmpty() && !product.imageUrl.isEmpty()) {
+        pixmap = images.requestUrl(product.id, QUrl(product.imageUrl), QSize(100, 100), dialog.devicePixelRatioF(),
+                                   productImage, showImage);
     } else {
-        pixmap = QPixmap(":/images/no-image.png");
+        pixmap = images.request(product.id, product.imageData, QSize(100, 100), dialog.devicePixelRatioF(),
+                                productImage, showImage);
     }
-    pixmap = pixmap.scaled(100, 100, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    productImage->setPixmap(pixmap);
+    productImage->setPixmap(pixmap.isNull() ? images.placeholder(QSize(100, 100), dialog.devicePixelRatioF()) : pixmap);
     productInfoLayout->addWidget(productImage);
     
     // Product details
@@ -882,13 +433,35 @@ void ProductBrowsePage::showReviewsDialog(const Product& product)
         ? QString("★ %1/5 (%2 reviews)").arg(avgRating, 0, 'f', 1).arg(reviews.size())
         : "No reviews yet";
     QLabel* ratingLabel = new QLabel(ratingText, &dialog);
-    ratingLabel->setStyleSheet("color: #666;");
+    ratingLabel->setStyleSheet("color: #f39c12;");
     productDetailsLayout->addWidget(ratingLabel);
     
     productInfoLayout->addLayout(productDetailsLayout);
     productInfoLayout->addStretch();
     layout->addLayout(productInfoLayout);
     
+    // Add Review button (only if user is logged in)
+    if (authManager.getCurrentUserId() != -1) {
+        QPushButton* addReviewBtn = new QPushButton("Write a Review", &dialog);
+        addReviewBtn->setStyleSheet(
+            "QPushButton {"
+            "    background-color: #2ecc71;"
+            "    color: white;"
+            "    border: none;"
+            "    padding: 8px;"
+            "    border-radius: 4px;"
+            "}"
+            "QPushButton:hover {"
+            "    background-color: #27ae60;"
+            "}"
+        );
+        connect(addReviewBtn, &QPushButton::clicked, [this, &dialog, product]() {
+            dialog.close();
+            showAddReviewDialog(product);
+        });
+        layout->addWidget(addReviewBtn);
+    }
+    
     // Separator line
     QFrame* line = new QFrame(&dialog);
     line->setFrameShape(QFrame::HLine);
@@ -917,29 +490,116 @@ void ProductBrowsePage::showReviewsDialog(const Product& product)
     dialog.exec();
 }
 
-void ProductBrowsePage::handleProductClicked(const Product& product)
+void ProductBrowsePage::showAddReviewDialog(const Product& product)
 {
+    int userId = authManager.getCurrentUserId();
+    if (userId == -1) {
+        QMessageBox::warning(this, "Login Required", "Please log in to write a review.");
+        return;
+    }
+    
+    // Check if user has already reviewed this product
+    Review existingReview = dbManager.getUserProductReview(userId, product.id);
+    
+    QDialog* dialog = new QDialog(this);
+    dialog->setWindowTitle(existingReview.id != -1 ? "Update Review" : "Write a Review");
+    dialog->setModal(true);
+    
+    QVBoxLayout* layout = new QVBoxLayout(dialog);
+    
+    // Rating
+    QHBoxLayout* ratingLayout = new QHBoxLayout();
+    QLabel* ratingLabel = new QLabel("Rating:", dialog);
+    QSpinBox* ratingSpinBox = new QSpinBox(dialog);
+    ratingSpinBox->setRange(1, 5);
+    ratingSpinBox->setValue(existingReview.id != -1 ? existingReview.rating : 5);
+    ratingSpinBox->setPrefix("★ ");
+    ratingLayout->addWidget(ratingLabel);
+    ratingLayout->addWidget(ratingSpinBox);
+    layout->addLayout(ratingLayout);
+    
+    // Comment
+    QLabel* commentLabel = new QLabel("Your Review:", dialog);
+    layout->addWidget(commentLabel);
+    
+    QTextEdit* commentEdit = new QTextEdit(dialog);
+    commentEdit->setPlaceholderText("Write your review here...");
+    if (existingReview.id != -1) {
+        commentEdit->setText(existingReview.comment);
+    }
+    layout->addWidget(commentEdit);
+    
+    // Buttons
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(
+        QDialogButtonBox::Ok | QDialogButtonBox::Cancel,
+        dialog
+    );
+    
+    // Connect the accepted signal to a lambda that validates and submits the review
+    connect(buttonBox, &QDialogButtonBox::accepted, [this, dialog, ratingSpinBox, commentEdit, existingReview, userId, product]() {
+        QString comment = commentEdit->toPlainText().trimmed();
+        if (comment.isEmpty()) {
+            QMessageBox::warning(dialog, "Validation Error", "Please write a review comment.");
+            return;
+        }
+        
+        Review review;
+        review.id = existingReview.id;
+        review.productId = product.id;
+        review.userId = userId;
+        review.username = authManager.getCurrentUserEmail();
+        review.rating = ratingSpinBox->value();
+        review.comment = comment;
+        review.reviewDate = QDateTime::currentMSecsSinceEpoch();
+        
+        bool success;
+        if (existingReview.id != -1) {
+            success = dbManager.updateReview(review);
+        } else {
+            success = dbManager.addReview(review);
+        }
+        
+        if (success) {
+            QMessageBox::information(dialog, "Success",
+                existingReview.id != -1 ? "Review updated successfully!" : "Review added successfully!");
+            dialog->accept();
+            handleReviewAdded();
+        } else {
+            QMessageBox::warning(dialog, "Error", "Failed to save review. Please try again.");
+        }
+    });
+    
+    connect(buttonBox, &QDialogButtonBox::rejected, dialog, &QDialog::reject);
+    layout->addWidget(buttonBox);
+    
+    dialog->exec();
+    dialog->deleteLater();
+}
+
+void ProductBrowsePage::onCardClicked(const QModelIndex& index)
+{
+    Product product = productModel->productAt(index.row());
     emit productSelected(product);
 }
 
-void ProductBrowsePage::handleReviewAdded()
+void ProductBrowsePage::onCardAddToCartClicked(const QModelIndex& index)
 {
-    // Refresh the products display to update ratings
-    updateProducts();
+    // Copied because the model can be reset while the dialog is open
+    Product product = productModel->productAt(index.row());
+    showAddToCartDialog(product);
 }
 
-void ProductBrowsePage::updateProducts()
+void ProductBrowsePage::onCardReviewsClicked(const QModelIndex& index)
 {
-    // Clear existing widgets
-    clearProducts();
-    
-    // Fetch updated products
-    products = dbManager.getAllProducts();
-    filteredProducts = products;  // Initialize filtered products with all products
-    
-    if (!products.isEmpty()) {
-        displayProducts();
-    }
+    Product product = productModel->productAt(index.row());
+    showReviewsDialog(product);
+}
+
+void ProductBrowsePage::handleReviewAdded()
+{
+    // Only the rating summaries change; the grid keeps its scroll position
+    productModel->refreshRatings();
+    searchController->setRatings(productModel->ratingSummaries());
 }
 
 void ProductBrowsePage::setupReviewsSection(QVBoxLayout* layout, const QList<Review>& reviews) {
@@ -956,7 +616,7 @@ void ProductBrowsePage::setupReviewsSection(QVBoxLayout* layout, const QList<Rev
         QLabel* userLabel = new QLabel(review.username);
         userLabel->setStyleSheet("font-weight: bold; color: #333333;");
         
-        QLabel* dateLabel = new QLabel(review.reviewDate.toString("yyyy-MM-dd"));
+        QLabel* dateLabel = new QLabel(review.reviewDateTime().toString("yyyy-MM-dd"));
         dateLabel->setStyleSheet("color: #666666;");
         
         headerLayout->addWidget(userLabel);
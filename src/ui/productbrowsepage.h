@@ -2,51 +2,26 @@
 #define PRODUCTBROWSEPAGE_H
 
 #include "protectedpage.h"
-#include "../database/databasemanager.h"
+#include "../database/storagebackend.h"
+#include "../database/catalogcache.h"
 #include "../auth/authmanager.h"
-#include <QGridLayout>
+#include "productcatalogmodel.h"
+#include "productcarddelegate.h"
+#include "catalogsearchcontroller.h"
+#include "facetpanel.h"
+#include <QVBoxLayout>
 #include <QComboBox>
 #include <QLineEdit>
 #include <QPushButton>
 #include <QLabel>
 #include <QScrollArea>
+#include <QListView>
 #include <QWidget>
 #include <QVector>
-#include <QMap>
-#include <QNetworkAccessManager>
-#include <QMouseEvent>
 #include <QSpinBox>
 #include <QDialog>
 #include <QTextEdit>
 
-class ProductWidget : public QWidget {
-    Q_OBJECT
-public:
-    explicit ProductWidget(const Product& product, QWidget* parent = nullptr);
-
-protected:
-    void mousePressEvent(QMouseEvent* event) override;
-
-private:
-    void setupUI();
-    void showReviewsDialog();
-    void showAddReviewDialog();
-    void setupReviewsSection(QVBoxLayout* layout, const QList<Review>& reviews);
-
-signals:
-    void clicked(const Product& product);
-    void addToCartClicked(const Product& product);
-    void reviewAdded();
-
-private:
-    Product product;
-    QLabel* imageLabel;
-    QLabel* nameLabel;
-    QLabel* priceLabel;
-    QLabel* ratingLabel;
-    DatabaseManager& dbManager;
-};
-
 class ProductBrowsePage : public ProtectedPage {
     Q_OBJECT
 
@@ -58,38 +33,40 @@ signals:
     void loginRequired();
 
 private slots:
-    void handleProductClicked(const Product& product);
-    void updateProducts();
-    void displayProducts();
+    void onCardClicked(const QModelIndex& index);
+    void onCardAddToCartClicked(const QModelIndex& index);
+    void onCardReviewsClicked(const QModelIndex& index);
     void handleReviewAdded();
-    void onFilterChanged();
+    void onFacetSelectionChanged(const FacetSelection& selection);
     void onSortChanged();
     void onSearchTextChanged(const QString& text);
+    void onSearchResults(const QVector<int>& rows);
     void onProductsFetchedSuccess(const QVector<Product>& products);
     void onProductsFetchedFailed(const QString& error);
+    void onCatalogRefreshed(const QList<Product>& products);
     void onAddToCartClicked(int productId, int quantity);
 
 private:
     void setupUI();
     void fetchProducts();
+    void forgetChangedImages(const QVector<Product>& fetchedProducts);
     void displayProductReviews(const Product& product, QDialog& dialog);
     void setupReviewsSection(QVBoxLayout* layout, const QList<Review>& reviews);
-    void clearProducts();
     void showAddToCartDialog(const Product& product);
     void showReviewsDialog(const Product& product);
+    void showAddReviewDialog(const Product& product);
 
-    QScrollArea* scrollArea;
-    QWidget* productsContainer;
-    QGridLayout* productsLayout;
-    QComboBox* categoryFilter;
+    QListView* productView;
+    ProductCatalogModel* productModel;
+    ProductCardDelegate* cardDelegate;
+    FacetPanel* facetPanel;
     QComboBox* sortComboBox;
     QLineEdit* searchEdit;
     QVector<Product> products;
-    QVector<Product> filteredProducts;
-    QMap<int, QWidget*> productWidgets;
-    QNetworkAccessManager* networkManager;
-    DatabaseManager& dbManager;
+    StorageBackend& dbManager;
     AuthManager& authManager;
+    CatalogCache* catalogCache;
+    CatalogSearchController* searchController;
     QVBoxLayout* mainLayout;
 };
 
@@ -0,0 +1,225 @@
+#include "productcarddelegate.h"
+#include "productcatalogmodel.h"
+#include "imageservice.h"
+#include <QAbstractItemView>
+#include <QPainter>
+#include <QPainterPath>
+#include <QMouseEvent>
+
+namespace {
+const int CARD_WIDTH = 300;
+const int CARD_HEIGHT = 540;
+const int CARD_MARGIN = 5;
+const int BUTTON_HEIGHT = 38;
+const int BUTTON_SPACING = 8;
+const int PADDING = 15;
+const QSize IMAGE_SIZE(200, 200);
+
+QFont cardFont(const QFont& base, int pixelSize, bool bold) {
+    QFont font(base);
+    font.setPixelSize(pixelSize);
+    font.setBold(bold);
+    return font;
+}
+}
+
+ProductCardDelegate::ProductCardDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+    , pressedButton(NoButton)
+{
+}
+
+QSize ProductCardDelegate::cardSize() {
+    return QSize(CARD_WIDTH, CARD_HEIGHT);
+}
+
+QSize ProductCardDelegate::sizeHint(const QStyleOptionViewItem&, const QModelIndex&) const {
+    return cardSize();
+}
+
+QRect ProductCardDelegate::cardRect(const QRect& itemRect) {
+    return itemRect.adjusted(CARD_MARGIN, CARD_MARGIN, -CARD_MARGIN, -CARD_MARGIN);
+}
+
+QRect ProductCardDelegate::buttonRect(const QRect& card, Button button) {
+    int left = card.left() + PADDING;
+    int width = card.width() - 2 * PADDING;
+    int reviewsTop = card.bottom() - PADDING - BUTTON_HEIGHT;
+    switch (button) {
+    case AddToCartButton:
+        return QRect(left, reviewsTop - BUTTON_SPACING - BUTTON_HEIGHT, width, BUTTON_HEIGHT);
+    case ReviewsButton:
+        return QRect(left, reviewsTop, width, BUTTON_HEIGHT);
+    default:
+        return QRect();
+    }
+}
+
+ProductCardDelegate::Button ProductCardDelegate::buttonAt(const QRect& card, const QPoint& pos) {
+    if (buttonRect(card, AddToCartButton).contains(pos)) {
+        return AddToCartButton;
+    }
+    if (buttonRect(card, ReviewsButton).contains(pos)) {
+        return ReviewsButton;
+    }
+    return NoButton;
+}
+
+void ProductCardDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option,
+                                const QModelIndex& index) const {
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    QRect card = cardRect(option.rect);
+    bool hovered = option.state & QStyle::State_MouseOver;
+
+    // Card background
+    QPainterPath cardPath;
+    cardPath.addRoundedRect(QRectF(card).adjusted(0.5, 0.5, -0.5, -0.5), 12, 12);
+    painter->fillPath(cardPath, hovered ? QColor("#f8f9fa") : QColor(Qt::white));
+    painter->setPen(hovered ? QPen(QColor("#3498db"), 2) : QPen(QColor("#e0e0e0"), 1));
+    painter->drawPath(cardPath);
+
+    int left = card.left() + PADDING;
+    int width = card.width() - 2 * PADDING;
+    int y = card.top() + PADDING;
+
+    // Image box
+    QRect imageBox(card.center().x() - 110, y, 220, 220);
+    painter->setPen(QPen(QColor("#e0e0e0"), 1));
+    painter->setBrush(Qt::white);
+    painter->drawRoundedRect(imageBox, 10, 10);
+    // Never decode here: show the placeholder and repaint this card when ready
+    ImageService& images = ImageService::getInstance();
+    qreal dpr = painter->device()->devicePixelRatioF();
+    QAbstractItemView* view = qobject_cast<QAbstractItemView*>(const_cast<QWidget*>(option.widget));
+    // ImageService keeps one callback per view and key, and the model may be
+    // reset before it runs, so repaint whatever is visible rather than a card
+    auto repaint = [view](const QPixmap&) {
+        view->viewport()->update();
+    };
+    int productId = index.data(ProductCatalogModel::ProductIdRole).toInt();
+    QByteArray imageData = index.data(ProductCatalogModel::ImageDataRole).toByteArray();
+    QString imageUrl = index.data(ProductCatalogModel::ImageUrlRole).toString();
+    QPixmap pixmap;
+    if (imageData.isEmpty() && index.data(ProductCatalogModel::HasImageDataRole).toBool()) {
+        pixmap = images.requestStored(productId, IMAGE_SIZE, dpr, view, repaint);
+    } else if (imageData.isEmpty() && !imageUrl.isEmpty()) {
+        pixmap = images.requestUrl(productId, QUrl(imageUrl), IMAGE_SIZE, dpr, view, repaint);
+    } else {
+        pixmap = images.request(productId, imageData, IMAGE_SIZE, dpr, view, repaint);
+    }
+    if (pixmap.isNull()) {
+        pixmap = images.placeholder(IMAGE_SIZE, dpr);
+    }
+    QRect target(QPoint(0, 0), pixmap.size() / pixmap.devicePixelRatio());
+    target.moveCenter(imageBox.center());
+    painter->drawPixmap(target, pixmap);
+    y = imageBox.bottom() + 10;
+
+    // Category chip
+    QString category = index.data(ProductCatalogModel::CategoryRole).toString();
+    QFont chipFont = cardFont(option.font, 12, false);
+    painter->setFont(chipFont);
+    int chipWidth = qMin(width, painter->fontMetrics().horizontalAdvance(category) + 16);
+    QRect chip(card.center().x() - chipWidth / 2, y, chipWidth, 22);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(QColor("#f0f0f0"));
+    painter->drawRoundedRect(chip, 4, 4);
+    painter->setPen(QColor("#666666"));
+    painter->drawText(chip, Qt::AlignCenter, category);
+    y = chip.bottom() + 8;
+
+    // Name, wrapped over at most two lines
+    painter->setFont(cardFont(option.font, 16, true));
+    painter->setPen(QColor("#2c3e50"));
+    QRect nameRect(left, y, width, 44);
+    painter->drawText(nameRect, Qt::AlignHCenter | Qt::AlignVCenter | Qt::TextWordWrap,
+                      index.data(ProductCatalogModel::NameRole).toString());
+    y = nameRect.bottom() + 4;
+
+    painter->setFont(cardFont(option.font, 13, false));
+    painter->setPen(QColor("#7f8c8d"));
+    painter->drawText(QRect(left, y, width, 20), Qt::AlignCenter,
+                      QString("👤 %1").arg(index.data(ProductCatalogModel::SellerNameRole).toString()));
+    y += 24;
+
+    painter->setFont(cardFont(option.font, 18, true));
+    painter->setPen(QColor("#27ae60"));
+    painter->drawText(QRect(left, y, width, 26), Qt::AlignCenter,
+                      QString("$%1").arg(index.data(ProductCatalogModel::PriceRole).toDouble(), 0, 'f', 2));
+    y += 30;
+
+    painter->setFont(cardFont(option.font, 13, true));
+    painter->setPen(QColor("#e74c3c"));
+    painter->drawText(QRect(left, y, width, 20), Qt::AlignCenter,
+                      QString("📦 Available: %1").arg(index.data(ProductCatalogModel::StockRole).toInt()));
+    y += 24;
+
+    double rating = index.data(ProductCatalogModel::RatingRole).toDouble();
+    int reviewCount = index.data(ProductCatalogModel::ReviewCountRole).toInt();
+    QString ratingText = rating > 0
+        ? QString("★ %1/5 (%2 reviews)").arg(rating, 0, 'f', 1).arg(reviewCount)
+        : "No reviews yet";
+    painter->setFont(cardFont(option.font, 13, false));
+    painter->setPen(QColor("#f39c12"));
+    painter->drawText(QRect(left, y, width, 20), Qt::AlignCenter, ratingText);
+
+    bool pressedHere = pressedIndex.isValid() && pressedIndex == index;
+    paintButton(painter, buttonRect(card, AddToCartButton), "🛒 Add to Cart", QColor("#2ecc71"),
+                pressedHere && pressedButton == AddToCartButton);
+    paintButton(painter, buttonRect(card, ReviewsButton), "⭐ View Reviews", QColor("#3498db"),
+                pressedHere && pressedButton == ReviewsButton);
+
+    painter->restore();
+}
+
+void ProductCardDelegate::paintButton(QPainter* painter, const QRect& rect, const QString& text,
+                                      const QColor& color, bool pressed) const {
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(pressed ? color.darker(120) : color);
+    painter->drawRoundedRect(rect, 5, 5);
+    painter->setFont(cardFont(painter->font(), 14, true));
+    painter->setPen(Qt::white);
+    painter->drawText(rect, Qt::AlignCenter, text);
+}
+
+bool ProductCardDelegate::editorEvent(QEvent* event, QAbstractItemModel* model,
+                                      const QStyleOptionViewItem& option, const QModelIndex& index) {
+    if (event->type() != QEvent::MouseButtonPress && event->type() != QEvent::MouseButtonRelease) {
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+    }
+
+    QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+    if (mouseEvent->button() != Qt::LeftButton) {
+        return false;
+    }
+
+    Button button = buttonAt(cardRect(option.rect), mouseEvent->position().toPoint());
+    if (event->type() == QEvent::MouseButtonPress) {
+        pressedIndex = index;
+        pressedButton = button;
+        return true;
+    }
+
+    // A click only counts if it is released over what was pressed
+    bool sameTarget = pressedIndex == index && pressedButton == button;
+    pressedIndex = QPersistentModelIndex();
+    pressedButton = NoButton;
+    if (!sameTarget) {
+        return true;
+    }
+
+    switch (button) {
+    case AddToCartButton:
+        emit addToCartClicked(index);
+        break;
+    case ReviewsButton:
+        emit reviewsClicked(index);
+        break;
+    default:
+        emit cardClicked(index);
+        break;
+    }
+    return true;
+}
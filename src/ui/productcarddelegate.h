@@ -0,0 +1,47 @@
+#ifndef PRODUCTCARDDELEGATE_H
+#define PRODUCTCARDDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QPersistentModelIndex>
+
+// Paints one product card from ProductCatalogModel roles. The card's buttons
+// are drawn rather than created as widgets and are hit-tested in editorEvent,
+// so the view only pays for the cards currently on screen.
+class ProductCardDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    enum Button {
+        NoButton,
+        AddToCartButton,
+        ReviewsButton
+    };
+
+    explicit ProductCardDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+    static QSize cardSize();
+
+signals:
+    void addToCartClicked(const QModelIndex& index);
+    void reviewsClicked(const QModelIndex& index);
+    void cardClicked(const QModelIndex& index);
+
+protected:
+    bool editorEvent(QEvent* event, QAbstractItemModel* model,
+                     const QStyleOptionViewItem& option, const QModelIndex& index) override;
+
+private:
+    static QRect cardRect(const QRect& itemRect);
+    static QRect buttonRect(const QRect& card, Button button);
+    static Button buttonAt(const QRect& card, const QPoint& pos);
+    void paintButton(QPainter* painter, const QRect& rect, const QString& text,
+                     const QColor& color, bool pressed) const;
+
+    QPersistentModelIndex pressedIndex;
+    Button pressedButton;
+};
+
+#endif // PRODUCTCARDDELEGATE_H
@@ -0,0 +1,101 @@
+#include "productcatalogmodel.h"
+
+ProductCatalogModel::ProductCatalogModel(StorageBackend& storage, QObject *parent)
+    : QAbstractListModel(parent)
+    , storage(storage)
+{
+}
+
+int ProductCatalogModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : rows.size();
+}
+
+QVariant ProductCatalogModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= rows.size()) {
+        return QVariant();
+    }
+
+    const Product& product = productAt(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case NameRole:
+        return product.name;
+    case Qt::ToolTipRole:
+        return product.description;
+    case ProductIdRole:
+        return product.id;
+    case PriceRole:
+        return product.price;
+    case CategoryRole:
+        return product.category;
+    case StockRole:
+        return product.stock;
+    case SellerNameRole:
+        return sellerNames.value(product.sellerId);
+    case RatingRole:
+        return ratings.value(product.id).average;
+    case ReviewCountRole:
+        return ratings.value(product.id).count;
+    case ImageDataRole:
+        return product.imageData;
+    case ImageUrlRole:
+        return product.imageUrl;
+    case HasImageDataRole:
+        return product.hasImageData;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> ProductCatalogModel::roleNames() const {
+    QHash<int, QByteArray> names = QAbstractListModel::roleNames();
+    names[ProductIdRole] = "productId";
+    names[NameRole] = "name";
+    names[PriceRole] = "price";
+    names[CategoryRole] = "category";
+    names[StockRole] = "stock";
+    names[SellerNameRole] = "sellerName";
+    names[RatingRole] = "rating";
+    names[ReviewCountRole] = "reviewCount";
+    names[ImageDataRole] = "imageData";
+    names[ImageUrlRole] = "imageUrl";
+    names[HasImageDataRole] = "hasImageData";
+    return names;
+}
+
+void ProductCatalogModel::setCatalog(const QVector<Product>& newProducts) {
+    beginResetModel();
+    products = newProducts;
+    rows.clear();
+    endResetModel();
+}
+
+void ProductCatalogModel::setRows(const QVector<int>& catalogRows) {
+    beginResetModel();
+    rows = catalogRows;
+    endResetModel();
+}
+
+const Product& ProductCatalogModel::productAt(int row) const {
+    return products.at(rows.at(row));
+}
+
+void ProductCatalogModel::refreshSummaries() {
+    sellerNames = storage.getSellerNames();
+    refreshRatings();
+}
+
+void ProductCatalogModel::refreshRatings() {
+    ratings = storage.getRatingSummaries();
+    if (!rows.isEmpty()) {
+        emit dataChanged(index(0), index(rows.size() - 1), {RatingRole, ReviewCountRole});
+    }
+}
+
+const QHash<int, RatingSummary>& ProductCatalogModel::ratingSummaries() const {
+    return ratings;
+}
+
+const QHash<int, QString>& ProductCatalogModel::sellerNamesById() const {
+    return sellerNames;
+}
@@ -0,0 +1,56 @@
+#ifndef PRODUCTCATALOGMODEL_H
+#define PRODUCTCATALOGMODEL_H
+
+#include "../database/storagebackend.h"
+#include <QAbstractListModel>
+#include <QHash>
+#include <QVector>
+
+// Products shown by the browse grid. Seller names and ratings are loaded for
+// the whole catalog in two queries rather than per card. Images are handed to
+// the view as encoded bytes, or only flagged when the catalog was loaded
+// without them; ProductCardDelegate decodes them through ImageService.
+class ProductCatalogModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        ProductIdRole = Qt::UserRole + 1,
+        NameRole,
+        PriceRole,
+        CategoryRole,
+        StockRole,
+        SellerNameRole,
+        RatingRole,
+        ReviewCountRole,
+        ImageDataRole,
+        ImageUrlRole,
+        HasImageDataRole
+    };
+
+    explicit ProductCatalogModel(StorageBackend& storage, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    // The catalog starts with no visible rows; setRows picks and orders them
+    void setCatalog(const QVector<Product>& products);
+    void setRows(const QVector<int>& catalogRows);
+    const Product& productAt(int row) const;
+
+    // Re-reads seller names and rating summaries, e.g. after the catalog or a review changed
+    void refreshSummaries();
+    void refreshRatings();
+    const QHash<int, RatingSummary>& ratingSummaries() const;
+    const QHash<int, QString>& sellerNamesById() const;
+
+private:
+    StorageBackend& storage;
+    QVector<Product> products;
+    QVector<int> rows;  // Indexes into products, in display order
+    QHash<int, RatingSummary> ratings;
+    QHash<int, QString> sellerNames;
+};
+
+#endif // PRODUCTCATALOGMODEL_H
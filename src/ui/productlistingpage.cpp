@@ -1,5 +1,5 @@
 #include "productlistingpage.h"
-#include "../database/databasemanager.h"
+#include "../database/storagebackend.h"
 #include "../auth/authmanager.h"
 #include <QFormLayout>
 #include <QGroupBox>
@@ -451,7 +451,7 @@ void ProductListingPage::onAddProductClicked()
     qDebug() << "Image data size:" << product.imageData.size();
     
     // Add product to database
-    if (DatabaseManager::getInstance().addProduct(product)) {
+    if (StorageBackend::getInstance().addProduct(product)) {
         qDebug() << "Product added successfully";
         onProductAddedSuccess();
     } else {
@@ -0,0 +1,109 @@
+#include "remoteimageloader.h"
+#include <QNetworkDiskCache>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QStandardPaths>
+#include <QDebug>
+
+RemoteImageLoader& RemoteImageLoader::getInstance() {
+    static RemoteImageLoader instance(
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/images");
+    return instance;
+}
+
+RemoteImageLoader::RemoteImageLoader(const QString& cacheDirectory, QObject *parent)
+    : QObject(parent)
+    , diskCache(new QNetworkDiskCache(this))
+    , active(0)
+    , maxActive(DEFAULT_MAX_CONCURRENT)
+{
+    diskCache->setCacheDirectory(cacheDirectory);
+    diskCache->setMaximumCacheSize(DEFAULT_CACHE_BYTES);
+    manager.setCache(diskCache);
+    connect(&manager, &QNetworkAccessManager::finished, this, &RemoteImageLoader::onReplyFinished);
+}
+
+void RemoteImageLoader::fetch(const QUrl& url, QObject* receiver, Callback callback) {
+    if (!url.isValid() || (url.scheme() != "http" && url.scheme() != "https")) {
+        qDebug() << "Not fetching product image from" << url;
+        if (callback) {
+            callback(QByteArray());
+        }
+        return;
+    }
+
+    bool started = waiting.contains(url);
+    waiting[url].append(Waiter{receiver, callback});
+    if (!started) {
+        queue.enqueue(url);
+        startNext();
+    }
+}
+
+void RemoteImageLoader::startNext() {
+    while (active < maxActive && !queue.isEmpty()) {
+        QUrl url = queue.dequeue();
+
+        QNetworkRequest request(url);
+        request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+        // PreferNetwork serves fresh entries from disk and revalidates stale ones
+        request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferNetwork);
+        request.setAttribute(QNetworkRequest::CacheSaveControlAttribute, true);
+        request.setTransferTimeout(TRANSFER_TIMEOUT_MS);
+        request.setRawHeader("Accept", "image/*");
+
+        QNetworkReply* reply = manager.get(request);
+        // An image bigger than this is not a product thumbnail
+        connect(reply, &QNetworkReply::downloadProgress, reply, [reply](qint64 received, qint64 total) {
+            if (received > MAX_IMAGE_BYTES || total > MAX_IMAGE_BYTES) {
+                reply->abort();
+            }
+        });
+        ++active;
+    }
+}
+
+void RemoteImageLoader::onReplyFinished(QNetworkReply* reply) {
+    reply->deleteLater();
+    --active;
+
+    QUrl url = reply->request().url();
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    bool fromCache = reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+    QByteArray body;
+    if (reply->error() == QNetworkReply::NoError && status >= 200 && status < 300) {
+        body = reply->readAll();
+    } else {
+        qDebug() << "Error fetching product image" << url << ":" << reply->errorString();
+    }
+
+    emit fetched(url, !body.isEmpty(), fromCache);
+    finish(url, body);
+    startNext();
+}
+
+void RemoteImageLoader::finish(const QUrl& url, const QByteArray& body) {
+    QList<Waiter> waiters = waiting.take(url);
+    for (const Waiter& waiter : waiters) {
+        if (waiter.receiver && waiter.callback) {
+            waiter.callback(body);
+        }
+    }
+}
+
+void RemoteImageLoader::setMaxConcurrentRequests(int count) {
+    maxActive = qMax(1, count);
+    startNext();
+}
+
+int RemoteImageLoader::maxConcurrentRequests() const {
+    return maxActive;
+}
+
+void RemoteImageLoader::setCacheSize(qint64 bytes) {
+    diskCache->setMaximumCacheSize(bytes);
+}
+
+int RemoteImageLoader::pendingCount() const {
+    return waiting.size();
+}
@@ -0,0 +1,71 @@
+#ifndef REMOTEIMAGELOADER_H
+#define REMOTEIMAGELOADER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QNetworkAccessManager>
+#include <QPointer>
+#include <QQueue>
+#include <QUrl>
+#include <functional>
+
+class QNetworkDiskCache;
+class QNetworkReply;
+
+// Downloads product images from Product::imageUrl. At most a few requests
+// run at once and the rest wait in a queue; requests for a URL already
+// being fetched share that download. Responses go through a size-capped
+// QNetworkDiskCache, so a stale entry is revalidated with If-None-Match /
+// If-Modified-Since and a 304 is answered from disk. HTTP/2 is used when
+// the server offers it.
+//
+// The app uses getInstance(); a separate instance with its own cache
+// directory can be pointed at a local test server.
+class RemoteImageLoader : public QObject {
+    Q_OBJECT
+
+public:
+    // Called with the body, or with empty bytes if the fetch failed
+    typedef std::function<void(const QByteArray&)> Callback;
+
+    static RemoteImageLoader& getInstance();
+
+    explicit RemoteImageLoader(const QString& cacheDirectory, QObject *parent = nullptr);
+
+    // The callback is dropped if receiver is destroyed first
+    void fetch(const QUrl& url, QObject* receiver, Callback callback);
+
+    void setMaxConcurrentRequests(int count);
+    int maxConcurrentRequests() const;
+    void setCacheSize(qint64 bytes);
+    int pendingCount() const;
+
+signals:
+    void fetched(const QUrl& url, bool success, bool fromCache);
+
+private:
+    struct Waiter {
+        QPointer<QObject> receiver;
+        Callback callback;
+    };
+
+    void startNext();
+    void onReplyFinished(QNetworkReply* reply);
+    void finish(const QUrl& url, const QByteArray& body);
+
+    static const int DEFAULT_MAX_CONCURRENT = 6;
+    static const qint64 DEFAULT_CACHE_BYTES = 100 * 1024 * 1024;
+    static const qint64 MAX_IMAGE_BYTES = 10 * 1024 * 1024;
+    static const int TRANSFER_TIMEOUT_MS = 15000;
+
+    QNetworkAccessManager manager;
+    QNetworkDiskCache* diskCache;
+    QQueue<QUrl> queue;
+    QHash<QUrl, QList<Waiter>> waiting;
+    int active;
+    int maxActive;
+};
+
+#endif // REMOTEIMAGELOADER_H
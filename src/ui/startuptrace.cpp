@@ -0,0 +1,66 @@
+#include "startuptrace.h"
+#include <QMutexLocker>
+#include <QDebug>
+
+StartupTrace::StartupTrace()
+    : finished(false)
+{
+    clock.start();
+}
+
+StartupTrace& StartupTrace::getInstance() {
+    static StartupTrace instance;
+    return instance;
+}
+
+void StartupTrace::record(const QString& name, qint64 startMs, qint64 durationMs) {
+    QMutexLocker locker(&mutex);
+    Phase phase;
+    phase.name = name;
+    phase.startMs = startMs;
+    phase.durationMs = durationMs;
+    phases.append(phase);
+
+    if (finished) {
+        qDebug() << "Startup trace:" << name << "took" << durationMs << "ms";
+    }
+}
+
+void StartupTrace::finish(const QString& milestone) {
+    QMutexLocker locker(&mutex);
+    if (finished) {
+        return;
+    }
+    finished = true;
+
+    qDebug() << "Startup trace:" << milestone << "after" << clock.elapsed() << "ms";
+    for (const Phase& phase : phases) {
+        qDebug().noquote() << QString("  %1 ms  +%2 ms  %3")
+            .arg(phase.startMs, 6).arg(phase.durationMs, 5).arg(phase.name);
+    }
+}
+
+bool StartupTrace::isFinished() const {
+    QMutexLocker locker(&mutex);
+    return finished;
+}
+
+qint64 StartupTrace::elapsedMs() const {
+    return clock.elapsed();
+}
+
+QList<StartupTrace::Phase> StartupTrace::getPhases() const {
+    QMutexLocker locker(&mutex);
+    return phases;
+}
+
+TracePhase::TracePhase(const QString& name)
+    : name(name)
+    , startMs(StartupTrace::getInstance().elapsedMs())
+{
+}
+
+TracePhase::~TracePhase() {
+    StartupTrace& trace = StartupTrace::getInstance();
+    trace.record(name, startMs, trace.elapsedMs() - startMs);
+}
@@ -0,0 +1,51 @@
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+// Records how long each startup phase takes, measured from the first call to
+// getInstance() at the top of main(). finish() logs the breakdown once the
+// login screen is up; phases recorded after that, such as pages created on
+// first navigation, are logged as they happen.
+class StartupTrace {
+public:
+    struct Phase {
+        QString name;
+        qint64 startMs;     // Since the trace started
+        qint64 durationMs;
+    };
+
+    static StartupTrace& getInstance();
+
+    void record(const QString& name, qint64 startMs, qint64 durationMs);
+    void finish(const QString& milestone);
+    bool isFinished() const;
+    qint64 elapsedMs() const;
+    QList<Phase> getPhases() const;
+
+private:
+    StartupTrace();
+    StartupTrace(const StartupTrace&) = delete;
+    StartupTrace& operator=(const StartupTrace&) = delete;
+
+    QElapsedTimer clock;
+    QList<Phase> phases;
+    bool finished;
+    mutable QMutex mutex;
+};
+
+// Times the enclosing scope as one phase of the startup trace
+class TracePhase {
+public:
+    explicit TracePhase(const QString& name);
+    ~TracePhase();
+
+private:
+    QString name;
+    qint64 startMs;
+};
+
+#endif // STARTUPTRACE_H